@@ -38,3 +38,7 @@ SUBDIRS += \
 unix {
 SUBDIRS+=ProcessCrmsDatabase
 }
+
+metocean_tests {
+SUBDIRS+=tests
+}
@@ -17,7 +17,7 @@
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #
 #-----------------------------------------------------------------------#
-QT += network positioning
+QT += network positioning concurrent
 QT -= gui
 
 include($$PWD/../global.pri)
@@ -42,14 +42,16 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
         main.cpp \
     metoceandata.cpp \
-    options.cpp
+    options.cpp \
+    streamconverter.cpp
 
 INCLUDEPATH += ../
 
 HEADERS += \
     metoceandata.h \
     options.h \
-    optionslist.h
+    optionslist.h \
+    streamconverter.h
 
 win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../libraries/libmetocean/release/ -lmetocean
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../libraries/libmetocean/debug/ -lmetocean
@@ -22,6 +22,7 @@
 #include <iostream>
 #include "metoceandata.h"
 #include "options.h"
+#include "streamconverter.h"
 #include "version.h"
 
 int main(int argc, char *argv[]) {
@@ -42,10 +43,24 @@ int main(int argc, char *argv[]) {
 
   option->processOptions();
   Options::CommandLineOptions opt = option->getCommandLineOptions();
+
+  if (!opt.inputFile.isEmpty()) {
+    StreamConverter converter(opt.inputFile, opt.outputFile, opt.startDate,
+                              opt.endDate, opt.statistics);
+    converter.setNetcdfProfile(opt.netcdfProfile);
+    converter.setRaggedArray(opt.raggedArray);
+    converter.setAppend(opt.append);
+    return converter.run();
+  }
+
   MetOceanData *d;
   d = new MetOceanData(opt.service, opt.station, opt.product, opt.parameterId,
                        opt.vdatum, opt.datum, opt.startDate, opt.endDate,
                        opt.outputFile, &a);
+  d->setNetcdfProfile(opt.netcdfProfile);
+  d->setNetcdfLayout(opt.raggedArray ? Hmdf::NetcdfRaggedArray
+                                     : Hmdf::NetcdfStationVariables);
+  d->setNetcdfAppend(opt.append);
   d->setLoggingActive();
   QObject::connect(d, SIGNAL(finished()), &a, SLOT(quit()));
   QTimer::singleShot(0, d, SLOT(run()));
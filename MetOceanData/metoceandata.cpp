@@ -66,6 +66,8 @@ MetOceanData::MetOceanData(QObject *parent)
       m_usevdatum(false),
       m_previousProduct(QString()),
       m_productId(QString()),
+      m_netcdfLayout(Hmdf::NetcdfStationVariables),
+      m_netcdfAppend(false),
       QObject(parent) {}
 
 MetOceanData::MetOceanData(serviceTypes service, QStringList station,
@@ -82,6 +84,8 @@ MetOceanData::MetOceanData(serviceTypes service, QStringList station,
       m_usevdatum(useVdatum),
       m_productId(productId),
       m_previousProduct((QString())),
+      m_netcdfLayout(Hmdf::NetcdfStationVariables),
+      m_netcdfAppend(false),
       QObject(parent) {}
 
 int MetOceanData::service() const { return this->m_service; }
@@ -300,7 +304,7 @@ void MetOceanData::getNdbcData() {
   dataOut->setUnits("ndbc_units");
   dataOut->setDatum("ndbc_datum");
 
-  int ierr = dataOut->write(this->m_outputFile);
+  int ierr = this->writeOutput(dataOut);
   if (ierr != 0) {
     emit error("Error writing to file.");
     return;
@@ -352,7 +356,7 @@ void MetOceanData::getXtideData() {
     delete x;
   }
 
-  int ierr = dataOut->write(this->m_outputFile);
+  int ierr = this->writeOutput(dataOut);
   if (ierr != 0) {
     emit error("Error writing data to file.");
     return;
@@ -409,7 +413,7 @@ void MetOceanData::getUsgsData() {
   }
 
   if (data2->nstations() > 0) {
-    int ierr = data2->write(this->m_outputFile);
+    int ierr = this->writeOutput(data2);
     if (ierr != 0) {
       emit error("Error writing to file.");
       return;
@@ -526,7 +530,7 @@ void MetOceanData::getNoaaData() {
     delete coops;
   }
 
-  int ierr = dataOut->write(this->m_outputFile);
+  int ierr = this->writeOutput(dataOut);
   if (ierr != 0) {
     emit error("Error writing data to file");
     return;
@@ -605,6 +609,46 @@ QString MetOceanData::indexToDatum() {
 
 QString MetOceanData::noaaIndexToUnits() { return noaaUnits[this->m_product]; }
 
+NetcdfWriteProfile MetOceanData::netcdfProfile() const {
+  return this->m_netcdfProfile;
+}
+
+void MetOceanData::setNetcdfProfile(const NetcdfWriteProfile &profile) {
+  this->m_netcdfProfile = profile;
+}
+
+Hmdf::NetcdfLayout MetOceanData::netcdfLayout() const {
+  return this->m_netcdfLayout;
+}
+
+void MetOceanData::setNetcdfLayout(Hmdf::NetcdfLayout layout) {
+  this->m_netcdfLayout = layout;
+}
+
+bool MetOceanData::netcdfAppend() const { return this->m_netcdfAppend; }
+
+void MetOceanData::setNetcdfAppend(bool append) {
+  this->m_netcdfAppend = append;
+}
+
+int MetOceanData::writeOutput(Hmdf *data) {
+  data->setNetcdfProfile(this->m_netcdfProfile);
+  data->setNetcdfLayout(this->m_netcdfLayout);
+  data->setNetcdfAppend(this->m_netcdfAppend);
+
+  //...The services are asked for the dates as given, in GMT, and can send
+  //   back more than was asked for. Only the requested range is written
+  if (this->m_startDate.isValid() && this->m_endDate.isValid()) {
+    QDateTime start = this->m_startDate;
+    QDateTime end = this->m_endDate;
+    start.setTimeSpec(Qt::UTC);
+    end.setTimeSpec(Qt::UTC);
+    data->setWriteWindow(start.toMSecsSinceEpoch(), end.toMSecsSinceEpoch());
+  }
+
+  return data->write(this->m_outputFile);
+}
+
 int MetOceanData::getDatum() const { return m_datum; }
 
 void MetOceanData::setDatum(int datum) { m_datum = datum; }
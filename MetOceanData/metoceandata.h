@@ -63,6 +63,15 @@ class MetOceanData : public QObject {
   int getDatum() const;
   void setDatum(int datum);
 
+  NetcdfWriteProfile netcdfProfile() const;
+  void setNetcdfProfile(const NetcdfWriteProfile &profile);
+
+  Hmdf::NetcdfLayout netcdfLayout() const;
+  void setNetcdfLayout(Hmdf::NetcdfLayout layout);
+
+  bool netcdfAppend() const;
+  void setNetcdfAppend(bool append);
+
   static StationLocations::MarkerType serviceToMarkerType(
       MetOceanData::serviceTypes type);
   static bool findStation(QStringList name, StationLocations::MarkerType type,
@@ -91,6 +100,8 @@ class MetOceanData : public QObject {
   QString indexToDatum();
   QString noaaIndexToUnits();
 
+  int writeOutput(Hmdf *data);
+
   int printAvailableProducts(Hmdf *data, bool reselect = true);
   int getUSGSProductIndex(Hmdf *stationdata, const QString &product);
 
@@ -104,6 +115,9 @@ class MetOceanData : public QObject {
   QString m_outputFile;
   QString m_previousProduct;
   QString m_productId;
+  NetcdfWriteProfile m_netcdfProfile;
+  Hmdf::NetcdfLayout m_netcdfLayout;
+  bool m_netcdfAppend;
 };
 
 #endif  // DRIVER_H
@@ -37,11 +37,16 @@ void Options::addOptions() {
                              << m_serviceType << m_stationId << m_boundingBox
                              << m_nearest << m_startDate << m_endDate
                              << m_product << m_parameterId << m_outputFile
-                             << m_datum << m_vdatum << m_list << m_show);
+                             << m_datum << m_vdatum << m_list << m_show
+                             << m_inputFile << m_stats << m_netcdfProfile
+                             << m_ragged << m_append);
 }
 
 Options::CommandLineOptions Options::getCommandLineOptions() {
+  if (this->parser()->isSet(m_inputFile)) return this->getConversionOptions();
+
   Options::CommandLineOptions opt;
+  opt.statistics = false;
 
   std::vector<bool> inputOptions;
   inputOptions.push_back(this->parser()->isSet(m_stationId));
@@ -215,9 +220,72 @@ Options::CommandLineOptions Options::getCommandLineOptions() {
     exit(1);
   }
 
+  this->getOutputOptions(opt);
+
   return opt;
 }
 
+Options::CommandLineOptions Options::getConversionOptions() {
+  Options::CommandLineOptions opt;
+  opt.service = MetOceanData::UNKNOWNSERVICE;
+  opt.product = -1;
+  opt.datum = -1;
+  opt.vdatum = false;
+  opt.inputFile = this->parser()->value(m_inputFile);
+  opt.statistics = this->parser()->isSet(m_stats);
+
+  if (this->parser()->isSet(m_outputFile)) {
+    opt.outputFile = this->parser()->value(m_outputFile);
+  } else if (!opt.statistics) {
+    std::cerr << "Error: No output file specified." << std::endl;
+    std::cerr.flush();
+    this->parser()->showHelp(1);
+  }
+
+  if (this->parser()->isSet(m_startDate)) {
+    opt.startDate = checkDateString(this->parser()->value(m_startDate));
+    if (opt.startDate.isNull()) {
+      std::cerr << "Error: Invalid start date." << std::endl;
+      std::cerr.flush();
+      this->parser()->showHelp(1);
+    }
+  }
+
+  if (this->parser()->isSet(m_endDate)) {
+    opt.endDate = checkDateString(this->parser()->value(m_endDate));
+    if (opt.endDate.isNull()) {
+      std::cerr << "Error: Invalid end date." << std::endl;
+      std::cerr.flush();
+      this->parser()->showHelp(1);
+    }
+  }
+
+  this->getOutputOptions(opt);
+
+  return opt;
+}
+
+void Options::getOutputOptions(CommandLineOptions &opt) {
+  opt.raggedArray = this->parser()->isSet(m_ragged);
+  opt.append = this->parser()->isSet(m_append);
+  if (opt.append && opt.raggedArray) {
+    std::cerr << "Error: Ragged array files cannot be appended to."
+              << std::endl;
+    std::cerr.flush();
+    this->parser()->showHelp(1);
+  }
+  if (this->parser()->isSet(m_netcdfProfile)) {
+    if (!NetcdfWriteProfile::fromName(this->parser()->value(m_netcdfProfile),
+                                      opt.netcdfProfile)) {
+      std::cerr << "Error: Unknown netCDF profile. Valid profiles are: "
+                << NetcdfWriteProfile::names().join(", ").toStdString()
+                << std::endl;
+      std::cerr.flush();
+      this->parser()->showHelp(1);
+    }
+  }
+}
+
 MetOceanData::serviceTypes Options::checkServiceString(QString str) {
   str = str.toUpper();
   if (str == "NOAA") return MetOceanData::NOAA;
@@ -40,6 +40,11 @@ class Options : public QObject {
     QString outputFile;
     QStringList station;
     QString parameterId;
+    QString inputFile;
+    bool statistics;
+    NetcdfWriteProfile netcdfProfile;
+    bool raggedArray;
+    bool append;
   };
 
   void processOptions();
@@ -51,6 +56,9 @@ class Options : public QObject {
  private:
   void addOptions();
 
+  CommandLineOptions getConversionOptions();
+  void getOutputOptions(CommandLineOptions &opt);
+
   void printStationList(QStringList station,
                         MetOceanData::serviceTypes markerType);
   void readStationList(QStringList &station,
@@ -98,4 +98,36 @@ static const QCommandLineOption m_vdatum =
 static const QCommandLineOption m_parameterId = QCommandLineOption(
     QStringList() << "parameter", "Parameter codes for USGS", "code");
 
+static const QCommandLineOption m_inputFile = QCommandLineOption(
+    QStringList() << "i"
+                  << "input",
+    "IMEDS file to convert to the format of the output file (.imeds, .csv "
+    "or .nc) or summarize with --stats. The file is streamed and never "
+    "loaded into memory. The start and end dates are optional and filter "
+    "the records",
+    "filename");
+
+static const QCommandLineOption m_stats = QCommandLineOption(
+    QStringList() << "stats",
+    "Print the count, minimum, maximum, mean and date range of each station "
+    "in the input file");
+
+static const QCommandLineOption m_netcdfProfile = QCommandLineOption(
+    QStringList() << "profile",
+    "Compression and chunking profile for netCDF output. Can be one of "
+    "default, fast-write (no compression), small-file or fast-read "
+    "(one compressed chunk per station)",
+    "name");
+
+static const QCommandLineOption m_ragged = QCommandLineOption(
+    QStringList() << "ragged",
+    "Write netCDF output using the CF contiguous ragged array layout "
+    "instead of one variable per station");
+
+static const QCommandLineOption m_append = QCommandLineOption(
+    QStringList() << "append",
+    "Append to an existing netCDF output file. Only records newer than the "
+    "last record of each station in the file are written and new stations "
+    "are added. Files created with this option can be appended to again");
+
 #endif  // OPTIONSLIST_H
@@ -0,0 +1,174 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "streamconverter.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "hmdfstation.h"
+#include "hmdfstreamwriter.h"
+#include "imedsstreamreader.h"
+#include "netcdfstreamwriter.h"
+
+//...Number of records held in memory at once
+static const size_t c_chunkSize = 65536;
+
+StreamConverter::StreamConverter(const QString &inputFile,
+                                 const QString &outputFile,
+                                 const QDateTime &startDate,
+                                 const QDateTime &endDate, bool statistics,
+                                 QObject *parent)
+    : QObject(parent),
+      m_inputFile(inputFile),
+      m_outputFile(outputFile),
+      m_startDate(startDate),
+      m_endDate(endDate),
+      m_statistics(statistics),
+      m_raggedArray(false),
+      m_append(false) {}
+
+void StreamConverter::setNetcdfProfile(const NetcdfWriteProfile &profile) {
+  this->m_netcdfProfile = profile;
+}
+
+void StreamConverter::setRaggedArray(bool raggedArray) {
+  this->m_raggedArray = raggedArray;
+}
+
+void StreamConverter::setAppend(bool append) { this->m_append = append; }
+
+int StreamConverter::run() {
+  ImedsStreamReader reader(this->m_inputFile);
+  if (reader.open() != 0) {
+    std::cerr << "Error: Could not open input file." << std::endl;
+    return 1;
+  }
+
+  qint64 start = std::numeric_limits<qint64>::min();
+  qint64 end = std::numeric_limits<qint64>::max();
+  if (this->m_startDate.isValid())
+    start = this->m_startDate.toMSecsSinceEpoch();
+  if (this->m_endDate.isValid()) end = this->m_endDate.toMSecsSinceEpoch();
+  reader.setWindow(start, end);
+
+  std::unique_ptr<HmdfStreamWriter> writer;
+  if (!this->m_outputFile.isEmpty()) {
+    writer.reset(HmdfStreamWriter::create(this->m_outputFile, reader.datum(),
+                                          reader.units()));
+    if (!writer) {
+      std::cerr << "Error: Unknown output file format." << std::endl;
+      return 1;
+    }
+
+    NetcdfStreamWriter *nc = dynamic_cast<NetcdfStreamWriter *>(writer.get());
+    if (nc) {
+      nc->setProfile(this->m_netcdfProfile);
+      nc->setLayout(this->m_raggedArray ? NetcdfStreamWriter::RaggedArray
+                                        : NetcdfStreamWriter::StationVariables);
+      nc->setAppend(this->m_append);
+    }
+
+    //...The station directory (with record counts) is built in a first
+    //   pass so that fixed size formats can be defined before any data
+    std::vector<HmdfStreamStation> stations;
+    int ierr = reader.scan(stations);
+    if (ierr == 0) ierr = writer->open(stations);
+    if (ierr != 0) {
+      std::cerr << "Error: Could not initialize output file." << std::endl;
+      return ierr;
+    }
+  }
+
+  if (this->m_statistics) {
+    std::cout << "station,count,minimum,maximum,mean,start,end" << std::endl;
+  }
+
+  std::vector<qint64> date(c_chunkSize);
+  std::vector<double> data(c_chunkSize);
+  HmdfStreamStation station;
+  size_t index = 0;
+  while (reader.nextStation(station)) {
+    if (writer) {
+      int ierr = writer->beginStation(index);
+      if (ierr != 0) return ierr;
+    }
+
+    size_t count = 0;
+    double minimum = std::numeric_limits<double>::max();
+    double maximum = -std::numeric_limits<double>::max();
+    double sum = 0.0;
+    qint64 first = HmdfStation::nullDateValue();
+    qint64 last = HmdfStation::nullDateValue();
+
+    size_t n;
+    while ((n = reader.read(date.data(), data.data(), c_chunkSize)) > 0) {
+      if (writer) {
+        int ierr = writer->write(date.data(), data.data(), n);
+        if (ierr != 0) {
+          std::cerr << "Error: Could not write output file." << std::endl;
+          return ierr;
+        }
+      }
+      if (this->m_statistics) {
+        for (size_t i = 0; i < n; ++i) {
+          if (data[i] == HmdfStation::nullDataValue()) continue;
+          if (count == 0) first = date[i];
+          last = date[i];
+          minimum = std::min(minimum, data[i]);
+          maximum = std::max(maximum, data[i]);
+          sum += data[i];
+          ++count;
+        }
+      }
+    }
+
+    if (writer) {
+      int ierr = writer->endStation();
+      if (ierr != 0) return ierr;
+    }
+
+    if (this->m_statistics) {
+      std::cout << station.name.toStdString() << "," << count << ",";
+      if (count > 0) {
+        std::cout << minimum << "," << maximum << "," << sum / count << ","
+                  << QDateTime::fromMSecsSinceEpoch(first, Qt::UTC)
+                         .toString("yyyy-MM-dd hh:mm:ss")
+                         .toStdString()
+                  << ","
+                  << QDateTime::fromMSecsSinceEpoch(last, Qt::UTC)
+                         .toString("yyyy-MM-dd hh:mm:ss")
+                         .toStdString();
+      } else {
+        std::cout << ",,,,";
+      }
+      std::cout << std::endl;
+    }
+    index++;
+  }
+
+  if (reader.error() != 0) {
+    std::cerr << "Error: Malformed station header in input file." << std::endl;
+    return reader.error();
+  }
+
+  if (writer) return writer->close();
+  return 0;
+}
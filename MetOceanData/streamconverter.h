@@ -0,0 +1,55 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef STREAMCONVERTER_H
+#define STREAMCONVERTER_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include "netcdfwriteprofile.h"
+
+//...Converts and/or summarizes an IMEDS file one chunk at a time so that
+//   memory use does not depend on the size of the file
+class StreamConverter : public QObject {
+  Q_OBJECT
+ public:
+  explicit StreamConverter(const QString &inputFile, const QString &outputFile,
+                           const QDateTime &startDate,
+                           const QDateTime &endDate, bool statistics,
+                           QObject *parent = nullptr);
+
+  void setNetcdfProfile(const NetcdfWriteProfile &profile);
+  void setRaggedArray(bool raggedArray);
+  void setAppend(bool append);
+
+  int run();
+
+ private:
+  QString m_inputFile;
+  QString m_outputFile;
+  QDateTime m_startDate;
+  QDateTime m_endDate;
+  bool m_statistics;
+  bool m_raggedArray;
+  bool m_append;
+  NetcdfWriteProfile m_netcdfProfile;
+};
+
+#endif  // STREAMCONVERTER_H
@@ -18,7 +18,7 @@
 #
 #-----------------------------------------------------------------------#
 QT -= gui
-QT += positioning
+QT += positioning concurrent
 
 CONFIG += c++11 console
 CONFIG -= app_bundle
@@ -18,7 +18,7 @@
 #
 #-----------------------------------------------------------------------#
 
-QT  += core gui network xml charts printsupport
+QT  += core gui network xml charts printsupport concurrent
 QT  += qml quick positioning location quickwidgets
 
 include($$PWD/../global.pri)
@@ -47,6 +47,7 @@ SOURCES +=\
     src/xtide.cpp \
     src/chartview.cpp \
     src/aboutdialog.cpp \
+    src/adcircmeshextractor.cpp \
     src/adcircstationoutput.cpp \
     src/uihwmtab.cpp \
     src/uinoaatab.cpp \
@@ -79,6 +80,7 @@ HEADERS  += \
     src/xtide.h \
     src/chartview.h \
     src/aboutdialog.h \
+    src/adcircmeshextractor.h \
     src/adcircstationoutput.h \
     src/addtimeseriesdialog.h \
     src/mainwindow.h \
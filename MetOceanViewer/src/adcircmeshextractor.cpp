@@ -0,0 +1,434 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "adcircmeshextractor.h"
+#include <algorithm>
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include "errors.h"
+#include "hmdf.h"
+#include "netcdf.h"
+#include "timeconversion.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> MeshPoint;
+typedef bg::model::box<MeshPoint> MeshBox;
+typedef std::pair<MeshBox, size_t> MeshElement;
+
+//...Values (output steps x nodes) read from the file at once
+static const size_t c_defaultBlockSize = 4194304;
+
+//...Needed nodes closer together than this are read in one hyperslab
+//   along with the nodes in between
+static const size_t c_defaultMaxNodeGap = 256;
+
+//...Tolerance on the barycentric weights so that points on an element
+//   edge are not lost to round off
+static const double c_weightTolerance = 1e-9;
+
+//...Weighted sum of the three element values. Dry (fill) nodes are left
+//   out and the remaining weights are rescaled. The point is dry if every
+//   node is
+static double interpolate(const double *value, const double *weight,
+                          double fillValue) {
+  double sum = 0.0, total = 0.0;
+  for (int k = 0; k < 3; ++k) {
+    if (value[k] == fillValue) continue;
+    sum += weight[k] * value[k];
+    total += weight[k];
+  }
+  if (total <= c_weightTolerance) return HmdfStation::nullDataValue();
+  return sum / total;
+}
+
+AdcircMeshExtractor::AdcircMeshExtractor(QObject *parent) : QObject(parent) {
+  this->_error = MetOceanViewer::Error::NOERR;
+  this->_ncerr = NC_NOERR;
+  this->_blockSize = c_defaultBlockSize;
+  this->_maxNodeGap = c_defaultMaxNodeGap;
+  this->nSnaps = 0;
+}
+
+void AdcircMeshExtractor::addPoint(double longitude, double latitude,
+                                   const QString &name) {
+  this->longitude.push_back(longitude);
+  this->latitude.push_back(latitude);
+  this->point_name.push_back(name);
+}
+
+void AdcircMeshExtractor::clearPoints() {
+  this->longitude.clear();
+  this->latitude.clear();
+  this->point_name.clear();
+  this->node.clear();
+  this->weight.clear();
+  this->data.clear();
+}
+
+size_t AdcircMeshExtractor::numPoints() const {
+  return static_cast<size_t>(this->longitude.size());
+}
+
+int AdcircMeshExtractor::error() { return this->_error; }
+
+bool AdcircMeshExtractor::found(size_t point) const {
+  return 3 * point < this->node.size() && this->node[3 * point] >= 0;
+}
+
+size_t AdcircMeshExtractor::blockSize() const { return this->_blockSize; }
+
+void AdcircMeshExtractor::setBlockSize(size_t blockSize) {
+  this->_blockSize = std::max(static_cast<size_t>(1), blockSize);
+}
+
+size_t AdcircMeshExtractor::maxNodeGap() const { return this->_maxNodeGap; }
+
+void AdcircMeshExtractor::setMaxNodeGap(size_t maxNodeGap) {
+  this->_maxNodeGap = maxNodeGap;
+}
+
+int AdcircMeshExtractor::read(QString AdcircFile, QDateTime coldStart) {
+  int ncid, varid1, varid2 = -1, varid_time;
+  int dimid_time;
+  size_t time_size;
+
+  this->coldStartTime = coldStart;
+
+  QVector<QString> netcdf_types;
+  netcdf_types.resize(6);
+  netcdf_types[0] = "zeta";
+  netcdf_types[1] = "u-vel";
+  netcdf_types[2] = "v-vel";
+  netcdf_types[3] = "pressure";
+  netcdf_types[4] = "windx";
+  netcdf_types[5] = "windy";
+
+  this->_ncerr = nc_open(AdcircFile.toUtf8(), NC_NOWRITE, &ncid);
+  if (this->_ncerr != NC_NOERR) {
+    this->_error = MetOceanViewer::Error::NETCDF;
+    return this->_error;
+  }
+
+  // Find the variable in the NetCDF file
+  varid1 = -1;
+  for (size_t i = 0; i < 6 && varid1 < 0; i++) {
+    if (nc_inq_varid(ncid, netcdf_types[i].toUtf8(), &varid1) != NC_NOERR) {
+      varid1 = -1;
+      continue;
+    }
+    if (i == 1 || i == 4) {
+      this->_ncerr =
+          nc_inq_varid(ncid, netcdf_types[i + 1].toUtf8(), &varid2);
+      if (this->_ncerr != NC_NOERR) {
+        nc_close(ncid);
+        this->_error = MetOceanViewer::Error::NETCDF;
+        return this->_error;
+      }
+    }
+  }
+  if (varid1 < 0) {
+    nc_close(ncid);
+    this->_error = MetOceanViewer::Error::NO_VARIABLE_FOUND;
+    return this->_error;
+  }
+
+  double fillVal;
+  this->_ncerr = nc_inq_dimid(ncid, "time", &dimid_time);
+  if (this->_ncerr == NC_NOERR)
+    this->_ncerr = nc_inq_dimlen(ncid, dimid_time, &time_size);
+  if (this->_ncerr == NC_NOERR)
+    this->_ncerr = nc_inq_varid(ncid, "time", &varid_time);
+  if (this->_ncerr == NC_NOERR)
+    this->_ncerr = nc_inq_var_fill(ncid, varid1, NULL, &fillVal);
+  if (this->_ncerr == NC_NOERR) {
+    this->time.resize(time_size);
+    this->_ncerr = nc_get_var_double(ncid, varid_time, this->time.data());
+  }
+  if (this->_ncerr != NC_NOERR) {
+    nc_close(ncid);
+    this->_error = MetOceanViewer::Error::NETCDF;
+    return this->_error;
+  }
+  this->nSnaps = time_size;
+
+  // Locate the points in the mesh. The mesh is only needed until the
+  // elements and weights are known
+  {
+    std::vector<double> x, y;
+    std::vector<int> element;
+    this->_ncerr = this->readMesh(ncid, x, y, element);
+    if (this->_ncerr != NC_NOERR) {
+      nc_close(ncid);
+      this->_error = MetOceanViewer::Error::ADCIRC_NETCDFREADERROR;
+      return this->_error;
+    }
+    this->locate(x, y, element);
+  }
+
+  std::vector<Range> ranges;
+  this->buildRanges(ranges);
+
+  this->_ncerr = this->readValues(ncid, varid1, varid2, fillVal, ranges);
+  if (this->_ncerr != NC_NOERR) {
+    nc_close(ncid);
+    this->_error = MetOceanViewer::Error::NETCDF;
+    return this->_error;
+  }
+
+  this->_ncerr = nc_close(ncid);
+  if (this->_ncerr != NC_NOERR) {
+    this->_error = MetOceanViewer::Error::NETCDF;
+    return this->_error;
+  }
+
+  this->_error = MetOceanViewer::Error::NOERR;
+  return this->_error;
+}
+
+//...Reads the node positions and the element table. ADCIRC numbers the
+//   nodes from one, the table is returned zero based
+int AdcircMeshExtractor::readMesh(int ncid, std::vector<double> &x,
+                                  std::vector<double> &y,
+                                  std::vector<int> &element) {
+  int dimid_node, dimid_nele, varid_x, varid_y, varid_element;
+  size_t node_size, nele_size;
+
+  int ierr = nc_inq_dimid(ncid, "node", &dimid_node);
+  if (ierr == NC_NOERR) ierr = nc_inq_dimlen(ncid, dimid_node, &node_size);
+  if (ierr == NC_NOERR) ierr = nc_inq_dimid(ncid, "nele", &dimid_nele);
+  if (ierr == NC_NOERR) ierr = nc_inq_dimlen(ncid, dimid_nele, &nele_size);
+  if (ierr == NC_NOERR) ierr = nc_inq_varid(ncid, "x", &varid_x);
+  if (ierr == NC_NOERR) ierr = nc_inq_varid(ncid, "y", &varid_y);
+  if (ierr == NC_NOERR) ierr = nc_inq_varid(ncid, "element", &varid_element);
+  if (ierr != NC_NOERR) return ierr;
+
+  x.resize(node_size);
+  y.resize(node_size);
+  element.resize(3 * nele_size);
+  ierr = nc_get_var_double(ncid, varid_x, x.data());
+  if (ierr == NC_NOERR) ierr = nc_get_var_double(ncid, varid_y, y.data());
+  if (ierr == NC_NOERR)
+    ierr = nc_get_var_int(ncid, varid_element, element.data());
+  if (ierr != NC_NOERR) return ierr;
+
+  for (size_t i = 0; i < element.size(); ++i) {
+    element[i] -= 1;
+    if (element[i] < 0 || static_cast<size_t>(element[i]) >= node_size)
+      return NC_EINVAL;
+  }
+  return NC_NOERR;
+}
+
+//...Finds the element containing each point and its barycentric weights.
+//   The R-tree is bulk loaded, which packs the boxes far better than
+//   inserting them one at a time
+void AdcircMeshExtractor::locate(const std::vector<double> &x,
+                                 const std::vector<double> &y,
+                                 const std::vector<int> &element) {
+  const size_t nele = element.size() / 3;
+  std::vector<MeshElement> boxes;
+  boxes.reserve(nele);
+  for (size_t e = 0; e < nele; ++e) {
+    const int *n = &element[3 * e];
+    const double xmin = std::min(x[n[0]], std::min(x[n[1]], x[n[2]]));
+    const double xmax = std::max(x[n[0]], std::max(x[n[1]], x[n[2]]));
+    const double ymin = std::min(y[n[0]], std::min(y[n[1]], y[n[2]]));
+    const double ymax = std::max(y[n[0]], std::max(y[n[1]], y[n[2]]));
+    boxes.push_back(std::make_pair(
+        MeshBox(MeshPoint(xmin, ymin), MeshPoint(xmax, ymax)), e));
+  }
+  bgi::rtree<MeshElement, bgi::rstar<16>> tree(boxes.begin(), boxes.end());
+
+  const size_t nPoints = this->numPoints();
+  this->node.assign(3 * nPoints, -1);
+  this->weight.assign(3 * nPoints, 0.0);
+
+  std::vector<MeshElement> candidates;
+  for (size_t p = 0; p < nPoints; ++p) {
+    const double px = this->longitude[p];
+    const double py = this->latitude[p];
+    candidates.clear();
+    tree.query(bgi::intersects(MeshPoint(px, py)),
+               std::back_inserter(candidates));
+
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      const int *n = &element[3 * candidates[c].second];
+      const double x1 = x[n[0]], y1 = y[n[0]];
+      const double x2 = x[n[1]], y2 = y[n[1]];
+      const double x3 = x[n[2]], y3 = y[n[2]];
+      const double det = (y2 - y3) * (x1 - x3) + (x3 - x2) * (y1 - y3);
+      if (det == 0.0) continue;
+      const double w1 = ((y2 - y3) * (px - x3) + (x3 - x2) * (py - y3)) / det;
+      const double w2 = ((y3 - y1) * (px - x3) + (x1 - x3) * (py - y3)) / det;
+      const double w3 = 1.0 - w1 - w2;
+      if (w1 < -c_weightTolerance || w2 < -c_weightTolerance ||
+          w3 < -c_weightTolerance)
+        continue;
+      for (int k = 0; k < 3; ++k) this->node[3 * p + k] = n[k];
+      this->weight[3 * p] = w1;
+      this->weight[3 * p + 1] = w2;
+      this->weight[3 * p + 2] = w3;
+      break;
+    }
+  }
+}
+
+//...Groups the needed nodes into runs of consecutive node numbers. Runs
+//   separated by no more than _maxNodeGap nodes are merged, trading a few
+//   unused values for fewer read calls
+void AdcircMeshExtractor::buildRanges(std::vector<Range> &ranges) {
+  std::vector<long long> needed;
+  for (size_t i = 0; i < this->node.size(); ++i)
+    if (this->node[i] >= 0) needed.push_back(this->node[i]);
+  std::sort(needed.begin(), needed.end());
+  needed.erase(std::unique(needed.begin(), needed.end()), needed.end());
+
+  ranges.clear();
+  size_t offset = 0;
+  for (size_t i = 0; i < needed.size();) {
+    size_t j = i + 1;
+    while (j < needed.size() &&
+           static_cast<size_t>(needed[j] - needed[j - 1]) <=
+               this->_maxNodeGap + 1)
+      ++j;
+    Range r;
+    r.first = static_cast<size_t>(needed[i]);
+    r.count = static_cast<size_t>(needed[j - 1] - needed[i]) + 1;
+    r.offset = offset;
+    offset += r.count;
+    ranges.push_back(r);
+    i = j;
+  }
+}
+
+//...Reads blocks of output steps for the node ranges and interpolates
+//   them to the points. A block holds at most _blockSize values per
+//   variable
+int AdcircMeshExtractor::readValues(int ncid, int varid1, int varid2,
+                                    double fillValue,
+                                    const std::vector<Range> &ranges) {
+  const size_t nPoints = this->numPoints();
+  this->data.resize(nPoints);
+  for (size_t p = 0; p < nPoints; ++p)
+    this->data[p].fill(HmdfStation::nullDataValue(), this->nSnaps);
+
+  if (ranges.empty() || this->nSnaps == 0) return NC_NOERR;
+
+  const size_t columns = ranges.back().offset + ranges.back().count;
+  const size_t blockTimes = std::max(
+      static_cast<size_t>(1),
+      std::min(this->nSnaps, this->_blockSize / columns));
+
+  //...Range and position within the range of each point's nodes
+  std::vector<size_t> range(this->node.size()), local(this->node.size());
+  for (size_t i = 0; i < this->node.size(); ++i) {
+    if (this->node[i] < 0) continue;
+    const size_t n = static_cast<size_t>(this->node[i]);
+    size_t lo = 0, hi = ranges.size();
+    while (hi - lo > 1) {
+      const size_t mid = (lo + hi) / 2;
+      if (ranges[mid].first <= n)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    range[i] = lo;
+    local[i] = n - ranges[lo].first;
+  }
+
+  std::vector<double> block1(blockTimes * columns), block2;
+  if (varid2 >= 0) block2.resize(blockTimes * columns);
+
+  for (size_t t = 0; t < this->nSnaps; t += blockTimes) {
+    const size_t nt = std::min(blockTimes, this->nSnaps - t);
+    for (size_t r = 0; r < ranges.size(); ++r) {
+      size_t start[2] = {t, ranges[r].first};
+      size_t count[2] = {nt, ranges[r].count};
+      const size_t at = nt * ranges[r].offset;
+      int ierr =
+          nc_get_vara_double(ncid, varid1, start, count, &block1[at]);
+      if (ierr == NC_NOERR && varid2 >= 0)
+        ierr = nc_get_vara_double(ncid, varid2, start, count, &block2[at]);
+      if (ierr != NC_NOERR) return ierr;
+    }
+
+    for (size_t p = 0; p < nPoints; ++p) {
+      if (!this->found(p)) continue;
+      size_t index[3];
+      for (int k = 0; k < 3; ++k) {
+        const Range &rg = ranges[range[3 * p + k]];
+        index[k] = nt * rg.offset + local[3 * p + k];
+      }
+      const double *w = &this->weight[3 * p];
+      double *out = this->data[p].data() + t;
+      for (size_t s = 0; s < nt; ++s) {
+        double u[3], v[3];
+        for (int k = 0; k < 3; ++k) {
+          const Range &rg = ranges[range[3 * p + k]];
+          u[k] = block1[index[k] + s * rg.count];
+          if (varid2 >= 0) v[k] = block2[index[k] + s * rg.count];
+        }
+        const double ui = interpolate(u, w, fillValue);
+        if (varid2 < 0 || ui == HmdfStation::nullDataValue()) {
+          out[s] = ui;
+          continue;
+        }
+        const double vi = interpolate(v, w, fillValue);
+        out[s] = vi == HmdfStation::nullDataValue()
+                     ? vi
+                     : std::sqrt(ui * ui + vi * vi);
+      }
+    }
+  }
+  return NC_NOERR;
+}
+
+int AdcircMeshExtractor::toHmdf(Hmdf *outputHmdf) {
+  //...Every point shares the same output times, convert them once
+  std::vector<qint64> date(this->nSnaps);
+  TimeConversion::secondsToMsecs(this->time.data(), this->nSnaps,
+                                 this->coldStartTime.toMSecsSinceEpoch(),
+                                 date.data());
+
+  const size_t nPoints = static_cast<size_t>(this->data.size());
+  outputHmdf->reserve(nPoints * this->nSnaps);
+  for (size_t i = 0; i < nPoints; ++i) {
+    HmdfStation *tempStation = new HmdfStation(outputHmdf);
+    tempStation->resize(this->nSnaps);
+    tempStation->setName(this->point_name[i]);
+    tempStation->setId(this->point_name[i]);
+    tempStation->setLongitude(this->longitude[i]);
+    tempStation->setLatitude(this->latitude[i]);
+    tempStation->setStationIndex(i);
+    tempStation->setIsNull(!this->found(i));
+    std::copy(date.begin(), date.end(),
+              tempStation->mutableDateSpan().begin());
+    std::copy(this->data[i].begin(), this->data[i].end(),
+              tempStation->mutableDataSpan().begin());
+    tempStation->commitWrites();
+    outputHmdf->addStation(tempStation);
+  }
+  outputHmdf->setSuccess(true);
+  return 0;
+}
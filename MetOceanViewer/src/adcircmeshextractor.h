@@ -0,0 +1,95 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef ADCIRCMESHEXTRACTOR_H
+#define ADCIRCMESHEXTRACTOR_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "hmdf.h"
+
+//...Extracts time series at arbitrary points from a full domain ADCIRC
+//   netCDF file (fort.63.nc, fort.64.nc, fort.73.nc, fort.74.nc). The
+//   element containing each point is found with an R-tree over the element
+//   bounding boxes and the nodal values are interpolated with the
+//   barycentric weights of the point in that element. Only the nodes that
+//   are needed are read from the file
+class AdcircMeshExtractor : public QObject {
+  Q_OBJECT
+public:
+  explicit AdcircMeshExtractor(QObject *parent = nullptr);
+
+  void addPoint(double longitude, double latitude, const QString &name);
+  void clearPoints();
+  size_t numPoints() const;
+
+  int read(QString AdcircFile, QDateTime coldStart);
+  int error();
+  int toHmdf(Hmdf *outputHmdf);
+
+  //...True when the point was inside the mesh. Points outside the mesh
+  //   are returned as null stations
+  bool found(size_t point) const;
+
+  size_t blockSize() const;
+  void setBlockSize(size_t blockSize);
+
+  size_t maxNodeGap() const;
+  void setMaxNodeGap(size_t maxNodeGap);
+
+private:
+  struct Range {
+    size_t first;
+    size_t count;
+    size_t offset;
+  };
+
+  int readMesh(int ncid, std::vector<double> &x, std::vector<double> &y,
+               std::vector<int> &element);
+  void locate(const std::vector<double> &x, const std::vector<double> &y,
+              const std::vector<int> &element);
+  void buildRanges(std::vector<Range> &ranges);
+  int readValues(int ncid, int varid1, int varid2, double fillValue,
+                 const std::vector<Range> &ranges);
+
+  size_t nSnaps;
+  int _error;
+  int _ncerr;
+  size_t _blockSize;
+  size_t _maxNodeGap;
+
+  QDateTime coldStartTime;
+
+  QVector<double> latitude;
+  QVector<double> longitude;
+  QStringList point_name;
+
+  //...Element nodes (0 based) and barycentric weights of each point,
+  //   node is -1 for points outside the mesh
+  std::vector<long long> node;
+  std::vector<double> weight;
+
+  QVector<double> time;
+  QVector<QVector<double>> data;
+};
+
+#endif // ADCIRCMESHEXTRACTOR_H
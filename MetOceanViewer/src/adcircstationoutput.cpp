@@ -22,13 +22,97 @@
 #include <algorithm>
 #include <cmath>
 #include <iterator>
+#include <limits>
 #include "errors.h"
 #include "hmdf.h"
+#include "hmdfasciiparser.h"
 #include "netcdf.h"
+#include "timeconversion.h"
+
+//...Maps a file into memory, or reads it where it cannot be mapped. The
+//   range stays valid while the file and buffer are alive
+static bool mapFile(QFile &file, QByteArray &buffer, const char *&begin,
+                    const char *&end) {
+  if (!file.open(QIODevice::ReadOnly)) return false;
+  qint64 size = file.size();
+  uchar *map = size > 0 ? file.map(0, size) : nullptr;
+  if (map) {
+    begin = reinterpret_cast<const char *>(map);
+  } else {
+    buffer = file.readAll();
+    begin = buffer.constData();
+    size = buffer.size();
+  }
+  end = begin + size;
+  return true;
+}
+
+static const char *nextLine(const char *p, const char *end) {
+  const char *eol = HmdfAsciiParser::lineEnd(p, end);
+  return eol < end ? eol + 1 : end;
+}
+
+//...Next field of a line where both blanks and commas separate fields
+static bool nextField(const char *&p, const char *end,
+                      const char *&fieldEnd) {
+  while (p < end && (HmdfAsciiParser::isBlank(*p) || *p == ',')) ++p;
+  if (p == end) return false;
+  fieldEnd = p;
+  while (fieldEnd < end && !HmdfAsciiParser::isBlank(*fieldEnd) &&
+         *fieldEnd != ',')
+    ++fieldEnd;
+  return true;
+}
+
+//...Parses the next field of the line and moves past it
+static bool nextDouble(const char *&p, const char *end, double &value) {
+  const char *fieldEnd;
+  if (!nextField(p, end, fieldEnd)) return false;
+  const bool ok = HmdfAsciiParser::parseDouble(p, fieldEnd, value);
+  p = fieldEnd;
+  return ok;
+}
+
+//...Values (output steps x stations) read from a netCDF file at once
+static const size_t c_defaultBlockSize = 4194304;
+
+//...Edge of the square tiles used to transpose a block
+static const size_t c_tileSize = 32;
+
+//...Copies a (time, station) block into the station arrays starting at
+//   output step timeOffset. The copy goes tile by tile so that reads and
+//   writes both stay within a few cache lines. Fill values become the
+//   Hmdf null value and vector components are combined into a magnitude
+static void transposeBlock(const double *u, const double *v, size_t nTime,
+                           size_t nStation, size_t timeOffset,
+                           double fillValue, double *const *output) {
+  for (size_t t0 = 0; t0 < nTime; t0 += c_tileSize) {
+    const size_t t1 = std::min(nTime, t0 + c_tileSize);
+    for (size_t s0 = 0; s0 < nStation; s0 += c_tileSize) {
+      const size_t s1 = std::min(nStation, s0 + c_tileSize);
+      for (size_t s = s0; s < s1; ++s) {
+        double *out = output[s] + timeOffset;
+        for (size_t t = t0; t < t1; ++t) {
+          const size_t k = t * nStation + s;
+          if (u[k] == fillValue) {
+            out[t] = HmdfStation::nullDataValue();
+          } else if (v) {
+            out[t] = std::sqrt(u[k] * u[k] + v[k] * v[k]);
+          } else {
+            out[t] = u[k];
+          }
+        }
+      }
+    }
+  }
+}
 
 AdcircStationOutput::AdcircStationOutput(QObject *parent) : QObject(parent) {
   this->_error = MetOceanViewer::Error::NOERR;
   this->_ncerr = NC_NOERR;
+  this->_blockSize = c_defaultBlockSize;
+  this->_startDate = std::numeric_limits<qint64>::min();
+  this->_endDate = std::numeric_limits<qint64>::max();
   this->nStations = 0;
   this->nSnaps = 0;
 }
@@ -37,6 +121,47 @@ int AdcircStationOutput::error() { return this->_error; }
 
 QString AdcircStationOutput::errorString() { return "errorString"; }
 
+size_t AdcircStationOutput::blockSize() const { return this->_blockSize; }
+
+//...Upper bound on the values held per variable while reading a netCDF
+//   file. Larger blocks mean fewer, larger reads
+void AdcircStationOutput::setBlockSize(size_t blockSize) {
+  this->_blockSize = std::max(static_cast<size_t>(1), blockSize);
+}
+
+void AdcircStationOutput::setTimeWindow(qint64 startDate, qint64 endDate) {
+  this->_startDate = startDate;
+  this->_endDate = endDate;
+}
+
+void AdcircStationOutput::clearTimeWindow() {
+  this->_startDate = std::numeric_limits<qint64>::min();
+  this->_endDate = std::numeric_limits<qint64>::max();
+}
+
+//...Output steps [first, last) that fall inside the time window. The
+//   record times are seconds since the cold start and increase
+void AdcircStationOutput::timeRange(const double *recordTime,
+                                    size_t numRecords, size_t &first,
+                                    size_t &last) const {
+  const qint64 coldStart = this->coldStartTime.toMSecsSinceEpoch();
+  first = 0;
+  last = numRecords;
+  if (this->_startDate != std::numeric_limits<qint64>::min()) {
+    const double lo =
+        static_cast<double>(this->_startDate - coldStart) / 1000.0;
+    first = static_cast<size_t>(
+        std::lower_bound(recordTime, recordTime + numRecords, lo) -
+        recordTime);
+  }
+  if (this->_endDate != std::numeric_limits<qint64>::max()) {
+    const double hi = static_cast<double>(this->_endDate - coldStart) / 1000.0;
+    last = static_cast<size_t>(
+        std::upper_bound(recordTime + first, recordTime + numRecords, hi) -
+        recordTime);
+  }
+}
+
 int AdcircStationOutput::read(QString AdcircFile, QString AdcircStationFile,
                               QDateTime coldStart) {
   this->coldStartTime = coldStart;
@@ -50,84 +175,145 @@ int AdcircStationOutput::read(QString AdcircFile, QDateTime coldStart) {
   return this->_error;
 }
 
+//...Reads a fort.61/62/71/72 style file. The file is memory mapped and
+//   tokenized in place, so no string is built per line. Vector files (two
+//   values per station) are stored as the magnitude. A file that ends part
+//   way through an output step (a run that is still going) is read up to
+//   the last complete step.
+//
+//   A first pass builds a seek index of where each output step starts,
+//   parsing only its time line. Only the steps inside the time window are
+//   then parsed
 int AdcircStationOutput::readAscii(QString AdcircOutputFile,
                                    QString AdcircStationFile) {
-  QFile MyFile(AdcircOutputFile), StationFile(AdcircStationFile);
-  QString header1, header2, TempLine;
-  QStringList headerData, TempList;
-  int nColumns;
-
-  // Check if we can open the file
-  if (!MyFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+  QFile file(AdcircOutputFile);
+  QByteArray buffer;
+  const char *begin, *end;
+  if (!mapFile(file, buffer, begin, end)) {
     this->_error = MetOceanViewer::Error::CANNOT_OPEN_FILE;
     return this->_error;
   }
 
-  if (!StationFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    this->_error = MetOceanViewer::Error::CANNOT_OPEN_FILE;
-    return this->_error;
+  // Second header line: output steps, stations, time step, output
+  // interval, values per station
+  const char *p = nextLine(begin, end);
+  const char *eol = HmdfAsciiParser::lineEnd(p, end);
+  double header[5];
+  for (int k = 0; k < 5; ++k) {
+    if (!nextDouble(p, eol, header[k]) || header[k] < 0.0)
+      return MetOceanViewer::Error::ADCIRC_ASCIIREADERROR;
+  }
+  p = nextLine(eol, end);
+
+  const size_t numSnaps = static_cast<size_t>(header[0]);
+  this->nStations = static_cast<size_t>(header[1]);
+  const bool isVector = static_cast<int>(header[4]) == 2;
+
+  std::vector<const char *> recordStart;
+  std::vector<double> recordTime;
+  recordStart.reserve(numSnaps);
+  recordTime.reserve(numSnaps);
+  while (recordStart.size() < numSnaps && p < end) {
+    const char *q = p;
+    eol = HmdfAsciiParser::lineEnd(q, end);
+    double t;
+    if (!nextDouble(q, eol, t)) break;
+    q = nextLine(eol, end);
+    size_t j = 0;
+    for (; j < this->nStations && q < end; ++j)
+      q = nextLine(HmdfAsciiParser::lineEnd(q, end), end);
+    if (j < this->nStations) break;
+    recordStart.push_back(p);
+    recordTime.push_back(t);
+    p = q;
   }
 
-  // Read the 61/62 style file
-  header1 = MyFile.readLine();
-  header2 = MyFile.readLine().simplified();
-  headerData = header2.split(" ");
-
-  this->nSnaps = headerData.value(0).toInt();
-  this->nStations = headerData.value(1).toInt();
-  nColumns = headerData.value(4).toInt();
+  size_t first, last;
+  this->timeRange(recordTime.data(), recordTime.size(), first, last);
+  const size_t windowSnaps = last - first;
 
-  this->time.resize(this->nSnaps);
+  this->time.resize(windowSnaps);
+  std::copy(recordTime.begin() + first, recordTime.begin() + last,
+            this->time.begin());
   this->data.resize(this->nStations);
+  std::vector<double *> output(this->nStations);
+  for (size_t i = 0; i < this->nStations; ++i) {
+    this->data[i].resize(windowSnaps);
+    output[i] = this->data[i].data();
+  }
 
-  for (size_t i = 0; i < this->nStations; ++i)
-    this->data[i].resize(this->nSnaps);
+  size_t snap = 0;
+  bool complete = true;
+  for (; snap < windowSnaps && complete; ++snap) {
+    p = nextLine(HmdfAsciiParser::lineEnd(recordStart[first + snap], end),
+                 end);
 
-  for (size_t i = 0; i < this->nSnaps; ++i) {
-    TempLine = MyFile.readLine().simplified();
-    TempList = TempLine.split(" ");
-    this->time[i] = TempList.value(0).toDouble();
     for (size_t j = 0; j < this->nStations; ++j) {
-      TempLine = MyFile.readLine().simplified();
-      TempList = TempLine.split(" ");
-      if (TempList.value(1).toDouble() < -900) {
-        this->data[j][i] = HmdfStation::nullDataValue();
+      eol = HmdfAsciiParser::lineEnd(p, end);
+      double index, u, v = 0.0;
+      if (!nextDouble(p, eol, index) || !nextDouble(p, eol, u) ||
+          (isVector && !nextDouble(p, eol, v))) {
+        complete = false;
+        break;
+      }
+      if (u < -900) {
+        output[j][snap] = HmdfStation::nullDataValue();
       } else {
-        this->data[j][i] = TempList.value(1).toDouble();
-        if (nColumns == 2)
-          this->data[j][i] = pow(
-              pow(this->data[j][i], 2) + pow(TempList.value(2).toDouble(), 2),
-              2);
+        output[j][snap] = isVector ? std::sqrt(u * u + v * v) : u;
       }
+      p = nextLine(eol, end);
     }
   }
-  MyFile.close();
+  this->nSnaps = complete ? snap : snap - 1;
+  this->time.resize(this->nSnaps);
+  for (size_t i = 0; i < this->nStations; ++i)
+    this->data[i].resize(this->nSnaps);
+
+  return this->readStationFile(AdcircStationFile);
+}
+
+//...Station location file used with the ascii output: the number of
+//   stations, then one line per station with the longitude, latitude and
+//   an optional name, separated by commas or blanks
+int AdcircStationOutput::readStationFile(QString AdcircStationFile) {
+  QFile file(AdcircStationFile);
+  QByteArray buffer;
+  const char *begin, *end;
+  if (!mapFile(file, buffer, begin, end)) {
+    this->_error = MetOceanViewer::Error::CANNOT_OPEN_FILE;
+    return this->_error;
+  }
 
-  // Now read the station location file
-  TempLine = StationFile.readLine().simplified();
-  TempList = TempLine.split(" ");
-  size_t TempStations = TempList.value(0).toULongLong();
-  if (TempStations != this->nStations)
+  const char *p = begin;
+  const char *eol = HmdfAsciiParser::lineEnd(p, end);
+  double count;
+  if (!nextDouble(p, eol, count) ||
+      static_cast<size_t>(count) != this->nStations)
     return MetOceanViewer::Error::WRONG_NUMBER_OF_STATIONS;
+  p = nextLine(eol, end);
 
   this->longitude.resize(this->nStations);
   this->latitude.resize(this->nStations);
   this->station_name.resize(this->nStations);
 
-  for (size_t i = 0; i < TempStations; ++i) {
-    TempLine = StationFile.readLine().simplified();
-    TempList = TempLine.split(QRegExp(",| "));
-    this->longitude[i] = TempList.value(0).toDouble();
-    this->latitude[i] = TempList.value(1).toDouble();
-
-    if (TempList.length() > 2) {
-      this->station_name[i] = "";
-      for (int j = 2; j < TempList.length(); ++j)
-        this->station_name[i] = this->station_name[i] + " " + TempList.value(j);
-    } else
-      this->station_name[i] = tr("Station_") + QString::number(i);
+  for (size_t i = 0; i < this->nStations; ++i) {
+    if (p == end) return MetOceanViewer::Error::WRONG_NUMBER_OF_STATIONS;
+    eol = HmdfAsciiParser::lineEnd(p, end);
+    if (!nextDouble(p, eol, this->longitude[i]) ||
+        !nextDouble(p, eol, this->latitude[i]))
+      return MetOceanViewer::Error::ADCIRC_ASCIIREADERROR;
+
+    QString name;
+    const char *fieldEnd;
+    while (nextField(p, eol, fieldEnd)) {
+      if (!name.isEmpty()) name += " ";
+      name += QString::fromUtf8(p, static_cast<int>(fieldEnd - p));
+      p = fieldEnd;
+    }
+    this->station_name[i] =
+        name.isEmpty() ? tr("Station_") + QString::number(i) : name;
+    p = nextLine(eol, end);
   }
-  StationFile.close();
 
   return MetOceanViewer::Error::NOERR;
 }
@@ -209,12 +395,6 @@ int AdcircStationOutput::readNetCDF(QString AdcircOutputFile) {
     if (i == 5) return MetOceanViewer::Error::NO_VARIABLE_FOUND;
   }
 
-  // Size the output variables
-  this->nStations = station_size;
-  this->nSnaps = time_size;
-  this->data.resize(station_size);
-  for (size_t i = 0; i < station_size; ++i) this->data[i].resize(time_size);
-
   // Read the station locations and times
   this->_ncerr = nc_inq_varid(ncid, "time", &varid_time);
   if (this->_ncerr != NC_NOERR) {
@@ -248,6 +428,19 @@ int AdcircStationOutput::readNetCDF(QString AdcircOutputFile) {
     return this->_error;
   }
 
+  // Only the output steps inside the time window are read
+  size_t first, last;
+  this->timeRange(this->time.data(), time_size, first, last);
+  this->time.erase(this->time.begin() + last, this->time.end());
+  this->time.erase(this->time.begin(), this->time.begin() + first);
+
+  // Size the output variables
+  this->nStations = station_size;
+  this->nSnaps = last - first;
+  this->data.resize(station_size);
+  for (size_t i = 0; i < station_size; ++i)
+    this->data[i].resize(this->nSnaps);
+
   this->longitude.resize(station_size);
   this->_ncerr = nc_get_var_double(ncid, varid_lon, this->longitude.data());
   if (this->_ncerr != NC_NOERR) {
@@ -262,47 +455,41 @@ int AdcircStationOutput::readNetCDF(QString AdcircOutputFile) {
     return this->_error;
   }
 
-  // Loop over the stations, reading the data into memory
-  for (size_t i = 0; i < station_size; ++i) {
-    std::vector<double> tempVar1(time_size);
-    std::vector<double> tempVar2(time_size);
-
-    // Read from netCDF
-    start[0] = 0;
-    start[1] = i;
-    count[0] = time_size;
-    count[1] = 1;
-    this->_ncerr = nc_get_vara(ncid, varid_zeta, start, count, tempVar1.data());
+  // Read blocks of whole output steps (every station) and transpose them
+  // into the station arrays. The block holds at most _blockSize values
+  // per variable
+  const size_t blockTimes = std::max(
+      static_cast<size_t>(1),
+      std::min(this->nSnaps,
+               this->_blockSize / std::max(static_cast<size_t>(1),
+                                           station_size)));
+  std::vector<double> block1, block2;
+  std::vector<double *> output(station_size);
+  for (size_t i = 0; i < station_size; ++i) output[i] = this->data[i].data();
+  if (station_size > 0) {
+    block1.resize(blockTimes * station_size);
+    if (isVector) block2.resize(blockTimes * station_size);
+  }
+
+  for (size_t t = first; t < last && station_size > 0; t += blockTimes) {
+    start[0] = t;
+    start[1] = 0;
+    count[0] = std::min(blockTimes, last - t);
+    count[1] = station_size;
+    this->_ncerr =
+        nc_get_vara_double(ncid, varid_zeta, start, count, block1.data());
+    if (this->_ncerr == NC_NOERR && isVector)
+      this->_ncerr =
+          nc_get_vara_double(ncid, varid_zeta2, start, count, block2.data());
     if (this->_ncerr != NC_NOERR) {
+      nc_close(ncid);
       this->_error = MetOceanViewer::Error::NETCDF;
       return this->_error;
     }
-
-    if (isVector) {
-      this->_ncerr =
-          nc_get_vara(ncid, varid_zeta2, start, count, tempVar2.data());
-      if (this->_ncerr != NC_NOERR) {
-        this->_error = MetOceanViewer::Error::NETCDF;
-        return this->_error;
-      }
-      for (size_t j = 0; j < time_size; j++) {
-        if (tempVar1[j] != fillVal) {
-          this->data[i][j] =
-              sqrt(pow(tempVar1[j], 2.0) + pow(tempVar2[j], 2.0));
-        } else {
-          this->data[i][j] = HmdfStation::nullDataValue();
-        }
-      }
-    } else {
-      for (size_t j = 0; j < time_size; ++j) {
-        if (tempVar1[j] != fillVal) {
-          this->data[i][j] = tempVar1[j];
-        } else {
-          this->data[i][j] = HmdfStation::nullDataValue();
-        }
-      }
-    }
+    transposeBlock(block1.data(), isVector ? block2.data() : nullptr,
+                   count[0], station_size, t - first, fillVal, output.data());
   }
+
   this->_error = nc_close(ncid);
   if (this->_error != NC_NOERR) {
     this->_ncerr = this->_error;
@@ -321,18 +508,26 @@ int AdcircStationOutput::readNetCDF(QString AdcircOutputFile) {
 }
 
 int AdcircStationOutput::toHmdf(Hmdf *outputHmdf) {
+  //...Every station shares the same output times, convert them once
+  std::vector<qint64> date(this->nSnaps);
+  TimeConversion::secondsToMsecs(this->time.data(), this->nSnaps,
+                                 this->coldStartTime.toMSecsSinceEpoch(),
+                                 date.data());
+
+  outputHmdf->reserve(this->nStations * this->nSnaps);
   for (size_t i = 0; i < this->nStations; ++i) {
     HmdfStation *tempStation = new HmdfStation(outputHmdf);
+    tempStation->resize(this->nSnaps);
     tempStation->setName(this->station_name[i]);
     tempStation->setId(this->station_name[i]);
     tempStation->setLongitude(this->longitude[i]);
     tempStation->setLatitude(this->latitude[i]);
     tempStation->setStationIndex(i);
-    for (size_t j = 0; j < this->nSnaps; ++j) {
-      tempStation->setNext(
-          this->coldStartTime.addSecs(this->time[j]).toMSecsSinceEpoch(),
-          this->data[i][j]);
-    }
+    std::copy(date.begin(), date.end(),
+              tempStation->mutableDateSpan().begin());
+    std::copy(this->data[i].begin(), this->data[i].begin() + this->nSnaps,
+              tempStation->mutableDataSpan().begin());
+    tempStation->commitWrites();
     outputHmdf->addStation(tempStation);
   }
   outputHmdf->setSuccess(true);
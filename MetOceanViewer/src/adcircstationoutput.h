@@ -36,8 +36,20 @@ public:
   int error();
   int toHmdf(Hmdf *outputHmdf);
 
+  size_t blockSize() const;
+  void setBlockSize(size_t blockSize);
+
+  //...Restricts read() to the output steps between the two dates
+  //   (milliseconds since the epoch, inclusive)
+  void setTimeWindow(qint64 startDate, qint64 endDate);
+  void clearTimeWindow();
+
 private:
+  void timeRange(const double *recordTime, size_t numRecords, size_t &first,
+                 size_t &last) const;
+
   int readAscii(QString AdcircOutputFile, QString AdcircStationFile);
+  int readStationFile(QString AdcircStationFile);
 
   int readNetCDF(QString AdicrcOutputFile);
 
@@ -45,6 +57,9 @@ private:
   size_t nSnaps;
   int _error;
   int _ncerr;
+  size_t _blockSize;
+  qint64 _startDate;
+  qint64 _endDate;
 
   QDateTime coldStartTime;
 
@@ -146,6 +146,13 @@ void AddTimeseriesDialog::setItemsByFiletype() {
     this->setVariableSelectElements(false);
     this->setVerticalLayerElements(false);
     this->m_fileReadError = false;
+  } else if (this->m_inputFileType == MetOceanViewer::FileType::BINARY_HMDF) {
+    ui->text_filetype->setText(QStringLiteral("MetOcean Binary"));
+    this->setColdstartSelectElements(false);
+    this->setStationSelectElements(false);
+    this->setVariableSelectElements(false);
+    this->setVerticalLayerElements(false);
+    this->m_fileReadError = false;
   } else if (this->m_inputFileType == MetOceanViewer::FileType::NETCDF_ADCIRC) {
     ui->text_filetype->setText(QStringLiteral("ADCIRC netCDF"));
     ui->date_coldstart->setEnabled(true);
@@ -171,6 +178,9 @@ void AddTimeseriesDialog::setItemsByFiletype() {
     this->setStationSelectElements(false);
     this->setVariableSelectElements(true);
 
+    //...Each Dflow keeps its file open until it is destroyed, so the one
+    //   for the previously selected file is released first
+    delete this->dflow;
     this->dflow = new Dflow(this->m_inputFilePath, this);
 
     if (this->dflow->error->isError()) {
@@ -497,8 +507,10 @@ void AddTimeseriesDialog::on_browse_filebrowse_clicked() {
 
   QString TempPath = QFileDialog::getOpenFileName(
       this, tr("Select File"), Directory,
-      tr("MetOceanViewer Compatible file (*.imeds *.61 *.62 *.71 *.72 *.nc) ;; "
+      tr("MetOceanViewer Compatible file (*.imeds *.61 *.62 *.71 *.72 *.nc "
+         "*.movts) ;; "
          "IMEDS File (*.imeds *.IMEDS) ;; netCDF Output Files (*.nc) ;; "
+         "MetOcean Binary Files (*.movts) ;; "
          "DFlow-FM History Files (*_his.nc) ;; "
          "ADCIRC Output Files (*.61 *.62 *.71 *.72) ;; All Files (*.*)"));
 
@@ -133,9 +133,10 @@ int Crms::plot(size_t index) {
   this->m_chartView->dateAxis()->setTitleText("Date (GMT)");
   this->m_chartView->yAxis()->setTitleText(
       this->m_data->station(index)->name());
-  for (int i = 0; i < this->m_data->station(index)->numSnaps(); i++) {
-    series->append(this->m_data->station(index)->date(i),
-                   this->m_data->station(index)->data(i));
+  HmdfSpan<const qint64> date = this->m_data->station(index)->dateSpan();
+  HmdfSpan<const double> data = this->m_data->station(index)->dataSpan();
+  for (size_t i = 0; i < date.size(); i++) {
+    series->append(date[i], data[i]);
   }
 
   this->m_chartView->addSeries(series, series->name());
@@ -1,10 +1,115 @@
 #include "dflow.h"
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "boost/algorithm/string.hpp"
 #include "errors.h"
 #include "hmdf.h"
 #include "metoceanviewer.h"
 #include "netcdf.h"
+#include "timeconversion.h"
+
+//...Metadata of the his files opened during this session. A file that is
+//   opened again (listing the variables and then reading one of them) is
+//   not scanned a second time. Entries are keyed by path, modification
+//   time and size so a rewritten file is scanned again
+struct DflowMetadata {
+  QMap<QString, size_t> varnames;
+  QMap<QString, size_t> dimnames;
+  QMap<QString, size_t> nDims;
+  QList<QString> plotvarnames;
+  bool is3d;
+  size_t nLayers;
+  size_t nStations;
+  size_t nSteps;
+  QVector<double> xCoordinates;
+  QVector<double> yCoordinates;
+  QVector<QString> stationNames;
+  QVector<qint64> time;
+  int timeError;
+};
+
+static QMutex s_metadataMutex;
+static QHash<QString, DflowMetadata> s_metadataCache;
+
+static QString metadataKey(const QString &filename) {
+  QFileInfo info(filename);
+  return info.canonicalFilePath() + QStringLiteral("|") +
+         QString::number(info.lastModified().toMSecsSinceEpoch()) +
+         QStringLiteral("|") + QString::number(info.size());
+}
+
+static QMutex s_derivedMutex;
+
+//...Suffixes naming the water column reductions of a 3D variable
+struct ColumnSuffix {
+  const char *suffix;
+  Dflow::ColumnMode mode;
+};
+static const ColumnSuffix c_columnSuffix[] = {
+    {"_depth_averaged", Dflow::DepthAverage},
+    {"_surface", Dflow::Surface},
+    {"_bottom", Dflow::Bottom},
+    {"_layer_range", Dflow::LayerRange}};
+static const size_t c_numColumnSuffixes =
+    sizeof(c_columnSuffix) / sizeof(c_columnSuffix[0]);
+
+//...Values (output steps x stations) read per component at once
+static const size_t c_blockSize = 1048576;
+
+//...Missing value written by D-Flow FM
+static const double c_fillValue = -999.0;
+
+static void copyKernel(const double *const *component, size_t n,
+                       double *output) {
+  std::copy(component[0], component[0] + n, output);
+}
+
+static void magnitudeKernel(const double *const *component, size_t n,
+                            double *output) {
+  const double *x = component[0];
+  const double *y = component[1];
+  for (size_t i = 0; i < n; i++)
+    output[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+}
+
+static void magnitude3Kernel(const double *const *component, size_t n,
+                             double *output) {
+  const double *x = component[0];
+  const double *y = component[1];
+  const double *z = component[2];
+  for (size_t i = 0; i < n; i++)
+    output[i] = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
+
+//...Direction the vector points to, degrees counterclockwise from east
+static void directionKernel(const double *const *component, size_t n,
+                            double *output) {
+  const double *x = component[0];
+  const double *y = component[1];
+  for (size_t i = 0; i < n; i++)
+    output[i] = std::atan2(y[i], x[i]) * 180.0 / M_PI;
+}
+
+//...Surface wind stress magnitude (N/m^2) using the Garratt (1977) drag
+//   coefficient, capped at 0.0035
+static void windStressKernel(const double *const *component, size_t n,
+                             double *output) {
+  const double rhoAir = 1.15;
+  const double *x = component[0];
+  const double *y = component[1];
+  for (size_t i = 0; i < n; i++) {
+    const double speed2 = x[i] * x[i] + y[i] * y[i];
+    const double cd =
+        std::min(0.0035, (0.75 + 0.067 * std::sqrt(speed2)) * 0.001);
+    output[i] = rhoAir * cd * speed2;
+  }
+}
 
 Dflow::Dflow(QString filename, QObject *parent) : QObject(parent) {
   this->_isInitialized = false;
@@ -15,6 +120,12 @@ Dflow::Dflow(QString filename, QObject *parent) : QObject(parent) {
   this->_nSteps = 0;
   this->_nStations = 0;
   this->_nLayers = 0;
+  this->_ncid = -1;
+  this->_timeError = MetOceanViewer::Error::NOERR;
+  this->_firstLayer = 1;
+  this->_lastLayer = std::numeric_limits<int>::max();
+  this->_startDate = std::numeric_limits<qint64>::min();
+  this->_endDate = std::numeric_limits<qint64>::max();
 
   int ierr = this->_init();
 
@@ -30,6 +141,11 @@ Dflow::Dflow(QString filename, QObject *parent) : QObject(parent) {
   return;
 }
 
+//...The file stays open for the lifetime of the object
+Dflow::~Dflow() {
+  if (this->_ncid >= 0) nc_close(this->_ncid);
+}
+
 bool Dflow::is3d() { return this->_is3d; }
 
 QStringList Dflow::getVaribleList() { return QStringList(this->_plotvarnames); }
@@ -49,202 +165,246 @@ bool Dflow::variableIs3d(QString variable) {
     return false;
 }
 
-int Dflow::_get2DVelocityMagnitude(int layer, QVector<QVector<double>> &data) {
-  int ierr, i, j;
-  QVector<QVector<double>> x_data, y_data;
-
-  ierr = this->_getVar(QStringLiteral("x_velocity"), layer, x_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOXVELOCITY);
-    return this->error->errorCode();
-  }
-
-  ierr = this->_getVar(QStringLiteral("y_velocity"), layer, y_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOYVELOCITY);
-    return this->error->errorCode();
-  }
-
-  data.resize(this->_nStations);
-  for (i = 0; i < this->_nStations; i++) {
-    data[i].resize(this->_nSteps);
-    for (j = 0; j < this->_nSteps; j++) {
-      if (x_data[i][j] == HmdfStation::nullDataValue() ||
-          y_data[i][j] == HmdfStation::nullDataValue())
-        data[i][j] = HmdfStation::nullDataValue();
-      else
-        data[i][j] = qSqrt(qPow(x_data[i][j], 2.0) + qPow(y_data[i][j], 2.0));
+void Dflow::registerDerivedVariable(const QString &name,
+                                    const QStringList &components,
+                                    DerivedKernel kernel, bool requires3d) {
+  DerivedVariable derived;
+  derived.name = name;
+  derived.components = components;
+  derived.kernel = kernel;
+  derived.requires3d = requires3d;
+
+  QMutexLocker lock(&s_derivedMutex);
+  QList<DerivedVariable> &registry = Dflow::_derivedRegistry();
+  for (int i = 0; i < registry.size(); i++) {
+    if (registry[i].name == name) {
+      registry[i] = derived;
+      return;
     }
   }
-  return MetOceanViewer::Error::NOERR;
+  registry.append(derived);
 }
 
-int Dflow::_get2DVelocityDirection(int layer, QVector<QVector<double>> &data) {
-  int ierr, i, j;
-  QVector<QVector<double>> x_data, y_data;
-
-  ierr = this->_getVar(QStringLiteral("x_velocity"), layer, x_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOXVELOCITY);
-    return this->error->errorCode();
-  }
-
-  ierr = this->_getVar(QStringLiteral("y_velocity"), layer, y_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOYVELOCITY);
-    return this->error->errorCode();
-  }
-
-  data.resize(this->_nStations);
-  for (i = 0; i < this->_nStations; i++) {
-    data[i].resize(this->_nSteps);
-    for (j = 0; j < this->_nSteps; j++)
-      if (x_data[i][j] == HmdfStation::nullDataValue() ||
-          y_data[i][j] == HmdfStation::nullDataValue())
-        data[i][j] = HmdfStation::nullDataValue();
-      else
-        data[i][j] = qAtan2(y_data[i][j], x_data[i][j]) * 180.0 / M_PI;
-  }
-  return MetOceanViewer::Error::NOERR;
+//...Built in derived variables, in the order they are listed
+QList<Dflow::DerivedVariable> &Dflow::_derivedRegistry() {
+  static QList<DerivedVariable> registry = []() {
+    QList<DerivedVariable> r;
+    DerivedVariable d;
+    d.requires3d = true;
+    d.name = QStringLiteral("3D_current_speed");
+    d.components = QStringList() << QStringLiteral("x_velocity")
+                                 << QStringLiteral("y_velocity")
+                                 << QStringLiteral("z_velocity");
+    d.kernel = magnitude3Kernel;
+    r.append(d);
+    d.requires3d = false;
+    d.name = QStringLiteral("2D_current_speed");
+    d.components = QStringList() << QStringLiteral("x_velocity")
+                                 << QStringLiteral("y_velocity");
+    d.kernel = magnitudeKernel;
+    r.append(d);
+    d.name = QStringLiteral("2D_current_direction");
+    d.kernel = directionKernel;
+    r.append(d);
+    d.name = QStringLiteral("wind_speed");
+    d.components = QStringList() << QStringLiteral("windx")
+                                 << QStringLiteral("windy");
+    d.kernel = magnitudeKernel;
+    r.append(d);
+    d.name = QStringLiteral("wind_direction");
+    d.kernel = directionKernel;
+    r.append(d);
+    d.name = QStringLiteral("wind_stress");
+    d.kernel = windStressKernel;
+    r.append(d);
+    return r;
+  }();
+  return registry;
 }
 
-int Dflow::_get3DVeloctiyMagnitude(int layer, QVector<QVector<double>> &data) {
-  int ierr, i, j;
-  QVector<QVector<double>> x_data, y_data, z_data;
-
-  ierr = this->_getVar(QStringLiteral("x_velocity"), layer, x_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOXVELOCITY);
-    return this->error->errorCode();
-  }
-
-  ierr = this->_getVar(QStringLiteral("y_velocity"), layer, y_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOYVELOCITY);
-    return this->error->errorCode();
+bool Dflow::_findDerivedVariable(const QString &name,
+                                 DerivedVariable &derived) {
+  QMutexLocker lock(&s_derivedMutex);
+  const QList<DerivedVariable> &registry = Dflow::_derivedRegistry();
+  for (int i = 0; i < registry.size(); i++) {
+    if (registry[i].name == name) {
+      derived = registry[i];
+      return true;
+    }
   }
+  return false;
+}
 
-  ierr = this->_getVar(QStringLiteral("z_velocity"), layer, z_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOZVELOCITY);
-    return this->error->errorCode();
+//...Lists the derived variables whose components are all in the file
+void Dflow::_addDerivedVariables() {
+  QList<DerivedVariable> registry;
+  {
+    QMutexLocker lock(&s_derivedMutex);
+    registry = Dflow::_derivedRegistry();
+  }
+
+  const QList<QString> fileVariables = this->_plotvarnames;
+  for (int i = 0; i < registry.size(); i++) {
+    if (registry[i].requires3d && !this->is3d()) continue;
+    bool available = true;
+    for (int k = 0; k < registry[i].components.size(); k++)
+      if (!fileVariables.contains(registry[i].components[k]))
+        available = false;
+    if (available) this->_plotvarnames.append(registry[i].name);
+  }
+
+  //...Every variable with a vertical dimension can also be reduced over
+  //   the water column
+  if (!this->is3d()) return;
+  const QList<QString> columnVariables = this->_plotvarnames;
+  for (int i = 0; i < columnVariables.size(); i++) {
+    DerivedVariable derived;
+    if (!Dflow::_findDerivedVariable(columnVariables[i], derived))
+      derived.components = QStringList() << columnVariables[i];
+    bool hasColumn = false;
+    for (int k = 0; k < derived.components.size(); k++)
+      if (this->_nDims.value(derived.components[k]) == 3) hasColumn = true;
+    if (!hasColumn) continue;
+    for (size_t m = 0; m < c_numColumnSuffixes; m++)
+      this->_plotvarnames.append(columnVariables[i] + c_columnSuffix[m].suffix);
   }
+}
 
-  data.resize(this->_nStations);
-  for (i = 0; i < this->_nStations; i++) {
-    data[i].resize(this->_nSteps);
-    for (j = 0; j < this->_nSteps; j++) {
-      if (x_data[i][j] == HmdfStation::nullDataValue() ||
-          y_data[i][j] == HmdfStation::nullDataValue() ||
-          z_data[i][j] == HmdfStation::nullDataValue())
-        data[i][j] = HmdfStation::nullDataValue();
-      else
-        data[i][j] = qSqrt(qPow(x_data[i][j], 2.0) + qPow(y_data[i][j], 2.0) +
-                           qPow(z_data[i][j], 2.0));
+//...Splits a water column suffix off a variable name
+static Dflow::ColumnMode columnMode(QString &variable) {
+  for (size_t m = 0; m < c_numColumnSuffixes; m++) {
+    const QString suffix = c_columnSuffix[m].suffix;
+    if (variable.endsWith(suffix)) {
+      variable.chop(suffix.size());
+      return c_columnSuffix[m].mode;
     }
   }
-  return MetOceanViewer::Error::NOERR;
+  return Dflow::SingleLayer;
 }
 
-int Dflow::_getWindVelocityMagnitude(QVector<QVector<double>> &data) {
-  int ierr, i, j;
-  QVector<QVector<double>> x_data, y_data;
+void Dflow::setLayerRange(int firstLayer, int lastLayer) {
+  this->_firstLayer = firstLayer;
+  this->_lastLayer = lastLayer;
+}
 
-  ierr = this->_getVar(QStringLiteral("windx"), 0, x_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOXVELOCITY);
-    return this->error->errorCode();
-  }
-  ierr = this->_getVar(QStringLiteral("windy"), 0, y_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOYVELOCITY);
-    return this->error->errorCode();
-  }
-  data.resize(this->_nStations);
-  for (i = 0; i < this->_nStations; i++) {
-    data[i].resize(this->_nSteps);
-    for (j = 0; j < this->_nSteps; j++) {
-      if (x_data[i][j] == HmdfStation::nullDataValue() ||
-          y_data[i][j] == HmdfStation::nullDataValue())
-        data[i][j] = HmdfStation::nullDataValue();
-      else
-        data[i][j] = qSqrt(qPow(x_data[i][j], 2.0) + qPow(y_data[i][j], 2.0));
-    }
-  }
-  return MetOceanViewer::Error::NOERR;
+void Dflow::setStations(const std::vector<size_t> &stations) {
+  this->_selectedStations = stations;
 }
 
-int Dflow::_getWindDirection(QVector<QVector<double>> &data) {
-  int ierr, i, j;
-  QVector<QVector<double>> x_data, y_data;
+void Dflow::setTimeWindow(qint64 startDate, qint64 endDate) {
+  this->_startDate = startDate;
+  this->_endDate = endDate;
+}
 
-  ierr = this->_getVar(QStringLiteral("windx"), 0, x_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOXVELOCITY);
-    return this->error->errorCode();
-  }
-  ierr = this->_getVar(QStringLiteral("windy"), 0, y_data);
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_NOYVELOCITY);
-    return this->error->errorCode();
-  }
-  data.resize(this->_nStations);
-  for (i = 0; i < this->_nStations; i++) {
-    data[i].resize(this->_nSteps);
-    for (j = 0; j < this->_nSteps; j++)
-      if (x_data[i][j] == HmdfStation::nullDataValue() ||
-          y_data[i][j] == HmdfStation::nullDataValue())
-        data[i][j] = HmdfStation::nullDataValue();
-      else
-        data[i][j] = qAtan2(y_data[i][j], x_data[i][j]) * 180.0 / M_PI;
+void Dflow::clearSelection() {
+  this->_selectedStations.clear();
+  this->_startDate = std::numeric_limits<qint64>::min();
+  this->_endDate = std::numeric_limits<qint64>::max();
+}
+
+//...Sorted station selection (every station when none was set) and its
+//   runs of consecutive station indices. Each run is read with one
+//   hyperslab
+void Dflow::_selectStations(std::vector<size_t> &selected,
+                            std::vector<StationRun> &runs) const {
+  selected.clear();
+  if (this->_selectedStations.empty()) {
+    selected.resize(this->_nStations);
+    for (size_t i = 0; i < this->_nStations; i++) selected[i] = i;
+  } else {
+    for (size_t i = 0; i < this->_selectedStations.size(); i++)
+      if (this->_selectedStations[i] < this->_nStations)
+        selected.push_back(this->_selectedStations[i]);
+    std::sort(selected.begin(), selected.end());
+    selected.erase(std::unique(selected.begin(), selected.end()),
+                   selected.end());
+  }
+
+  runs.clear();
+  for (size_t j = 0; j < selected.size(); j++) {
+    if (!runs.empty() &&
+        runs.back().first + runs.back().count == selected[j]) {
+      runs.back().count++;
+      continue;
+    }
+    StationRun run;
+    run.first = selected[j];
+    run.count = 1;
+    run.offset = j;
+    runs.push_back(run);
   }
-  return MetOceanViewer::Error::NOERR;
 }
 
 int Dflow::getVariable(QString variable, int layer, Hmdf *hmdf) {
-  int i, ierr;
   QVector<qint64> time;
-  QVector<QVector<double>> data;
 
-  ierr = this->_getTime(time);
+  int ierr = this->_getTime(time);
   this->error->setErrorCode(ierr);
   if (this->error->isError()) return this->error->errorCode();
 
-  //...Check for derrived data or just retrieve the
-  //   requested variable
-  if (variable == QStringLiteral("2D_current_speed"))
-    ierr = this->_get2DVelocityMagnitude(layer, data);
-  else if (variable == QStringLiteral("2D_current_direction"))
-    ierr = this->_get2DVelocityDirection(layer, data);
-  else if (variable == QStringLiteral("3D_current_speed"))
-    ierr = this->_get3DVeloctiyMagnitude(layer, data);
-  else if (variable == QStringLiteral("wind_speed"))
-    ierr = this->_getWindVelocityMagnitude(data);
-  else if (variable == QStringLiteral("wind_direction"))
-    ierr = this->_getWindDirection(data);
-  else
-    ierr = this->_getVar(variable, layer, data);
-
-  if (ierr != MetOceanViewer::Error::NOERR) {
-    this->error->setErrorCode(ierr);
-    return this->error->errorCode();
-  }
+  //...Derived variables are computed from their components, anything else
+  //   is read as it is in the file
+  const ColumnMode mode = columnMode(variable);
+  DerivedVariable derived;
+  if (!Dflow::_findDerivedVariable(variable, derived)) {
+    derived.name = variable;
+    derived.components = QStringList() << variable;
+    derived.kernel = copyKernel;
+    derived.requires3d = false;
+  }
+
+  //...Output steps inside the time window
+  size_t firstStep = 0, lastStep = time.size();
+  if (this->_startDate != std::numeric_limits<qint64>::min())
+    firstStep = std::lower_bound(time.begin(), time.end(), this->_startDate) -
+                time.begin();
+  if (this->_endDate != std::numeric_limits<qint64>::max())
+    lastStep = std::upper_bound(time.begin() + firstStep, time.end(),
+                                this->_endDate) -
+               time.begin();
+  const size_t nSnaps = lastStep - firstStep;
+
+  std::vector<size_t> selected;
+  std::vector<StationRun> runs;
+  this->_selectStations(selected, runs);
 
   hmdf->setSuccess(false);
   hmdf->setDatum("dflowfm_datum");
   hmdf->setHeader1("DFlowFM");
   hmdf->setHeader2("DFlowFM");
   hmdf->setHeader3("DFlowFM");
+  hmdf->reserve(selected.size() * nSnaps);
+
+  //...Size every station before taking pointers into the shared store
+  std::vector<HmdfStation *> stations(selected.size());
+  for (size_t j = 0; j < selected.size(); j++) {
+    stations[j] = new HmdfStation(hmdf);
+    stations[j]->resize(nSnaps);
+  }
+  std::vector<double *> output(selected.size());
+  for (size_t j = 0; j < selected.size(); j++) {
+    std::copy(time.begin() + firstStep, time.begin() + lastStep,
+              stations[j]->mutableDateSpan().begin());
+    output[j] = stations[j]->mutableDataSpan().data();
+  }
+
+  ierr = this->_readVariable(derived, layer, mode, runs, firstStep, lastStep,
+                             output);
+  if (ierr != MetOceanViewer::Error::NOERR) {
+    for (size_t j = 0; j < selected.size(); j++) delete stations[j];
+    this->error->setErrorCode(ierr);
+    return this->error->errorCode();
+  }
 
-  for (i = 0; i < this->_nStations; i++) {
-    HmdfStation *station = new HmdfStation(hmdf);
-    station->setDate(time);
-    station->setData(data[i]);
+  for (size_t j = 0; j < selected.size(); j++) {
+    const size_t i = selected[j];
+    HmdfStation *station = stations[j];
     station->setLatitude(this->_yCoordinates[i]);
     station->setLongitude(this->_xCoordinates[i]);
     station->setStationIndex(i);
     station->setId(QString::number(i));
     station->setName(this->_stationNames[i]);
+    station->commitWrites();
     hmdf->addStation(station);
   }
   hmdf->setSuccess(true);
@@ -252,8 +412,45 @@ int Dflow::getVariable(QString variable, int layer, Hmdf *hmdf) {
   return MetOceanViewer::Error::NOERR;
 }
 
+
 int Dflow::_init() {
-  int ierr;
+  int ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE,
+                     &this->_ncid);
+  if (ierr != NC_NOERR) {
+    this->_ncid = -1;
+    this->error->setNcErrorCode(ierr);
+    this->error->setErrorCode(MetOceanViewer::Error::DFLOW_GETPLOTVARS);
+    return this->error->errorCode();
+  }
+
+  //...Files already scanned (and not modified since) skip the scan
+  const QString key = metadataKey(this->_filename);
+  bool cached = false;
+  {
+    QMutexLocker lock(&s_metadataMutex);
+    auto entry = s_metadataCache.constFind(key);
+    if (entry != s_metadataCache.constEnd()) {
+      const DflowMetadata &m = entry.value();
+      this->_varnames = m.varnames;
+      this->_dimnames = m.dimnames;
+      this->_nDims = m.nDims;
+      this->_plotvarnames = m.plotvarnames;
+      this->_is3d = m.is3d;
+      this->_nLayers = m.nLayers;
+      this->_nStations = m.nStations;
+      this->_nSteps = m.nSteps;
+      this->_xCoordinates = m.xCoordinates;
+      this->_yCoordinates = m.yCoordinates;
+      this->_stationNames = m.stationNames;
+      this->_time = m.time;
+      this->_timeError = m.timeError;
+      cached = true;
+    }
+  }
+  if (cached) {
+    this->_addDerivedVariables();
+    return MetOceanViewer::Error::NOERR;
+  }
 
   ierr = this->_getPlottingVariables();
   if (ierr != MetOceanViewer::Error::NOERR) {
@@ -267,11 +464,35 @@ int Dflow::_init() {
     return this->error->errorCode();
   }
 
+  //...A bad time axis is only reported when data is requested
+  this->_timeError = this->_readTime();
+
+  DflowMetadata m;
+  m.varnames = this->_varnames;
+  m.dimnames = this->_dimnames;
+  m.nDims = this->_nDims;
+  m.plotvarnames = this->_plotvarnames;
+  m.is3d = this->_is3d;
+  m.nLayers = this->_nLayers;
+  m.nStations = this->_nStations;
+  m.nSteps = this->_nSteps;
+  m.xCoordinates = this->_xCoordinates;
+  m.yCoordinates = this->_yCoordinates;
+  m.stationNames = this->_stationNames;
+  m.time = this->_time;
+  m.timeError = this->_timeError;
+  {
+    QMutexLocker lock(&s_metadataMutex);
+    s_metadataCache.insert(key, m);
+  }
+
+  this->_addDerivedVariables();
+
   return MetOceanViewer::Error::NOERR;
 }
 
 int Dflow::_get3d() {
-  int ierr, ncid;
+  int ierr;
   size_t nLayers;
 
   if (this->_dimnames.contains("laydimw"))
@@ -281,21 +502,7 @@ int Dflow::_get3d() {
     return MetOceanViewer::Error::NOERR;
   }
 
-  ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE, &ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
-
-  ierr = nc_inq_dimlen(ncid, this->_dimnames["laydim"], &nLayers);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
-
-  ierr = nc_close(ncid);
+  ierr = nc_inq_dimlen(this->_ncid, this->_dimnames["laydim"], &nLayers);
   if (ierr != NC_NOERR) {
     this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
     this->error->setNcErrorCode(ierr);
@@ -307,22 +514,14 @@ int Dflow::_get3d() {
   return MetOceanViewer::Error::NOERR;
 }
 
-#include <iostream>
 int Dflow::_getPlottingVariables() {
-  int ncid;
-  int ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE, &ncid);
-  this->error->setNcErrorCode(ierr);
-  if (this->error->isNcError()) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    return this->error->errorCode();
-  }
+  const int ncid = this->_ncid;
 
   int nvar;
-  ierr = nc_inq_nvars(ncid, &nvar);
+  int ierr = nc_inq_nvars(ncid, &nvar);
   this->error->setNcErrorCode(ierr);
   if (this->error->isNcError()) {
     this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    ierr = nc_close(ncid);
     return this->error->errorCode();
   }
 
@@ -331,7 +530,6 @@ int Dflow::_getPlottingVariables() {
   this->error->setNcErrorCode(ierr);
   if (this->error->isNcError()) {
     this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    ierr = nc_close(ncid);
     return this->error->errorCode();
   }
 
@@ -343,7 +541,6 @@ int Dflow::_getPlottingVariables() {
     if (ierr != NC_NOERR) {
       this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
       this->error->setNcErrorCode(ierr);
-      ierr = nc_close(ncid);
       return MetOceanViewer::Error::NETCDF;
     }
     boost::trim_right(varname);
@@ -359,7 +556,6 @@ int Dflow::_getPlottingVariables() {
     if (ierr != NC_NOERR) {
       this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
       this->error->setNcErrorCode(ierr);
-      ierr = nc_close(ncid);
       return MetOceanViewer::Error::NETCDF;
     }
 
@@ -373,7 +569,6 @@ int Dflow::_getPlottingVariables() {
     if (ierr != NC_NOERR) {
       this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
       this->error->setNcErrorCode(ierr);
-      ierr = nc_close(ncid);
       return MetOceanViewer::Error::NETCDF;
     }
 
@@ -383,7 +578,6 @@ int Dflow::_getPlottingVariables() {
     if (ierr != NC_NOERR) {
       this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
       this->error->setNcErrorCode(ierr);
-      ierr = nc_close(ncid);
       return MetOceanViewer::Error::NETCDF;
     }
 
@@ -404,48 +598,20 @@ int Dflow::_getPlottingVariables() {
     this->_varnames[sname] = i;
   }
 
-  ierr = nc_close(ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
-
   ierr = this->_get3d();
   if (ierr != MetOceanViewer::Error::NOERR)
     return MetOceanViewer::Error::DFLOW_3DVARS;
 
-  if (this->is3d()) {
-    if (this->_plotvarnames.contains("x_velocity") &&
-        this->_plotvarnames.contains("y_velocity") &&
-        this->_plotvarnames.contains("z_velocity"))
-      this->_plotvarnames.append("3D_current_speed");
-  }
-
-  if (this->_plotvarnames.contains("x_velocity") &&
-      this->_plotvarnames.contains("y_velocity")) {
-    this->_plotvarnames.append("2D_current_speed");
-    this->_plotvarnames.append("2D_current_direction");
-  }
-
-  if (this->_plotvarnames.contains("windx") &&
-      this->_plotvarnames.contains("windy")) {
-    this->_plotvarnames.append("wind_speed");
-    this->_plotvarnames.append("wind_direction");
-  }
-
   return MetOceanViewer::Error::NOERR;
 }
 
 int Dflow::_getStations() {
   size_t nstation, name_len;
 
-  int ncid, varid_xcoor, varid_ycoor, varid_namevar;
+  const int ncid = this->_ncid;
+  int varid_xcoor, varid_ycoor, varid_namevar;
   int dimid_nsta, dimid_namelen;
-  int ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE, &ncid);
-  if (ierr != 0) {
-    return MetOceanViewer::Error::CANNOT_OPEN_FILE;
-  }
+  int ierr = 0;
 
   ierr += nc_inq_dimid(ncid, "stations", &dimid_nsta);
   ierr += nc_inq_dimid(ncid, "name_len", &dimid_namelen);
@@ -486,171 +652,244 @@ int Dflow::_getStations() {
     return MetOceanViewer::Error::DFLOW_FILEREADERROR;
   }
 
-  nc_close(ncid);
   return 0;
 }
 
 int Dflow::_getTime(QVector<qint64> &timeList) {
+  if (this->_timeError != MetOceanViewer::Error::NOERR) {
+    this->error->setErrorCode(this->_timeError);
+    return this->_timeError;
+  }
+  timeList = this->_time;
+  return MetOceanViewer::Error::NOERR;
+}
+
+//...Reads the time axis once when the file is opened. It is kept with
+//   the rest of the metadata
+int Dflow::_readTime() {
+  const int ncid = this->_ncid;
   int varid_time = this->_varnames["time"];
   int dimid_time = this->_dimnames["time"];
   std::string units = "units";
 
-  int ncid;
-  int ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE, &ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
-
   size_t nsteps;
-  ierr = nc_inq_dimlen(ncid, dimid_time, &nsteps);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
+  int ierr = nc_inq_dimlen(ncid, dimid_time, &nsteps);
+  if (ierr != NC_NOERR) return MetOceanViewer::Error::NETCDF;
 
   size_t unitsLen;
   ierr = nc_inq_attlen(ncid, varid_time, units.data(), &unitsLen);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
+  if (ierr != NC_NOERR) return MetOceanViewer::Error::NETCDF;
 
   std::string refstring(unitsLen, ' ');
   ierr = nc_get_att(ncid, varid_time, units.data(), &refstring[0]);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
+  if (ierr != NC_NOERR) return MetOceanViewer::Error::NETCDF;
 
-  QString refString = QString::fromStdString(refstring.substr(14, 19));
-  this->_refTime =
-      QDateTime::fromString(refString, QStringLiteral("yyyy-MM-dd hh:mm:ss"));
-  this->_refTime.setTimeSpec(Qt::UTC);
+  TimeConversion::Unit unit;
+  qint64 refTime;
+  if (!TimeConversion::parseUnits(QString::fromStdString(refstring), unit,
+                                  refTime))
+    return MetOceanViewer::Error::DFLOW_FILEREADERROR;
 
   std::vector<double> times(nsteps);
   this->_nSteps = nsteps;
   ierr = nc_get_var_double(ncid, varid_time, times.data());
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
-  }
+  if (ierr != NC_NOERR) return MetOceanViewer::Error::NETCDF;
 
-  timeList.resize(nsteps);
-  for (size_t i = 0; i < this->_nSteps; i++) {
-    timeList[i] =
-        this->_refTime.addSecs(qRound64(times[i])).toMSecsSinceEpoch();
-  }
+  this->_time.resize(nsteps);
+  TimeConversion::toMsecs(times.data(), nsteps, refTime, unit,
+                          this->_time.data());
 
   return MetOceanViewer::Error::NOERR;
 }
 
-int Dflow::_getVar(QString variable, int layer,
-                   QVector<QVector<double>> &data) {
-  if (this->_nDims[variable] == 2)
-    return this->_getVar2D(variable, data);
-  else if (this->_nDims[variable] == 3)
-    return this->_getVar3D(variable, layer, data);
-  else
-    return MetOceanViewer::Error::DFLOW_ILLEGALDIMENSION;
-}
-
-int Dflow::_getVar2D(QString variable, QVector<QVector<double>> &data) {
-  data.resize(this->_nStations);
-  for (size_t i = 0; i < this->_nStations; i++) data[i].resize(this->_nSteps);
+//...Reads the components of a variable in blocks of output steps (every
+//   station), runs the kernel once over the whole block, masks the values
+//   where any component is missing and writes the result into the
+//   station arrays. 3D components are read at the given layer or, for the
+//   water column modes, as whole columns (every layer in one hyperslab)
+//   that are reduced before the kernel runs
+int Dflow::_readVariable(const DerivedVariable &variable, int layer,
+                         ColumnMode mode, const std::vector<StationRun> &runs,
+                         size_t firstStep, size_t lastStep,
+                         const std::vector<double *> &output) {
+  const int nComponents = variable.components.size();
+  std::vector<int> varid(nComponents);
+  for (int k = 0; k < nComponents; k++) {
+    const QString &name = variable.components[k];
+    if (!this->_varnames.contains(name))
+      return MetOceanViewer::Error::DFLOW_VARNOTFOUND;
+    if (this->_nDims[name] != 2 && this->_nDims[name] != 3)
+      return MetOceanViewer::Error::DFLOW_ILLEGALDIMENSION;
+    varid[k] = this->_varnames[name];
+  }
+
+  if (mode != SingleLayer && this->_nLayers == 0)
+    return MetOceanViewer::Error::DFLOW_3DVARS;
+  if (runs.empty() || lastStep <= firstStep)
+    return MetOceanViewer::Error::NOERR;
 
-  int ncid;
-  int varid = this->_varnames[variable];
-  int ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE, &ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
+  const size_t nStations = runs.back().offset + runs.back().count;
+  const size_t nLayers = mode == SingleLayer ? 1 : this->_nLayers;
+  const size_t blockTimes = std::max(
+      static_cast<size_t>(1),
+      std::min(lastStep - firstStep, c_blockSize / (nStations * nLayers)));
+
+  //...Layer interfaces weight the depth averages. Without them the
+  //   layers are weighted equally
+  int varid_interface = -1;
+  std::vector<double> interface, thickness;
+  if (mode == DepthAverage || mode == LayerRange) {
+    if (this->_varnames.contains("zcoordinate_w") &&
+        this->_nDims["zcoordinate_w"] == 3) {
+      varid_interface = this->_varnames["zcoordinate_w"];
+      interface.resize(blockTimes * nStations * (nLayers + 1));
+    }
+    thickness.resize(blockTimes * nStations * nLayers);
   }
+  std::vector<double> column;
+  if (mode != SingleLayer) column.resize(blockTimes * nStations * nLayers);
 
-  std::vector<size_t> start(2, 0);
-  std::vector<size_t> count(2, 0);
-  std::vector<double> d(this->_nSteps * this->_nStations);
-  start[0] = 0;
-  start[1] = 0;
-  count[0] = this->_nSteps;
-  count[1] = this->_nStations;
-  ierr = nc_get_vara_double(ncid, varid, start.data(), count.data(), d.data());
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
+  std::vector<std::vector<double>> component(nComponents);
+  std::vector<const double *> componentPtr(nComponents);
+  for (int k = 0; k < nComponents; k++) {
+    component[k].resize(blockTimes * nStations);
+    componentPtr[k] = component[k].data();
   }
+  std::vector<double> block(blockTimes * nStations);
 
-  for (size_t i = 0; i < this->_nSteps; i++)
-    for (size_t j = 0; j < this->_nStations; j++) {
-      if (d[i * this->_nStations + j] == -999.0)
-        data[j][i] = HmdfStation::nullDataValue();
-      else
-        data[j][i] = d[i * this->_nStations + j];
+  for (size_t t = firstStep; t < lastStep; t += blockTimes) {
+    const size_t nt = std::min(blockTimes, lastStep - t);
+    const size_t n = nt * nStations;
+
+    if (!thickness.empty()) {
+      int ierr = this->_readThickness(varid_interface, runs, t, nt, interface,
+                                      thickness);
+      if (ierr != MetOceanViewer::Error::NOERR) return ierr;
     }
 
-  ierr = nc_close(ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
+    for (int k = 0; k < nComponents; k++) {
+      const bool reduce = mode != SingleLayer &&
+                          this->_nDims[variable.components[k]] == 3;
+      int ierr = this->_readRuns(
+          varid[k], runs, t, nt, reduce ? 0 : static_cast<size_t>(layer - 1),
+          reduce ? nLayers : 1, reduce ? column.data() : component[k].data());
+      if (ierr != MetOceanViewer::Error::NOERR) return ierr;
+      if (reduce)
+        this->_reduceColumns(column.data(),
+                             thickness.empty() ? nullptr : thickness.data(),
+                             n, nLayers, mode, component[k].data());
+    }
+
+    variable.kernel(componentPtr.data(), n, block.data());
+    for (int k = 0; k < nComponents; k++) {
+      const double *c = componentPtr[k];
+      for (size_t i = 0; i < n; i++)
+        if (c[i] == c_fillValue) block[i] = HmdfStation::nullDataValue();
+    }
+
+    //...The block holds one (time, station) slab per run
+    for (size_t r = 0; r < runs.size(); r++) {
+      const double *slab = block.data() + nt * runs[r].offset;
+      for (size_t j = 0; j < runs[r].count; j++) {
+        double *out = output[runs[r].offset + j] + (t - firstStep);
+        for (size_t i = 0; i < nt; i++) out[i] = slab[i * runs[r].count + j];
+      }
+    }
   }
 
   return MetOceanViewer::Error::NOERR;
 }
 
-int Dflow::_getVar3D(QString variable, int layer,
-                     QVector<QVector<double>> &data) {
-  std::vector<double> d(this->_nSteps * this->_nStations, 0);
-  std::vector<size_t> start(3, 0);
-  std::vector<size_t> count(3, 0);
-
-  data.resize(this->_nStations);
-  for (size_t i = 0; i < this->_nStations; i++) data[i].resize(this->_nSteps);
-
-  int ncid;
-  int varid = this->_varnames[variable];
-  int ierr = nc_open(this->_filename.toStdString().c_str(), NC_NOWRITE, &ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
+//...Reads nt output steps of each run of stations (and nLayers layers
+//   from firstLayer for 3D variables). Run r lands at nt * offset *
+//   nLayers in the buffer as a (time, station, layer) slab
+int Dflow::_readRuns(int varid, const std::vector<StationRun> &runs,
+                     size_t t, size_t nt, size_t firstLayer, size_t nLayers,
+                     double *buffer) {
+  for (size_t r = 0; r < runs.size(); r++) {
+    size_t start[3] = {t, runs[r].first, firstLayer};
+    size_t count[3] = {nt, runs[r].count, nLayers};
+    int ierr = nc_get_vara_double(this->_ncid, varid, start, count,
+                                  buffer + nt * runs[r].offset * nLayers);
+    if (ierr != NC_NOERR) {
+      this->error->setNcErrorCode(ierr);
+      return MetOceanViewer::Error::NETCDF;
+    }
   }
+  return MetOceanViewer::Error::NOERR;
+}
 
-  start[0] = 0;
-  start[1] = 0;
-  start[2] = layer - 1;
-  count[0] = this->_nSteps;
-  count[1] = this->_nStations;
-  count[2] = 1;
-  ierr = nc_get_vara_double(ncid, varid, start.data(), count.data(), d.data());
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
+//...Layer thicknesses of a block from the layer interface elevations.
+//   Missing or collapsed layers get no weight
+int Dflow::_readThickness(int varid, const std::vector<StationRun> &runs,
+                          size_t t, size_t nt,
+                          std::vector<double> &interface,
+                          std::vector<double> &thickness) {
+  const size_t nLayers = this->_nLayers;
+  const size_t n = nt * (runs.back().offset + runs.back().count);
+
+  if (varid < 0) {
+    std::fill(thickness.begin(), thickness.begin() + n * nLayers, 1.0);
+    return MetOceanViewer::Error::NOERR;
   }
 
-  for (size_t i = 0; i < this->_nSteps; i++) {
-    for (size_t j = 0; j < this->_nStations; j++) {
-      if (d[i * this->_nStations + j] == -999.0)
-        data[j][i] = HmdfStation::nullDataValue();
+  int ierr =
+      this->_readRuns(varid, runs, t, nt, 0, nLayers + 1, interface.data());
+  if (ierr != MetOceanViewer::Error::NOERR) return ierr;
+
+  for (size_t i = 0; i < n; i++) {
+    const double *z = &interface[i * (nLayers + 1)];
+    double *dz = &thickness[i * nLayers];
+    for (size_t k = 0; k < nLayers; k++) {
+      if (z[k] == c_fillValue || z[k + 1] == c_fillValue)
+        dz[k] = 0.0;
       else
-        data[j][i] = d[i * this->_nStations + j];
+        dz[k] = std::max(0.0, z[k + 1] - z[k]);
     }
   }
+  return MetOceanViewer::Error::NOERR;
+}
 
-  ierr = nc_close(ncid);
-  if (ierr != NC_NOERR) {
-    this->error->setErrorCode(MetOceanViewer::Error::NETCDF);
-    this->error->setNcErrorCode(ierr);
-    return MetOceanViewer::Error::NETCDF;
+//...Reduces n water columns of nLayers values (layer 1 at the bed) to one
+//   value each. Missing layers are skipped; a column with nothing left is
+//   set to the fill value so that it is masked
+void Dflow::_reduceColumns(const double *column, const double *thickness,
+                           size_t n, size_t nLayers, ColumnMode mode,
+                           double *output) const {
+  size_t first = 0, last = nLayers;
+  if (mode == LayerRange) {
+    first = static_cast<size_t>(std::max(1, this->_firstLayer) - 1);
+    last = std::min(nLayers, static_cast<size_t>(std::max(
+                                 this->_firstLayer, this->_lastLayer)));
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    const double *c = column + i * nLayers;
+    double value = c_fillValue;
+    if (mode == Bottom) {
+      for (size_t k = 0; k < nLayers; k++) {
+        if (c[k] != c_fillValue) {
+          value = c[k];
+          break;
+        }
+      }
+    } else if (mode == Surface) {
+      for (size_t k = nLayers; k > 0; k--) {
+        if (c[k - 1] != c_fillValue) {
+          value = c[k - 1];
+          break;
+        }
+      }
+    } else {
+      const double *dz = thickness + i * nLayers;
+      double sum = 0.0, depth = 0.0;
+      for (size_t k = first; k < last; k++) {
+        if (c[k] == c_fillValue) continue;
+        sum += c[k] * dz[k];
+        depth += dz[k];
+      }
+      if (depth > 0.0) value = sum / depth;
+    }
+    output[i] = value;
   }
-
-  return MetOceanViewer::Error::NOERR;
 }
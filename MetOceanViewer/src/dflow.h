@@ -5,7 +5,9 @@
 #include <QList>
 #include <QMap>
 #include <QObject>
+#include <QStringList>
 #include <QVector>
+#include <vector>
 #include "errors.h"
 #include "hmdf.h"
 
@@ -13,6 +15,7 @@ class Dflow : public QObject {
   Q_OBJECT
  public:
   explicit Dflow(QString filename, QObject *parent = nullptr);
+  ~Dflow();
 
   QStringList getVaribleList();
 
@@ -28,6 +31,37 @@ class Dflow : public QObject {
 
   bool variableIs3d(QString variable);
 
+  //...Water column reductions of 3D variables. They are listed as the
+  //   variable name followed by _depth_averaged, _surface, _bottom or
+  //   _layer_range
+  enum ColumnMode { SingleLayer, DepthAverage, Surface, Bottom, LayerRange };
+
+  //...Layers (1 based, inclusive, layer 1 at the bed) averaged by the
+  //   _layer_range variables. All layers by default
+  void setLayerRange(int firstLayer, int lastLayer);
+
+  //...Restricts getVariable() to the given station indices and to the
+  //   output steps between the two dates (milliseconds since the epoch,
+  //   inclusive). Only the selected stations are read from the file
+  void setStations(const std::vector<size_t> &stations);
+  void setTimeWindow(qint64 startDate, qint64 endDate);
+  void clearSelection();
+
+  //...Kernel of a derived variable. component[k] holds n values of the
+  //   k-th component and the kernel writes n derived values to output.
+  //   Values where any component is missing are masked afterwards, so a
+  //   kernel does not need to check for them
+  typedef void (*DerivedKernel)(const double *const *component, size_t n,
+                                double *output);
+
+  //...Adds a variable computed from variables in the file. It is listed
+  //   for files that have all of its components (and are 3D when
+  //   requires3d is set). Registering an existing name replaces it
+  static void registerDerivedVariable(const QString &name,
+                                      const QStringList &components,
+                                      DerivedKernel kernel,
+                                      bool requires3d = false);
+
   Errors *error;
 
  private:
@@ -36,18 +70,50 @@ class Dflow : public QObject {
   int _getStations();
   int _get3d();
   int _getTime(QVector<qint64> &timeList);
-  int _getVar(QString variable, int layer, QVector<QVector<double>> &data);
-  int _getVar2D(QString variable, QVector<QVector<double>> &data);
-  int _getVar3D(QString variable, int layer, QVector<QVector<double>> &data);
-  int _get2DVelocityMagnitude(int layer, QVector<QVector<double>> &data);
-  int _get2DVelocityDirection(int layer, QVector<QVector<double>> &data);
-  int _get3DVeloctiyMagnitude(int layer, QVector<QVector<double>> &data);
-  int _getWindVelocityMagnitude(QVector<QVector<double>> &data);
-  int _getWindDirection(QVector<QVector<double>> &data);
+  int _readTime();
+
+  struct DerivedVariable {
+    QString name;
+    QStringList components;
+    DerivedKernel kernel;
+    bool requires3d;
+  };
+
+  static QList<DerivedVariable> &_derivedRegistry();
+  static bool _findDerivedVariable(const QString &name,
+                                   DerivedVariable &derived);
+  void _addDerivedVariables();
+  struct StationRun {
+    size_t first;
+    size_t count;
+    size_t offset;
+  };
+
+  void _selectStations(std::vector<size_t> &selected,
+                       std::vector<StationRun> &runs) const;
+  int _readVariable(const DerivedVariable &variable, int layer,
+                    ColumnMode mode, const std::vector<StationRun> &runs,
+                    size_t firstStep, size_t lastStep,
+                    const std::vector<double *> &output);
+  int _readRuns(int varid, const std::vector<StationRun> &runs, size_t t,
+                size_t nt, size_t firstLayer, size_t nLayers, double *buffer);
+  int _readThickness(int varid, const std::vector<StationRun> &runs,
+                     size_t t, size_t nt, std::vector<double> &interface,
+                     std::vector<double> &thickness);
+  void _reduceColumns(const double *column, const double *thickness,
+                      size_t n, size_t nLayers, ColumnMode mode,
+                      double *output) const;
 
   bool _isInitialized;
   bool _readError;
   bool _is3d;
+  int _ncid;
+  int _timeError;
+  int _firstLayer;
+  int _lastLayer;
+  qint64 _startDate;
+  qint64 _endDate;
+  std::vector<size_t> _selectedStations;
   size_t _nStations;
   size_t _nSteps;
   size_t _nLayers;
@@ -59,7 +125,7 @@ class Dflow : public QObject {
   QVector<double> _xCoordinates;
   QVector<double> _yCoordinates;
   QVector<QString> _stationNames;
-  QDateTime _refTime;
+  QVector<qint64> _time;
 };
 
 #endif  // DFLOW_H
@@ -1,6 +1,7 @@
 #include "filetypes.h"
 #include <QFileInfo>
 #include <QMap>
+#include "hmdfbinaryfile.h"
 #include "netcdf.h"
 
 static QMap<QString, int> filetypeMapString = {
@@ -8,6 +9,7 @@ static QMap<QString, int> filetypeMapString = {
     {QStringLiteral("NETCDF-DFLOW"), MetOceanViewer::FileType::NETCDF_DFLOW},
     {QStringLiteral("ASCII-ADCIRC"), MetOceanViewer::FileType::ASCII_ADCIRC},
     {QStringLiteral("ASCII-IMEDS"), MetOceanViewer::FileType::ASCII_IMEDS},
+    {QStringLiteral("BINARY-HMDF"), MetOceanViewer::FileType::BINARY_HMDF},
     {QStringLiteral("NETCDF-GENERIC"),
      MetOceanViewer::FileType::NETCDF_GENERIC}};
 
@@ -16,12 +18,15 @@ static QMap<int, QString> filetypeMapInt = {
     {MetOceanViewer::FileType::NETCDF_DFLOW, QStringLiteral("NETCDF-DFLOW")},
     {MetOceanViewer::FileType::ASCII_ADCIRC, QStringLiteral("ASCII-ADCIRC")},
     {MetOceanViewer::FileType::ASCII_IMEDS, QStringLiteral("ASCII-IMEDS")},
+    {MetOceanViewer::FileType::BINARY_HMDF, QStringLiteral("BINARY-HMDF")},
     {MetOceanViewer::FileType::NETCDF_GENERIC,
      QStringLiteral("NETCDF-GENERIC")}};
 
 Filetypes::Filetypes(QObject *parent) : QObject(parent) {}
 
 int Filetypes::getIntegerFiletype(QString filename) {
+  if (Filetypes::_checkBinaryHmdf(filename))
+    return MetOceanViewer::FileType::BINARY_HMDF;
   if (Filetypes::_checkNetcdfGeneric(filename))
     return MetOceanViewer::FileType::NETCDF_GENERIC;
   if (Filetypes::_checkNetcdfAdcirc(filename))
@@ -36,6 +41,8 @@ int Filetypes::getIntegerFiletype(QString filename) {
 }
 
 QString Filetypes::getStringFiletype(QString filename) {
+  if (Filetypes::_checkBinaryHmdf(filename))
+    return QStringLiteral("BINARY-HMDF");
   if (Filetypes::_checkNetcdfGeneric(filename))
     return QStringLiteral("NETCDF-GENERIC");
   if (Filetypes::_checkNetcdfAdcirc(filename))
@@ -131,11 +138,20 @@ bool Filetypes::_checkNetcdfGeneric(QString filename) {
   ierr = nc_open(filename.toStdString().c_str(), NC_NOWRITE, &ncid);
   if (ierr != 0) return false;
   ierr = nc_inq_varid(ncid, "time_station_0001", &varid);
+  if (ierr != 0) {
+    //...Contiguous ragged array layout
+    ierr = nc_inq_varid(ncid, "rowSize", &varid);
+    if (ierr == 0) ierr = nc_inq_varid(ncid, "stationXCoordinate", &varid);
+  }
   nc_close(ncid);
   if (ierr != 0) return false;
   return true;
 }
 
+bool Filetypes::_checkBinaryHmdf(QString filename) {
+  return HmdfBinaryFile::isBinaryFile(filename);
+}
+
 QString Filetypes::integerFiletypeToString(int filetype) {
   return filetypeMapInt[filetype];
 }
@@ -19,6 +19,7 @@ private:
   static bool _checkASCIIAdcirc(QString filename);
   static bool _checkASCIIImeds(QString filename);
   static bool _checkNetcdfGeneric(QString filename);
+  static bool _checkBinaryHmdf(QString filename);
 };
 
 #endif // FILETYPES_H
@@ -10,6 +10,7 @@ enum _filetype {
   NETCDF_GENERIC,
   ASCII_ADCIRC,
   ASCII_IMEDS,
+  BINARY_HMDF,
   FILETYPE_ERROR
 };
 };
@@ -116,8 +116,10 @@ int Ndbc::plot(int index) {
   series1->setPen(
       QPen(QColor(0, 0, 255), 3, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
 
-  for (int j = 0; j < s->numSnaps(); j++) {
-    series1->append(s->date(j) - offset, s->data(j));
+  HmdfSpan<const qint64> date = s->dateSpan();
+  HmdfSpan<const double> data = s->dataSpan();
+  for (size_t j = 0; j < date.size(); j++) {
+    series1->append(date[j] - offset, data[j]);
   }
 
   this->m_chartView->addSeries(series1, s->name());
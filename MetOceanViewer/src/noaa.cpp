@@ -125,10 +125,10 @@ int Noaa::getDataBounds(double &ymin, double &ymax) {
 
   for (size_t i = 0; i < this->m_currentStationData.length(); i++) {
     if (!this->m_currentStationData[i]->null()) {
-      QVector<double> data =
-          this->m_currentStationData[i]->station(0)->allData();
-      double min = *std::min_element(data.begin(), data.end());
-      double max = *std::max_element(data.begin(), data.end());
+      qint64 minDate, maxDate;
+      double min, max;
+      this->m_currentStationData[i]->station(0)->dataBounds(minDate, maxDate,
+                                                            min, max);
       ymin = std::min(ymin, min);
       ymax = std::max(ymax, max);
     }
@@ -238,34 +238,33 @@ int Noaa::plotChart() {
   this->m_chartView->setDateFormat(minDateTime, maxDateTime);
   this->m_chartView->setAxisLimits(minDateTime, maxDateTime, ymin, ymax);
 
-  for (size_t j = 0; j < this->m_currentStationData[0]->station(0)->numSnaps();
-       j++) {
-    if (QDateTime::fromMSecsSinceEpoch(
-            this->m_currentStationData[0]->station(0)->date(j) +
-                this->m_offsetSeconds,
-            Qt::UTC)
+  HmdfSpan<const qint64> date1 =
+      this->m_currentStationData[0]->station(0)->dateSpan();
+  HmdfSpan<const double> data1 =
+      this->m_currentStationData[0]->station(0)->dataSpan();
+  for (size_t j = 0; j < date1.size(); j++) {
+    if (QDateTime::fromMSecsSinceEpoch(date1[j] + this->m_offsetSeconds,
+                                       Qt::UTC)
             .isValid()) {
-      if (this->m_currentStationData[0]->station(0)->data(j) != 0.0)
-        series1->append(this->m_currentStationData[0]->station(0)->date(j) +
-                            this->m_offsetSeconds - offset,
-                        this->m_currentStationData[0]->station(0)->data(j));
+      if (data1[j] != 0.0)
+        series1->append(date1[j] + this->m_offsetSeconds - offset, data1[j]);
     }
   }
 
   this->m_chartView->addSeries(series1, series1->name());
 
   if (this->m_productIndex == 0) {
-    for (size_t j = 0;
-         j < this->m_currentStationData[1]->station(0)->numSnaps(); j++)
-      if (QDateTime::fromMSecsSinceEpoch(
-              this->m_currentStationData[1]->station(0)->date(j) +
-                  this->m_offsetSeconds,
-              Qt::UTC)
+    HmdfSpan<const qint64> date2 =
+        this->m_currentStationData[1]->station(0)->dateSpan();
+    HmdfSpan<const double> data2 =
+        this->m_currentStationData[1]->station(0)->dataSpan();
+    for (size_t j = 0; j < date2.size(); j++)
+      if (QDateTime::fromMSecsSinceEpoch(date2[j] + this->m_offsetSeconds,
+                                         Qt::UTC)
               .isValid()) {
-        if (this->m_currentStationData[1]->station(0)->data(j) != 0.0)
-          series2->append(this->m_currentStationData[1]->station(0)->date(j) +
-                              this->m_offsetSeconds - offset,
-                          this->m_currentStationData[1]->station(0)->data(j));
+        if (data2[j] != 0.0)
+          series2->append(date2[j] + this->m_offsetSeconds - offset,
+                          data2[j]);
       }
     this->m_chartView->addSeries(series2, series2->name());
   }
@@ -107,7 +107,8 @@ void MainWindow::on_button_crms_savedata_clicked() {
 
   QString TempString = QFileDialog::getSaveFileName(
       this, tr("Save as..."), this->previousDirectory + defaultFile,
-      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc)", &filter);
+      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc);;"
+      "MetOcean Binary (*.movts)", &filter);
 
   QStringList filter2 = filter.split(" ");
   QString format = filter2.value(0);
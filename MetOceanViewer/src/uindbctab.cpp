@@ -85,7 +85,8 @@ void MainWindow::on_button_ndbc_savedata_clicked() {
   QString filter = "IMEDS (*.imeds)";
   QString TempString = QFileDialog::getSaveFileName(
       this, tr("Save as..."), this->previousDirectory + defaultFile,
-      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc)", &filter);
+      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc);;"
+      "MetOcean Binary (*.movts)", &filter);
 
   if (TempString == QString()) return;
 
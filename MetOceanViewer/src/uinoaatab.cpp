@@ -101,7 +101,8 @@ void MainWindow::on_button_noaasavedata_clicked() {
   QString DefaultFile = "/NOAA_" + QString::number(MarkerID) + ".imeds";
   QString TempString = QFileDialog::getSaveFileName(
       this, tr("Save as..."), this->previousDirectory + DefaultFile,
-      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc)");
+      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc);;"
+      "MetOcean Binary (*.movts)");
 
   if (TempString == QString()) return;
 
@@ -18,6 +18,7 @@
 //
 //-----------------------------------------------------------------------*/
 
+#include <limits>
 #include "addtimeseriesdialog.h"
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
@@ -270,6 +271,13 @@ void MainWindow::on_button_processTimeseriesData_clicked() {
   connect(this->m_userTimeseries, SIGNAL(timeseriesError(QString)), this,
           SLOT(throwErrorMessageBox(QString)));
 
+  //...When a date range is set, only the output inside it is read
+  if (!ui->check_TimeseriesAllData->isChecked()) {
+    this->m_userTimeseries->setTimeWindow(
+        ui->date_TimeseriesStartDate->dateTime().toMSecsSinceEpoch(),
+        ui->date_TimeseriesEndDate->dateTime().toMSecsSinceEpoch());
+  }
+
   ierr = this->m_userTimeseries->processData();
   if (ierr != 0)
     QMessageBox::critical(this, tr("ERROR"),
@@ -304,6 +312,19 @@ void MainWindow::on_check_TimeseriesAllData_toggled(bool checked) {
 // key is pressed
 //-------------------------------------------//
 void MainWindow::on_button_plotTimeseriesStation_clicked() {
+  //...The files were read for a narrower date range than the one now
+  //   requested, so they have to be read again before plotting
+  qint64 startDate = std::numeric_limits<qint64>::min();
+  qint64 endDate = std::numeric_limits<qint64>::max();
+  if (!ui->check_TimeseriesAllData->isChecked()) {
+    startDate = ui->date_TimeseriesStartDate->dateTime().toMSecsSinceEpoch();
+    endDate = ui->date_TimeseriesEndDate->dateTime().toMSecsSinceEpoch();
+  }
+  if (this->m_userTimeseries == nullptr ||
+      !this->m_userTimeseries->coversTimeWindow(startDate, endDate)) {
+    this->on_button_processTimeseriesData_clicked();
+  }
+
   this->m_userTimeseries->plot();
   return;
 }
@@ -202,7 +202,8 @@ void MainWindow::on_button_usgssavedata_clicked() {
 
   QString TempString = QFileDialog::getSaveFileName(
       this, tr("Save as..."), this->previousDirectory + DefaultFile,
-      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc)", &filter);
+      "IMEDS (*.imeds);;CSV (*.csv);;netCDF (*.nc);;"
+      "MetOcean Binary (*.movts)", &filter);
 
   QStringList filter2 = filter.split(" ");
 
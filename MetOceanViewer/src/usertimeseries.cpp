@@ -18,12 +18,14 @@
 //
 //-----------------------------------------------------------------------*/
 #include "usertimeseries.h"
+#include <limits>
 #include "adcircstationoutput.h"
 #include "dflow.h"
 #include "errors.h"
 #include "ezproj.h"
 #include "filetypes.h"
 #include "generic.h"
+#include "hmdfcache.h"
 #include "metoceanviewer.h"
 #include "netcdf.h"
 
@@ -52,10 +54,21 @@ UserTimeseries::UserTimeseries(
   this->m_markerId = 0;
   this->m_stationmodel = inStationModel;
   this->m_currentStation = inSelectedStation;
+  this->m_startDate = std::numeric_limits<qint64>::min();
+  this->m_endDate = std::numeric_limits<qint64>::max();
 }
 
 UserTimeseries::~UserTimeseries() {}
 
+void UserTimeseries::setTimeWindow(qint64 startDate, qint64 endDate) {
+  this->m_startDate = startDate;
+  this->m_endDate = endDate;
+}
+
+bool UserTimeseries::coversTimeWindow(qint64 startDate, qint64 endDate) const {
+  return startDate >= this->m_startDate && endDate <= this->m_endDate;
+}
+
 int UserTimeseries::getDataBounds(double &ymin, double &ymax,
                                   QDateTime &minDateOut, QDateTime &maxDateOut,
                                   QVector<double> &timeAddList) {
@@ -214,15 +227,19 @@ void UserTimeseries::addSingleStationToPlot(Hmdf *h, int &plottedSeriesCounter,
   double addY = m_checkedSeries[seriesCounter - 1][5]->text().toDouble();
 
   HmdfStation *st = h->station(this->m_markerId);
-  for (size_t j = 0; j < h->station(this->m_markerId)->numSnaps(); j++) {
-    if (std::abs(st->data(j) - st->nullValue()) > 0.0001 &&
-        st->date(j) >= startDate && st->date(j) <= endDate) {
-      maxDate = std::max(st->date(j) + addX - offset, maxDate);
-      minDate = std::min(st->date(j) + addX - offset, minDate);
-      maxVal = std::max(st->data(j) * unitConversion + addY, maxVal);
-      minVal = std::min(st->data(j) * unitConversion + addY, minVal);
-      s->append(st->date(j) + addX - offset,
-                st->data(j) * unitConversion + addY);
+  HmdfSpan<const qint64> date = st->dateSpan();
+  HmdfSpan<const double> data = st->dataSpan();
+  const double nullValue = st->nullValue();
+  size_t first, last;
+  st->window(startDate, endDate, first, last);
+  for (size_t j = first; j < last; j++) {
+    if (std::abs(data[j] - nullValue) > 0.0001 && date[j] >= startDate &&
+        date[j] <= endDate) {
+      maxDate = std::max(date[j] + addX - offset, maxDate);
+      minDate = std::min(date[j] + addX - offset, minDate);
+      maxVal = std::max(data[j] * unitConversion + addY, maxVal);
+      minVal = std::min(data[j] * unitConversion + addY, minVal);
+      s->append(date[j] + addX - offset, data[j] * unitConversion + addY);
     }
   }
 
@@ -263,15 +280,19 @@ void UserTimeseries::addMultipleStationsToPlot(
           m_checkedSeries[index][4]->text().toDouble() * 3.6e+6);
       double addY = m_checkedSeries[index][5]->text().toDouble();
 
-      for (size_t j = 0; j < st->numSnaps(); j++) {
-        if (std::abs(st->data(j) - st->nullValue()) > 0.0001 &&
-            st->date(j) >= startDate && st->date(j) <= endDate) {
-          maxDate = std::max(st->date(j) + addX - offset, maxDate);
-          minDate = std::min(st->date(j) + addX - offset, minDate);
-          maxVal = std::max(st->data(j) * unitConversion + addY, maxVal);
-          minVal = std::min(st->data(j) * unitConversion + addY, minVal);
-          s->append(st->date(j) + addX - offset,
-                    st->data(j) * unitConversion + addY);
+      HmdfSpan<const qint64> date = st->dateSpan();
+      HmdfSpan<const double> data = st->dataSpan();
+      const double nullValue = st->nullValue();
+      size_t first, last;
+      st->window(startDate, endDate, first, last);
+      for (size_t j = first; j < last; j++) {
+        if (std::abs(data[j] - nullValue) > 0.0001 && date[j] >= startDate &&
+            date[j] <= endDate) {
+          maxDate = std::max(date[j] + addX - offset, maxDate);
+          minDate = std::min(date[j] + addX - offset, minDate);
+          maxVal = std::max(data[j] * unitConversion + addY, maxVal);
+          minVal = std::min(data[j] * unitConversion + addY, minVal);
+          s->append(date[j] + addX - offset, data[j] * unitConversion + addY);
         }
       }
 
@@ -366,6 +387,7 @@ QString UserTimeseries::getErrorString() { return this->m_errorString; }
 int UserTimeseries::processImedsData(int tableIndex, Hmdf *data) {
   QString tempFile = this->m_table->item(tableIndex, 6)->text();
 
+  data->setCacheEnabled(true);
   int ierr = data->readImeds(tempFile);
 
   if (ierr != MetOceanViewer::Error::NOERR) {
@@ -383,6 +405,7 @@ int UserTimeseries::processAdcircNetcdfData(int tableIndex, Hmdf *data) {
   QDateTime coldStart = QDateTime::fromString(
       this->m_table->item(tableIndex, 7)->text(), "yyyy-MM-dd hh:mm:ss");
   AdcircStationOutput *adcircData = new AdcircStationOutput(this);
+  adcircData->setTimeWindow(this->m_startDate, this->m_endDate);
   int ierr = adcircData->read(tempFile, coldStart);
   if (ierr != MetOceanViewer::Error::NOERR) {
     this->m_errorString = tr("Error reading file: ") + tempFile;
@@ -405,7 +428,20 @@ int UserTimeseries::processAdcircAsciiData(int tableIndex, Hmdf *data) {
   QDateTime coldStart = QDateTime::fromString(
       this->m_table->item(tableIndex, 7)->text(), "yyyy-MM-dd hh:mm:ss");
   QString tempStationFile = this->m_table->item(tableIndex, 10)->text();
+
+  //...The cold start changes the dates and the window changes what is
+  //   read, so both are part of the cache key
+  QStringList sources = QStringList() << tempFile << tempStationFile;
+  QString cacheSalt = coldStart.toString(Qt::ISODate) + " " +
+                      QString::number(this->m_startDate) + " " +
+                      QString::number(this->m_endDate);
+  if (HmdfCache::load(sources, data, cacheSalt)) {
+    data->setSuccess(true);
+    return MetOceanViewer::Error::NOERR;
+  }
+
   AdcircStationOutput *adcircData = new AdcircStationOutput(this);
+  adcircData->setTimeWindow(this->m_startDate, this->m_endDate);
 
   int ierr = adcircData->read(tempFile, tempStationFile, coldStart);
 
@@ -421,6 +457,7 @@ int UserTimeseries::processAdcircAsciiData(int tableIndex, Hmdf *data) {
   }
 
   if (!data->success()) return MetOceanViewer::Error::ADCIRC_ASCIITOIMEDS;
+  HmdfCache::save(sources, data, cacheSalt);
   return MetOceanViewer::Error::NOERR;
 }
 
@@ -428,6 +465,7 @@ int UserTimeseries::processDflowData(int tableIndex, Hmdf *data) {
   QString tempFile = this->m_table->item(tableIndex, 6)->text();
 
   Dflow *dflow = new Dflow(tempFile, this);
+  dflow->setTimeWindow(this->m_startDate, this->m_endDate);
   QString dflowVar = this->m_table->item(tableIndex, 12)->text();
   int dflowLayer = this->m_table->item(tableIndex, 13)->text().toInt();
   int ierr = dflow->getVariable(dflowVar, dflowLayer, data);
@@ -445,7 +483,8 @@ int UserTimeseries::processDflowData(int tableIndex, Hmdf *data) {
 int UserTimeseries::processGenericNetcdfData(int tableIndex, Hmdf *data) {
   QString tempFile = this->m_table->item(tableIndex, 6)->text();
 
-  int ierr = data->readNetcdf(tempFile);
+  //...Station data is read when a station is plotted
+  int ierr = data->readNetcdf(tempFile, true);
   if (ierr != 0) {
     this->m_errorString = "Error processing generic netcdf file.";
     return MetOceanViewer::Error::GENERICNETCDFERROR;
@@ -453,6 +492,20 @@ int UserTimeseries::processGenericNetcdfData(int tableIndex, Hmdf *data) {
   return MetOceanViewer::Error::NOERR;
 }
 
+int UserTimeseries::processBinaryData(int tableIndex, Hmdf *data) {
+  QString tempFile = this->m_table->item(tableIndex, 6)->text();
+
+  int ierr = data->readBinary(tempFile);
+  if (ierr != 0) {
+    this->m_errorString = tr("Error reading file: ") + tempFile;
+    return MetOceanViewer::Error::GENERICFILEREADERROR;
+  }
+
+  data->setSuccess(true);
+
+  return MetOceanViewer::Error::NOERR;
+}
+
 QVector<QTableWidgetItem *> grabTableRow(QTableWidget *table, int row) {
   QVector<QTableWidgetItem *> rowItems;
   for (int col = 0; col < table->columnCount(); ++col)
@@ -495,6 +548,10 @@ int UserTimeseries::processDataFiles() {
         ierr = this->processGenericNetcdfData(i, stationData);
         this->m_allFileData.push_back(stationData);
         break;
+      case MetOceanViewer::FileType::BINARY_HMDF:
+        ierr = this->processBinaryData(i, stationData);
+        this->m_allFileData.push_back(stationData);
+        break;
       default:
         this->m_errorString = QStringLiteral("Invalid file format");
         return MetOceanViewer::Error::INVALIDFILEFORMAT;
@@ -60,6 +60,15 @@ class UserTimeseries : public QObject {
   QString getErrorString();
   void plot();
 
+  //...Restricts the ADCIRC and D-Flow reads to the output between the two
+  //   dates (milliseconds since the epoch). The whole file is read by
+  //   default
+  void setTimeWindow(qint64 startDate, qint64 endDate);
+
+  //...True when the data read covers the dates between the two given
+  //   dates, so a plot of that range does not need the files read again
+  bool coversTimeWindow(qint64 startDate, qint64 endDate) const;
+
  signals:
   void timeseriesError(QString);
 
@@ -84,6 +93,7 @@ class UserTimeseries : public QObject {
   int processAdcircNetcdfData(int tableIndex, Hmdf *data);
   int processDflowData(int tableIndex, Hmdf *data);
   int processGenericNetcdfData(int tableIndex, Hmdf *data);
+  int processBinaryData(int tableIndex, Hmdf *data);
   int processStationLocations();
   int addMarkersToMap();
   void addSingleStationToPlot(Hmdf *h, int &plottedSeriesCounter,
@@ -106,6 +116,8 @@ class UserTimeseries : public QObject {
   QVector<QColor> m_randomColorList;
   QVector<int> m_epsg;
   const double m_duplicateStationTolerance = 0.00001;
+  qint64 m_startDate;
+  qint64 m_endDate;
 
   //...Widgets
   QTableWidget *m_table;
@@ -174,9 +174,11 @@ int Usgs::plotUSGS() {
   series1->setPen(
       QPen(QColor(0, 0, 255), 3, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
 
-  for (int j = 0; j < station->numSnaps(); j++) {
-    if (QDateTime::fromMSecsSinceEpoch(station->date(j)).isValid()) {
-      series1->append(station->date(j), station->data(j));
+  HmdfSpan<const qint64> date = station->dateSpan();
+  HmdfSpan<const double> data = station->dataSpan();
+  for (size_t j = 0; j < date.size(); j++) {
+    if (QDateTime::fromMSecsSinceEpoch(date[j]).isValid()) {
+      series1->append(date[j], data[j]);
     }
   }
   this->m_chartView->addSeries(series1, this->m_productName);
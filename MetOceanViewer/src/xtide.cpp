@@ -155,9 +155,10 @@ int XTide::plotChart() {
   this->m_chartView->dateAxis()->setTitleText("Date (GMT)");
   this->m_chartView->yAxis()->setTitleText(this->m_ylabel);
 
-  for (int i = 0; i < this->m_data->station(0)->numSnaps(); i++) {
-    series1->append(this->m_data->station(0)->date(i),
-                    this->m_data->station(0)->data(i) * multiplier);
+  HmdfSpan<const qint64> date = this->m_data->station(0)->dateSpan();
+  HmdfSpan<const double> data = this->m_data->station(0)->dataSpan();
+  for (size_t i = 0; i < date.size(); i++) {
+    series1->append(date[i], data[i] * multiplier);
   }
 
   this->m_chartView->addSeries(series1, series1->name());
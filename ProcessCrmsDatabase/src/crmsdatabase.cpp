@@ -18,6 +18,7 @@
 //
 //-----------------------------------------------------------------------*/
 #include "crmsdatabase.h"
+#include <algorithm>
 #include <iostream>
 #include "boost/algorithm/string/split.hpp"
 #include "boost/algorithm/string/trim.hpp"
@@ -26,6 +27,9 @@
 #include "cdate.h"
 #include "netcdf.h"
 
+//...Samples per parameter in one chunk of the station variables
+static const size_t c_maxChunkLength = 262144;
+
 std::vector<std::string> splitString(const std::string &s) {
   std::vector<std::string> elems;
   boost::algorithm::split(elems, s, boost::is_any_of(","),
@@ -364,12 +368,19 @@ void CrmsDatabase::initializeOutputFile(std::vector<std::string> &stationNames,
     ierr += nc_def_var(this->m_ncid, station_data_var_string.c_str(), NC_FLOAT,
                        2, dims, &varid_d);
 
+    //...Compressed variables cannot be contiguous. Chunk along the whole
+    //   station (all parameters) so a station read touches one chunk
+    if (length[i] > 0) {
+      size_t chunkLength = std::min(length[i], c_maxChunkLength);
+      size_t chunk[2] = {this->m_categoryMap.size(), chunkLength};
+      ierr += nc_def_var_chunking(this->m_ncid, varid_t, NC_CHUNKED,
+                                  &chunkLength);
+      ierr += nc_def_var_chunking(this->m_ncid, varid_d, NC_CHUNKED, chunk);
+    }
+
     ierr += nc_def_var_deflate(this->m_ncid, varid_t, 1, 1, 2);
     ierr += nc_def_var_deflate(this->m_ncid, varid_d, 1, 1, 2);
 
-    ierr += nc_def_var_chunking(this->m_ncid, varid_t, NC_CONTIGUOUS, nullptr);
-    ierr += nc_def_var_chunking(this->m_ncid, varid_d, NC_CONTIGUOUS, nullptr);
-
     ierr += nc_put_att_text(this->m_ncid, varid_d, "station_name",
                             stationNames[i].length(), stationNames[i].c_str());
     ierr += nc_put_att_text(this->m_ncid, varid_t, "station_name",
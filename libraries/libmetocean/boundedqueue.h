@@ -0,0 +1,79 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+//...Fixed capacity FIFO shared between producer and consumer threads.
+//   push() blocks while the queue is full and pop() while it is empty.
+//   After close() nothing more is accepted and pop() fails once the items
+//   already queued are gone
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity)
+      : m_capacity(std::max(static_cast<size_t>(1), capacity)),
+        m_closed(false) {}
+
+  bool push(T &&item) {
+    QMutexLocker lock(&this->m_mutex);
+    while (this->m_queue.size() >= this->m_capacity && !this->m_closed)
+      this->m_notFull.wait(&this->m_mutex);
+    if (this->m_closed) return false;
+    this->m_queue.push_back(std::move(item));
+    this->m_notEmpty.wakeOne();
+    return true;
+  }
+
+  bool pop(T &item) {
+    QMutexLocker lock(&this->m_mutex);
+    while (this->m_queue.empty() && !this->m_closed)
+      this->m_notEmpty.wait(&this->m_mutex);
+    if (this->m_queue.empty()) return false;
+    item = std::move(this->m_queue.front());
+    this->m_queue.pop_front();
+    this->m_notFull.wakeOne();
+    return true;
+  }
+
+  void close() {
+    QMutexLocker lock(&this->m_mutex);
+    this->m_closed = true;
+    this->m_notFull.wakeAll();
+    this->m_notEmpty.wakeAll();
+  }
+
+ private:
+  const size_t m_capacity;
+  bool m_closed;
+  std::deque<T> m_queue;
+  QMutex m_mutex;
+  QWaitCondition m_notFull;
+  QWaitCondition m_notEmpty;
+};
+
+#endif  // BOUNDEDQUEUE_H
@@ -25,6 +25,7 @@
 #include <QStringList>
 #include "boost/algorithm/string.hpp"
 #include "netcdf.h"
+#include "timeconversion.h"
 
 CrmsData::CrmsData(Station &station, QDateTime startDate, QDateTime endDate,
                    const QVector<QString> &header,
@@ -70,6 +71,10 @@ int CrmsData::retrieveData(Hmdf *data, Datum::VDatum datum) {
   std::vector<long long> t(n, 0);
   ierr += nc_get_var_longlong(ncid, varid_time, t.data());
 
+  //...All parameters share the time axis, convert it once
+  std::vector<qint64> msecs(n);
+  TimeConversion::secondsToMsecs(t.data(), n, 0, msecs.data());
+
   for (size_t i = 0; i < np; ++i) {
     std::vector<float> v(n, 0.0);
     size_t start[2] = {i, 0};
@@ -84,7 +89,7 @@ int CrmsData::retrieveData(Hmdf *data, Datum::VDatum datum) {
 
     for (size_t j = 0; j < n; ++j) {
       if (v[j] > -9999.0f && t[j] >= minTime && t[j] <= maxTime) {
-        time.push_back(t[j] * 1000);
+        time.push_back(msecs[j]);
         tsdata.push_back(static_cast<double>(v[j]));
       }
     }
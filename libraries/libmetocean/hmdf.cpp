@@ -18,22 +18,35 @@
 //
 //-----------------------------------------------------------------------*/
 #include "hmdf.h"
-#include <QFile>
+#include <QAtomicInt>
 #include <QFileInfo>
-#include <QHostInfo>
-#include <fstream>
-#include "hmdfasciiparser.h"
-#include "netcdf.h"
+#include <QThread>
+#include <QtConcurrent>
+#include <limits>
+#include "boundedqueue.h"
+#include "hmdfbinaryfile.h"
+#include "hmdfcache.h"
+#include "hmdfstreamwriter.h"
+#include "imedsreader.h"
+#include "netcdfstreamwriter.h"
 #include "netcdftimeseries.h"
-#include "stringutil.h"
 
-#define NCCHECK(ierr)     \
-  if (ierr != NC_NOERR) { \
-    nc_close(ncid);       \
-    return ierr;          \
-  }
+//...Records below which a netCDF file is written on one thread
+static const size_t c_pipelineThreshold = 1048576;
 
-Hmdf::Hmdf(QObject *parent) : QObject(parent) { this->init(); }
+//...Station buffers queued per pipeline worker
+static const size_t c_queueDepth = 2;
+
+Hmdf::Hmdf(QObject *parent)
+    : QObject(parent),
+      m_cacheEnabled(false),
+      m_netcdfLayout(NetcdfStationVariables),
+      m_netcdfProfile(NetcdfWriteProfile::Default),
+      m_netcdfAppend(false),
+      m_store(std::make_shared<HmdfStore>()) {
+  this->init();
+  this->clearWriteWindow();
+}
 
 void Hmdf::init() {
   this->setHeader1("");
@@ -93,6 +106,10 @@ void Hmdf::addStation(HmdfStation *station) {
   this->m_station.push_back(station);
 }
 
+std::shared_ptr<HmdfStore> Hmdf::store() const { return this->m_store; }
+
+void Hmdf::reserve(size_t numValues) { this->m_store->reserveArena(numValues); }
+
 bool Hmdf::success() const { return this->m_success; }
 
 void Hmdf::setSuccess(bool success) { this->m_success = success; }
@@ -101,78 +118,78 @@ bool Hmdf::null() const { return this->m_null; }
 
 void Hmdf::setNull(bool null) { this->m_null = null; }
 
+void Hmdf::setWriteWindow(qint64 startDate, qint64 endDate) {
+  this->m_writeStart = startDate;
+  this->m_writeEnd = endDate;
+}
+
+void Hmdf::clearWriteWindow() {
+  this->m_writeStart = std::numeric_limits<qint64>::min();
+  this->m_writeEnd = std::numeric_limits<qint64>::max();
+}
+
+//...Only sorted stations can be trimmed to the write window with a binary
+//   search. Unsorted stations keep their whole range here and every writer
+//   filters their records date by date (see streamDirectory)
+void Hmdf::writeRange(HmdfStation *station, size_t &first,
+                      size_t &last) const {
+  station->window(this->m_writeStart, this->m_writeEnd, first, last);
+}
+
 int Hmdf::readImeds(QString filename) {
-  std::fstream fid(filename.toStdString().c_str());
-  if (fid.bad()) return -1;
-
-  //...Read Header
-  std::string templine;
-  std::getline(fid, templine);
-  this->m_header1 =
-      QString::fromStdString(StringUtil::sanitizeString(templine));
-  std::getline(fid, templine);
-  this->m_header2 =
-      QString::fromStdString(StringUtil::sanitizeString(templine));
-  std::getline(fid, templine);
-  this->m_header3 =
-      QString::fromStdString(StringUtil::sanitizeString(templine));
-
-  //...Read Body
-  std::getline(fid, templine);
-
-  while (!fid.eof()) {
-    HmdfStation *station = new HmdfStation(this);
-
-    templine = StringUtil::sanitizeString(templine);
-
-    QStringList templist =
-        QString::fromStdString(templine).split(" ", QString::SkipEmptyParts);
-
-    station->setName(templist.at(0));
-    station->setLongitude(templist.at(2).toDouble());
-    station->setLatitude(templist.at(1).toDouble());
-
-    while (!fid.eof()) {
-      std::getline(fid, templine);
-
-      int year, month, day, hour, minute, second;
-      double value;
-
-      bool status = HmdfAsciiParser::splitStringHmdfFormat(
-          templine, year, month, day, hour, minute, second, value);
-
-      if (status) {
-        QDateTime datetime;
-        datetime.setTimeSpec(Qt::UTC);
-        datetime.setDate(QDate(year, month, day));
-        datetime.setTime(QTime(hour, minute, second));
-        qint64 secs = datetime.toMSecsSinceEpoch();
-
-        //...Append to the station data
-        station->setNext(secs, value);
-      } else {
-        break;
-      }
-    }
+  if (this->m_cacheEnabled &&
+      HmdfCache::load(QStringList() << filename, this))
+    return 0;
 
-    //...Add the station
-    this->addStation(station);
-  }
+  ImedsReader reader(filename);
+  int ierr = reader.read(this);
+  if (ierr != 0) return ierr;
 
   this->setNull(false);
 
+  //...A cache that cannot be written (read only location) is not an error
+  if (this->m_cacheEnabled) HmdfCache::save(QStringList() << filename, this);
+
   return 0;
 }
 
-int Hmdf::readNetcdf(QString filename) {
+bool Hmdf::cacheEnabled() const { return this->m_cacheEnabled; }
+
+void Hmdf::setCacheEnabled(bool cacheEnabled) {
+  this->m_cacheEnabled = cacheEnabled;
+}
+
+Hmdf::NetcdfLayout Hmdf::netcdfLayout() const { return this->m_netcdfLayout; }
+
+void Hmdf::setNetcdfLayout(NetcdfLayout layout) {
+  this->m_netcdfLayout = layout;
+}
+
+NetcdfWriteProfile Hmdf::netcdfProfile() const {
+  return this->m_netcdfProfile;
+}
+
+void Hmdf::setNetcdfProfile(const NetcdfWriteProfile &profile) {
+  this->m_netcdfProfile = profile;
+}
+
+bool Hmdf::netcdfAppend() const { return this->m_netcdfAppend; }
+
+//...When set, writeNetcdf adds the records newer than those already in an
+//   existing file instead of replacing it (see NetcdfStreamWriter)
+void Hmdf::setNetcdfAppend(bool append) { this->m_netcdfAppend = append; }
+
+//...With deferred set only the station table is read here. Each station
+//   reads its own data from the file when it is first used
+int Hmdf::readNetcdf(QString filename, bool deferred) {
   NetcdfTimeseries *ncts = new NetcdfTimeseries(this);
   ncts->setFilename(filename);
-  int ierr = ncts->read();
+  int ierr = deferred ? ncts->readMetadata() : ncts->read();
   if (ierr != 0) {
     delete ncts;
     return 1;
   }
-  ierr = ncts->toHmdf(this);
+  ierr = deferred ? ncts->toHmdfDeferred(this) : ncts->toHmdf(this);
   delete ncts;
 
   if (ierr != 0) return 1;
@@ -182,71 +199,25 @@ int Hmdf::readNetcdf(QString filename) {
   return 0;
 }
 
+//...Stations point straight into the mapped file, so opening a file costs
+//   a directory read no matter how much data it holds
+int Hmdf::readBinary(QString filename) {
+  return HmdfBinaryFile::read(filename, this);
+}
+
+//...Reads only the stations at the given positions in the file
+int Hmdf::readBinary(QString filename, const std::vector<size_t> &stations) {
+  return HmdfBinaryFile::readStations(filename, this, stations);
+}
+
 int Hmdf::writeCsv(QString filename) {
-  int i, s;
-  QString value;
-  QFile output(filename);
-
-  if (!output.open(QIODevice::WriteOnly)) return -1;
-
-  for (s = 0; s < this->nstations(); s++) {
-    output.write(
-        QString("Station: " + this->station(s)->name() + "\n").toUtf8());
-    output.write(QString("Datum: " + this->datum() + "\n").toUtf8());
-    output.write(QString("Units: " + this->units() + "\n").toUtf8());
-    output.write(QString("\n").toUtf8());
-    for (i = 0; i < this->station(s)->numSnaps(); i++) {
-      QDateTime d =
-          QDateTime::fromMSecsSinceEpoch(this->station(s)->date(i), Qt::UTC);
-      if (d.isValid()) {
-        value.sprintf("%10.4e", this->station(s)->data(i));
-        output.write(
-            QString(d.toString("MM/dd/yyyy,hh:mm,") + value + "\n").toUtf8());
-      }
-    }
-    output.write(QString("\n\n\n").toUtf8());
-  }
-  output.close();
-  return 0;
+  CsvStreamWriter writer(filename, this->datum(), this->units());
+  return this->writeStream(&writer);
 }
 
 int Hmdf::writeImeds(QString filename) {
-  QString value;
-  QFile outputFile(filename);
-
-  if (!outputFile.open(QIODevice::WriteOnly)) return -1;
-
-  outputFile.write(QString("% IMEDS generic format\n").toUtf8());
-  outputFile.write(QString("% year month day hour min sec value\n").toUtf8());
-  outputFile.write(QString("MetOceanViewer    UTC    " + this->datum() + "   " +
-                           this->units() + "\n")
-                       .toUtf8());
-
-  for (int s = 0; s < this->nstations(); s++) {
-    QString stationName =
-        this->station(s)->name().replace(" ", "_").replace(",", "_").replace(
-            "__", "_");
-    outputFile.write(
-        QString(stationName + "   " +
-                QString::number(this->station(s)->latitude()) + "   " +
-                QString::number(this->station(s)->longitude()) + "\n")
-            .toUtf8());
-
-    for (int i = 0; i < this->station(s)->numSnaps(); i++) {
-      QDateTime d =
-          QDateTime::fromMSecsSinceEpoch(this->station(s)->date(i), Qt::UTC);
-
-      if (d.isValid()) {
-        value.sprintf("%10.4e", this->station(s)->data(i));
-        outputFile.write(
-            QString(d.toString("yyyy    MM    dd    hh    mm    ss") + "    " +
-                    value + "\n")
-                .toUtf8());
-      }
-    }
-  }
-  outputFile.close();
-  return 0;
+  ImedsStreamWriter writer(filename, this->datum(), this->units());
+  return this->writeStream(&writer);
 }
 
 void Hmdf::deallocNcArrays(long long *time, double *data, char *name,
@@ -259,176 +230,189 @@ void Hmdf::deallocNcArrays(long long *time, double *data, char *name,
 }
 
 int Hmdf::writeNetcdf(QString filename) {
+  NetcdfStreamWriter writer(filename, this->datum(), this->units());
+  writer.setLayout(this->m_netcdfLayout == NetcdfRaggedArray
+                       ? NetcdfStreamWriter::RaggedArray
+                       : NetcdfStreamWriter::StationVariables);
+  writer.setProfile(this->m_netcdfProfile);
+  writer.setAppend(this->m_netcdfAppend);
+  return this->writeNetcdfPipelined(&writer);
+}
 
-  //...Open file
-  int ncid;
-  NCCHECK(nc_create(filename.toStdString().c_str(), NC_NETCDF4, &ncid));
-
-  //...Dimensions
-  int dimid_nstations, dimid_stationNameLength;
-  NCCHECK(nc_def_dim(ncid, "numStations", this->nstations(), &dimid_nstations));
-  NCCHECK(nc_def_dim(ncid, "stationNameLen", 200, &dimid_stationNameLength));
-  std::vector<int> dimid_stationLength;
-  for (int i = 0; i < this->nstations(); i++) {
-    QString dimname;
-    int d;
-    dimname.sprintf("%s%4.4i", "stationLength_", i + 1);
-    NCCHECK(nc_def_dim(ncid, dimname.toStdString().c_str(),
-                       this->station(i)->numSnaps(), &d));
-    dimid_stationLength.push_back(d);
+int Hmdf::writeBinary(QString filename) {
+  return HmdfBinaryFile::write(filename, this, QByteArray(),
+                               this->m_writeStart, this->m_writeEnd);
+}
+
+//...Station table for a stream writer along with the range of each
+//   station that overlaps the write window. Stations that are not sorted
+//   can have records outside the window inside that range, so their
+//   records are counted one by one
+void Hmdf::streamDirectory(std::vector<HmdfStreamStation> &stations,
+                           std::vector<size_t> &first,
+                           std::vector<size_t> &last) {
+  const size_t n = this->nstations();
+  stations.assign(n, HmdfStreamStation());
+  first.resize(n);
+  last.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    HmdfStation *s = this->station(i);
+    this->writeRange(s, first[i], last[i]);
+    stations[i].name = s->name();
+    stations[i].id = s->id();
+    stations[i].latitude = s->latitude();
+    stations[i].longitude = s->longitude();
+    stations[i].nullValue = s->nullValue();
+    if (s->isSorted()) {
+      stations[i].length = last[i] - first[i];
+    } else {
+      HmdfSpan<const qint64> date = s->dateSpan();
+      for (size_t j = first[i]; j < last[i]; j++) {
+        if (date[j] >= this->m_writeStart && date[j] <= this->m_writeEnd)
+          stations[i].length++;
+      }
+    }
   }
+}
 
-  //...Variables
-  int stationNameDims[2] = {dimid_nstations, dimid_stationNameLength};
-  int nstationDims[1] = {dimid_nstations};
-  int wgs84[1] = {4326};
-
-  int varid_stationName, varid_stationId, varid_stationx, varid_stationy;
-  NCCHECK(nc_def_var(ncid, "stationName", NC_CHAR, 2, stationNameDims,
-                     &varid_stationName));
-  NCCHECK(nc_def_var(ncid, "stationId", NC_CHAR, 2, stationNameDims,
-                     &varid_stationId));
-  NCCHECK(nc_def_var(ncid, "stationXCoordinate", NC_DOUBLE, 1, nstationDims,
-                     &varid_stationx));
-  NCCHECK(nc_def_var(ncid, "stationYCoordinate", NC_DOUBLE, 1, nstationDims,
-                     &varid_stationy));
-
-  NCCHECK(nc_put_att_text(ncid, varid_stationx, "HorizontalProjectionName", 5,
-                          "WGS84"));
-  NCCHECK(nc_put_att_text(ncid, varid_stationy, "HorizontalProjectionName", 5,
-                          "WGS84"));
-
-  NCCHECK(nc_put_att_int(ncid, varid_stationx, "HorizontalProjectionEPSG",
-                         NC_INT, 1, wgs84));
-  NCCHECK(nc_put_att_int(ncid, varid_stationy, "HorizontalProjectionEPSG",
-                         NC_INT, 1, wgs84));
-
-  std::vector<int> varid_stationDate, varid_stationData;
-  for (size_t i = 0; i < this->nstations(); i++) {
-    QString stationName, timeVarName, dataVarName;
-    int d[1] = {dimid_stationLength[i]};
-    char epoch[20] = "1970-01-01 00:00:00";
-    char utc[4] = "utc";
-    char timeunit[27] = "second since referenceDate";
-    int v;
-
-    stationName.sprintf("%s%4.4i", "station_", i + 1);
-    timeVarName = "time_" + stationName;
-    dataVarName = "data_" + stationName;
-
-    NCCHECK(nc_def_var(ncid, timeVarName.toStdString().c_str(), NC_INT64, 1, d,
-                       &v));
-    NCCHECK(nc_put_att_text(ncid, v, "StationName",
-                            this->station(i)->name().length(),
-                            this->station(i)->name().toStdString().c_str()));
-    NCCHECK(nc_put_att_text(ncid, v, "StationID",
-                            this->station(i)->id().length(),
-                            this->station(i)->id().toStdString().c_str()));
-    NCCHECK(nc_put_att_text(ncid, v, "referenceDate", 20, epoch));
-    NCCHECK(nc_put_att_text(ncid, v, "timezone", 3, utc));
-    NCCHECK(nc_put_att_text(ncid, v, "units", 3, timeunit));
-    NCCHECK(nc_def_var_deflate(ncid, v, 1, 1, 2));
-
-    varid_stationDate.push_back(v);
-
-    NCCHECK(nc_def_var(ncid, dataVarName.toStdString().c_str(), NC_DOUBLE, 1, d,
-                       &v));
-    NCCHECK(nc_put_att_text(ncid, v, "StationName",
-                            this->station(i)->name().length(),
-                            this->station(i)->name().toStdString().c_str()));
-    NCCHECK(nc_put_att_text(ncid, v, "StationID",
-                            this->station(i)->id().length(),
-                            this->station(i)->id().toStdString().c_str()));
-    NCCHECK(nc_put_att_text(ncid, v, "units", this->units().length(),
-                            this->units().toStdString().c_str()));
-    NCCHECK(nc_put_att_text(ncid, v, "datum", this->datum().length(),
-                            this->datum().toStdString().c_str()));
-    NCCHECK(nc_def_var_deflate(ncid, v, 1, 1, 2));
-    varid_stationData.push_back(v);
+//...Copies the records of an unsorted station that fall in the write
+//   window
+void Hmdf::windowRecords(const HmdfStation *station, size_t first,
+                         size_t last, std::vector<qint64> &windowDate,
+                         std::vector<double> &windowData) const {
+  HmdfSpan<const qint64> date = station->dateSpan();
+  HmdfSpan<const double> data = station->dataSpan();
+  windowDate.clear();
+  windowData.clear();
+  for (size_t j = first; j < last; j++) {
+    if (date[j] < this->m_writeStart || date[j] > this->m_writeEnd) continue;
+    windowDate.push_back(date[j]);
+    windowData.push_back(data[j]);
   }
+}
 
-  //...Metadata
-  QString name = qgetenv("USER");
-  if (name.isEmpty()) name = qgetenv("USERNAME");
-  QString host = QHostInfo::localHostName();
-  QString createTime =
-      QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
-  QString source = "MetOceanViewer";
-  QString ncVersion = QString(nc_inq_libvers());
-  QString format = "20180123";
-
-  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "source", NC_CHAR, source.length(),
-                     source.toStdString().c_str()));
-  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "creation_date", NC_CHAR,
-                     createTime.length(), createTime.toStdString().c_str()));
-  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "created_by", NC_CHAR, name.length(),
-                     name.toStdString().c_str()));
-  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "host", NC_CHAR, host.length(),
-                     host.toStdString().c_str()));
-  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "netCDF_version", NC_CHAR,
-                     ncVersion.length(), ncVersion.toStdString().c_str()));
-  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "fileformat", NC_CHAR, format.length(),
-                     format.toStdString().c_str()));
-
-  NCCHECK(nc_enddef(ncid));
-
-  for (size_t i = 0; i < this->nstations(); i++) {
-    size_t index[2] = {i, 0};
-    size_t stindex[1] = {i};
-    size_t count[2] = {1, 200};
-    double lat[1] = {this->station(i)->latitude()};
-    double lon[1] = {this->station(i)->longitude()};
-
-    std::vector<long long> time(this->station(i)->numSnaps());
-    std::vector<double> data(this->station(i)->numSnaps());
-    auto name = this->station(i)->name().toStdString();
-    auto id = this->station(i)->id().toStdString();
-
-    for (size_t j = 0; j < this->station(i)->numSnaps(); j++) {
-      time[j] = this->station(i)->date(j) / 1000;
-      data[j] = this->station(i)->data(j);
-    }
+//...Hands every station to a stream writer. Sorted stations are passed
+//   as a single chunk straight from the store; unsorted stations are
+//   filtered against the write window first
+int Hmdf::writeStream(HmdfStreamWriter *writer) {
+  std::vector<HmdfStreamStation> stations;
+  std::vector<size_t> first, last;
+  this->streamDirectory(stations, first, last);
 
-    int status = nc_put_var1_double(ncid, varid_stationx, stindex, lon);
-    if (status != NC_NOERR) {
-      nc_close(ncid);
-      return status;
-    }
+  int ierr = writer->open(stations);
+  if (ierr != 0) return ierr;
 
-    status = nc_put_var1_double(ncid, varid_stationy, stindex, lat);
-    if (status != NC_NOERR) {
-      nc_close(ncid);
-      return status;
-    }
+  ierr = this->writeStations(writer, stations, first, last);
+  if (ierr != 0) return ierr;
 
-    status = nc_put_var_longlong(ncid, varid_stationDate[i], time.data());
-    if (status != NC_NOERR) {
-      nc_close(ncid);
-      return status;
-    }
+  return writer->close();
+}
 
-    status = nc_put_var_double(ncid, varid_stationData[i], data.data());
-    if (status != NC_NOERR) {
-      nc_close(ncid);
-      return status;
+int Hmdf::writeStations(HmdfStreamWriter *writer,
+                        const std::vector<HmdfStreamStation> &stations,
+                        const std::vector<size_t> &first,
+                        const std::vector<size_t> &last) {
+  std::vector<qint64> windowDate;
+  std::vector<double> windowData;
+  for (size_t i = 0; i < stations.size(); i++) {
+    HmdfStation *s = this->station(i);
+
+    int ierr = writer->beginStation(i);
+    if (ierr != 0) return ierr;
+
+    if (stations[i].length == last[i] - first[i]) {
+      ierr = writer->write(s->dateSpan().data() + first[i],
+                           s->dataSpan().data() + first[i],
+                           stations[i].length);
+    } else {
+      this->windowRecords(s, first[i], last[i], windowDate, windowData);
+      ierr = writer->write(windowDate.data(), windowData.data(),
+                           windowDate.size());
     }
+    if (ierr != 0) return ierr;
 
-    status = nc_put_vara_text(ncid, varid_stationName, index, count, &name[0]);
-    if (status != NC_NOERR) {
-      nc_close(ncid);
-      return status;
-    }
+    ierr = writer->endStation();
+    if (ierr != 0) return ierr;
+  }
+  return 0;
+}
 
-    status = nc_put_vara_text(ncid, varid_stationId, index, count, &id[0]);
-    if (status != NC_NOERR) {
-      nc_close(ncid);
-      return status;
-    }
+//...Writes a netCDF file as a pipeline. Worker threads build the write
+//   buffer of each station (window, time conversion, missing values) and
+//   hand it over through a bounded queue to this thread, which is the
+//   only one calling into the netCDF library since it is not thread safe.
+//   Small datasets are written on this thread alone
+int Hmdf::writeNetcdfPipelined(NetcdfStreamWriter *writer) {
+  std::vector<HmdfStreamStation> stations;
+  std::vector<size_t> first, last;
+  this->streamDirectory(stations, first, last);
+
+  int ierr = writer->open(stations);
+  if (ierr != 0) return ierr;
+
+  const size_t n = stations.size();
+  size_t total = 0;
+  for (size_t i = 0; i < n; i++) total += stations[i].length;
+
+  const int nWorkers = QThread::idealThreadCount() - 1;
+  if (nWorkers < 1 || n < 2 || total < c_pipelineThreshold) {
+    ierr = this->writeStations(writer, stations, first, last);
+    if (ierr != 0) return ierr;
+    return writer->close();
   }
 
-  nc_close(ncid);
+  //...Workers only use const access to stations, which is safe once the
+  //   directory pass has loaded and sorted them
+  std::vector<const HmdfStation *> source(n);
+  for (size_t i = 0; i < n; i++) source[i] = this->station(i);
+
+  BoundedQueue<NetcdfStreamWriter::StationBuffer> queue(
+      static_cast<size_t>(nWorkers) * c_queueDepth);
+  QAtomicInt next(0);
+  QAtomicInt status(0);
+
+  auto produce = [&]() {
+    std::vector<qint64> windowDate;
+    std::vector<double> windowData;
+    for (;;) {
+      const size_t i = static_cast<size_t>(next.fetchAndAddRelaxed(1));
+      if (i >= n) return;
+      const HmdfStation *s = source[i];
+      NetcdfStreamWriter::StationBuffer buffer;
+      int err;
+      if (stations[i].length == last[i] - first[i]) {
+        err = writer->prepare(i, s->dateSpan().data() + first[i],
+                              s->dataSpan().data() + first[i],
+                              stations[i].length, buffer);
+      } else {
+        this->windowRecords(s, first[i], last[i], windowDate, windowData);
+        err = writer->prepare(i, windowDate.data(), windowData.data(),
+                              windowDate.size(), buffer);
+      }
+      if (err != 0) {
+        status.testAndSetRelaxed(0, err);
+        queue.close();
+        return;
+      }
+      if (!queue.push(std::move(buffer))) return;
+    }
+  };
 
-  return 0;
+  QList<QFuture<void>> workers;
+  for (int k = 0; k < nWorkers; k++)
+    workers.push_back(QtConcurrent::run(produce));
+
+  NetcdfStreamWriter::StationBuffer buffer;
+  for (size_t k = 0; k < n && ierr == 0; k++) {
+    if (!queue.pop(buffer)) break;
+    ierr = writer->commit(buffer);
+  }
+  queue.close();
+  for (int k = 0; k < workers.size(); k++) workers[k].waitForFinished();
+
+  if (ierr == 0) ierr = status.load();
+  const int closeError = writer->close();
+  return ierr != 0 ? ierr : closeError;
 }
 
 int Hmdf::write(QString filename, HmdfFileType fileType) {
@@ -438,6 +422,8 @@ int Hmdf::write(QString filename, HmdfFileType fileType) {
     return this->writeCsv(filename);
   } else if (fileType == HmdfNetCdf) {
     return this->writeNetcdf(filename);
+  } else if (fileType == HmdfBinary) {
+    return this->writeBinary(filename);
   }
   return 1;
 }
@@ -450,14 +436,16 @@ int Hmdf::write(QString filename) {
     return this->write(filename, HmdfCsv);
   } else if (info.suffix().toLower() == "nc") {
     return this->write(filename, HmdfNetCdf);
+  } else if (info.suffix().toLower() == "movts") {
+    return this->write(filename, HmdfBinary);
   }
   return 1;
 }
 
 void Hmdf::dataBounds(qint64 &dateMin, qint64 &dateMax, double &minValue,
                       double &maxValue) {
-  dateMax = std::numeric_limits<qint64>::max();
-  dateMin = -std::numeric_limits<qint64>::max();
+  dateMin = std::numeric_limits<qint64>::max();
+  dateMax = -std::numeric_limits<qint64>::max();
   maxValue = -std::numeric_limits<double>::max();
   minValue = std::numeric_limits<double>::max();
 
@@ -26,13 +26,20 @@
 #include <QStringList>
 #include <QVector>
 #include <ctime>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "hmdfstation.h"
+#include "hmdfstore.h"
 #include "metocean_global.h"
+#include "netcdfwriteprofile.h"
 #include "timezone.h"
 
+class HmdfStreamWriter;
+class NetcdfStreamWriter;
+struct HmdfStreamStation;
+
 class Hmdf : public QObject {
   Q_OBJECT
 
@@ -41,16 +48,37 @@ class Hmdf : public QObject {
 
   void clear();
 
-  enum HmdfFileType { HmdfImeds, HmdfCsv, HmdfNetCdf };
+  enum HmdfFileType { HmdfImeds, HmdfCsv, HmdfNetCdf, HmdfBinary };
+  enum NetcdfLayout { NetcdfStationVariables, NetcdfRaggedArray };
 
   int write(QString filename, HmdfFileType fileType);
   int write(QString filename);
   int writeImeds(QString filename);
   int writeCsv(QString filename);
   int writeNetcdf(QString filename);
+  int writeBinary(QString filename);
+
+  //...Limits every writer to the records between the two dates
+  //   (milliseconds since the epoch, inclusive)
+  void setWriteWindow(qint64 startDate, qint64 endDate);
+  void clearWriteWindow();
 
   int readImeds(QString filename);
-  int readNetcdf(QString filename);
+  int readNetcdf(QString filename, bool deferred = false);
+  int readBinary(QString filename);
+  int readBinary(QString filename, const std::vector<size_t> &stations);
+
+  bool cacheEnabled() const;
+  void setCacheEnabled(bool cacheEnabled);
+
+  NetcdfLayout netcdfLayout() const;
+  void setNetcdfLayout(NetcdfLayout layout);
+
+  NetcdfWriteProfile netcdfProfile() const;
+  void setNetcdfProfile(const NetcdfWriteProfile &profile);
+
+  bool netcdfAppend() const;
+  void setNetcdfAppend(bool append);
 
   size_t nstations() const;
   // void setNstations(size_t nstations);
@@ -74,6 +102,9 @@ class Hmdf : public QObject {
   void setStation(int index, HmdfStation *station);
   void addStation(HmdfStation *station);
 
+  std::shared_ptr<HmdfStore> store() const;
+  void reserve(size_t numValues);
+
   bool success() const;
   void setSuccess(bool success);
 
@@ -88,10 +119,26 @@ class Hmdf : public QObject {
 
  private:
   void init();
+  void writeRange(HmdfStation *station, size_t &first, size_t &last) const;
+  int writeStream(HmdfStreamWriter *writer);
+  int writeNetcdfPipelined(NetcdfStreamWriter *writer);
+  void streamDirectory(std::vector<HmdfStreamStation> &stations,
+                       std::vector<size_t> &first, std::vector<size_t> &last);
+  void windowRecords(const HmdfStation *station, size_t first, size_t last,
+                     std::vector<qint64> &windowDate,
+                     std::vector<double> &windowData) const;
+  int writeStations(HmdfStreamWriter *writer,
+                    const std::vector<HmdfStreamStation> &stations,
+                    const std::vector<size_t> &first,
+                    const std::vector<size_t> &last);
   void deallocNcArrays(long long *time, double *data, char *name, char *id);
 
   //...Variables
   bool m_success, m_null;
+  bool m_cacheEnabled;
+  NetcdfLayout m_netcdfLayout;
+  NetcdfWriteProfile m_netcdfProfile;
+  bool m_netcdfAppend;
 
   Timezone m_tz;
   QString m_header1;
@@ -99,7 +146,10 @@ class Hmdf : public QObject {
   QString m_header3;
   QString m_units;
   QString m_datum;
+  qint64 m_writeStart;
+  qint64 m_writeEnd;
   QVector<HmdfStation *> m_station;
+  std::shared_ptr<HmdfStore> m_store;
 };
 
 #endif  // HMDF_H
@@ -18,115 +18,177 @@
 //
 //-----------------------------------------------------------------------*/
 #include "hmdfasciiparser.h"
-#include "boost/config/warning_disable.hpp"
-#include "boost/fusion/include/adapt_struct.hpp"
-#include "boost/fusion/include/io.hpp"
-#include "boost/spirit/include/phoenix_core.hpp"
-#include "boost/spirit/include/phoenix_object.hpp"
-#include "boost/spirit/include/phoenix_operator.hpp"
-#include "boost/spirit/include/qi.hpp"
-
-//--BOOST SPIRIT PARSER--//
-
-using boost::spirit::ascii::space;
-
-namespace parse {
-
-namespace qi = boost::spirit::qi;
-namespace ascii = boost::spirit::ascii;
-
-struct hmdfAsciiwSec {
-  int yr;
-  int mo;
-  int da;
-  int hr;
-  int min;
-  int sec;
-  double val;
-};
-
-struct hmdfAsciiwoSec {
-  int yr;
-  int mo;
-  int da;
-  int hr;
-  int min;
-  double val;
-};
-}  // namespace parse
-
-BOOST_FUSION_ADAPT_STRUCT(
-    parse::hmdfAsciiwSec,
-    (int, yr)(int, mo)(int, da)(int, hr)(int, min)(int, sec)(double, val))
-
-BOOST_FUSION_ADAPT_STRUCT(parse::hmdfAsciiwoSec,
-                          (int, yr)(int, mo)(int, da)(int, hr)(int, min)(double,
-                                                                         val))
-namespace parse {
-template <typename Iterator>
-struct hmdfAsciiwSec_parser
-    : qi::grammar<Iterator, hmdfAsciiwSec(), ascii::space_type> {
-  hmdfAsciiwSec_parser() : hmdfAsciiwSec_parser::base_type(start) {
-    using qi::double_;
-    using qi::int_;
-    start %= int_ >> int_ >> int_ >> int_ >> int_ >> int_ >> double_;
+#include <cstdint>
+#include <cstdlib>
+
+//...Exactly representable powers of ten. A mantissa below 2^53 scaled by
+//   one of these is correctly rounded (Clinger's fast path)
+static const double c_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const uint64_t c_maxExactMantissa = 9007199254740992ULL;
+
+//...Slow path for anything the fast path cannot round exactly (long
+//   mantissas, large exponents, nan, inf)
+static bool parseDoubleSlow(const char *begin, const char *end,
+                            double &value) {
+  size_t n = static_cast<size_t>(end - begin);
+  if (n == 0 || n > 63) return false;
+  char buffer[64];
+  for (size_t i = 0; i < n; ++i) {
+    buffer[i] = (begin[i] == 'd' || begin[i] == 'D') ? 'e' : begin[i];
+  }
+  buffer[n] = '\0';
+  char *stop;
+  value = std::strtod(buffer, &stop);
+  return stop == buffer + n;
+}
+
+bool HmdfAsciiParser::parseInt(const char *begin, const char *end,
+                               int &value) {
+  const char *p = begin;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+  if (p == end || end - p > 9) return false;
+  int v = 0;
+  for (; p < end; ++p) {
+    unsigned d = static_cast<unsigned>(*p - '0');
+    if (d > 9) return false;
+    v = v * 10 + static_cast<int>(d);
+  }
+  value = negative ? -v : v;
+  return true;
+}
+
+bool HmdfAsciiParser::parseDouble(const char *begin, const char *end,
+                                  double &value) {
+  const char *p = begin;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
   }
-  qi::rule<Iterator, hmdfAsciiwSec(), ascii::space_type> start;
-};
-
-template <typename Iterator>
-struct hmdfAsciiwoSec_parser
-    : qi::grammar<Iterator, hmdfAsciiwoSec(), ascii::space_type> {
-  hmdfAsciiwoSec_parser() : hmdfAsciiwoSec_parser::base_type(start) {
-    using qi::double_;
-    using qi::int_;
-    start %= int_ >> int_ >> int_ >> int_ >> int_ >> double_;
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any = false;
+
+  for (; p < end; ++p) {
+    unsigned d = static_cast<unsigned>(*p - '0');
+    if (d > 9) break;
+    any = true;
+    if (mantissa == 0 && d == 0) continue;
+    if (++digits > 19) return parseDoubleSlow(begin, end, value);
+    mantissa = mantissa * 10 + d;
+  }
+
+  if (p < end && *p == '.') {
+    for (++p; p < end; ++p) {
+      unsigned d = static_cast<unsigned>(*p - '0');
+      if (d > 9) break;
+      any = true;
+      --exponent;
+      if (mantissa == 0 && d == 0) continue;
+      if (++digits > 19) return parseDoubleSlow(begin, end, value);
+      mantissa = mantissa * 10 + d;
+    }
+  }
+
+  if (!any) return parseDoubleSlow(begin, end, value);
+
+  if (p < end && (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D')) {
+    ++p;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negativeExponent = *p == '-';
+      ++p;
+    }
+    if (p == end) return false;
+    int e = 0;
+    for (; p < end; ++p) {
+      unsigned d = static_cast<unsigned>(*p - '0');
+      if (d > 9) return false;
+      if (e < 100000) e = e * 10 + static_cast<int>(d);
+    }
+    exponent += negativeExponent ? -e : e;
   }
-  qi::rule<Iterator, hmdfAsciiwoSec(), ascii::space_type> start;
-};
-}  // namespace parse
-
-typedef std::string::const_iterator iterator_type;
-typedef parse::hmdfAsciiwSec_parser<iterator_type> hmdfwsec_parser;
-typedef parse::hmdfAsciiwoSec_parser<iterator_type> hmdfwosec_parser;
-
-//--END BOOST SPIRIT PARSER--//
-
-bool HmdfAsciiParser::splitStringHmdfFormat(std::string &data, int &yr, int &month,
-                                            int &day, int &hr, int &min,
-                                            int &sec, double &value) {
-  using namespace parse;
-  hmdfwsec_parser p1;
-  hmdfwosec_parser p2;
-  hmdfAsciiwSec r1;
-  hmdfAsciiwoSec r2;
-
-  std::string::const_iterator iter = data.begin();
-  std::string::const_iterator end = data.end();
-
-  bool r = phrase_parse(iter, end, p1, space, r1);
-  if (r) {
-    yr = r1.yr;
-    month = r1.mo;
-    day = r1.da;
-    hr = r1.hr;
-    min = r1.min;
-    sec = r1.sec;
-    value = r1.val;
+
+  if (p != end) return false;
+
+  if (mantissa == 0) {
+    value = negative ? -0.0 : 0.0;
     return true;
-  } else {
-    bool r = phrase_parse(iter, end, p2, space, r2);
-    if (r) {
-      yr = r2.yr;
-      month = r2.mo;
-      day = r2.da;
-      hr = r2.hr;
-      min = r2.min;
-      sec = 0;
-      value = r2.val;
-      return true;
-    } else {
+  }
+
+  if (mantissa > c_maxExactMantissa || exponent < -22 || exponent > 22)
+    return parseDoubleSlow(begin, end, value);
+
+  double v = static_cast<double>(mantissa);
+  v = exponent < 0 ? v / c_pow10[-exponent] : v * c_pow10[exponent];
+  value = negative ? -v : v;
+  return true;
+}
+
+bool HmdfAsciiParser::parseRecord(const char *begin, const char *end,
+                                  int &yr, int &month, int &day, int &hr,
+                                  int &min, int &sec, double &value) {
+  //...Records are "yyyy mm dd hh mm [ss] value". Anything past the seventh
+  //   token is ignored
+  const char *tokenBegin[7];
+  const char *tokenEnd[7];
+  int n = 0;
+  const char *p = begin;
+  while (n < 7 && HmdfAsciiParser::nextToken(p, end, tokenEnd[n])) {
+    tokenBegin[n] = p;
+    p = tokenEnd[n];
+    ++n;
+  }
+  if (n < 6) return false;
+
+  int *fields[5] = {&yr, &month, &day, &hr, &min};
+  for (int i = 0; i < 5; ++i) {
+    if (!HmdfAsciiParser::parseInt(tokenBegin[i], tokenEnd[i], *fields[i]))
       return false;
-    }
   }
+
+  if (n == 7 && HmdfAsciiParser::parseInt(tokenBegin[5], tokenEnd[5], sec) &&
+      HmdfAsciiParser::parseDouble(tokenBegin[6], tokenEnd[6], value)) {
+    return true;
+  }
+
+  sec = 0;
+  return HmdfAsciiParser::parseDouble(tokenBegin[5], tokenEnd[5], value);
+}
+
+bool HmdfAsciiParser::parseStationHeader(const char *begin, const char *end,
+                                         const char *&name,
+                                         const char *&nameEnd,
+                                         double &latitude, double &longitude) {
+  //...Station header lines are "name latitude longitude". Coordinates that
+  //   do not parse are read as zero
+  const char *latEnd, *lonEnd;
+  name = begin;
+  if (!HmdfAsciiParser::nextToken(name, end, nameEnd)) return false;
+  const char *lat = nameEnd;
+  if (!HmdfAsciiParser::nextToken(lat, end, latEnd)) return false;
+  const char *lon = latEnd;
+  if (!HmdfAsciiParser::nextToken(lon, end, lonEnd)) return false;
+
+  if (!HmdfAsciiParser::parseDouble(lat, latEnd, latitude)) latitude = 0.0;
+  if (!HmdfAsciiParser::parseDouble(lon, lonEnd, longitude)) longitude = 0.0;
+  return true;
+}
+
+bool HmdfAsciiParser::splitStringHmdfFormat(std::string &data, int &yr,
+                                            int &month, int &day, int &hr,
+                                            int &min, int &sec,
+                                            double &value) {
+  return HmdfAsciiParser::parseRecord(data.data(), data.data() + data.size(),
+                                      yr, month, day, hr, min, sec, value);
 }
@@ -20,13 +20,49 @@
 #ifndef HMDFASCIIPARSER_H
 #define HMDFASCIIPARSER_H
 
+#include <cstring>
 #include <string>
 
+//...Tokenizer for the ascii timeseries formats. Everything works on raw
+//   character ranges so a memory mapped file can be parsed in place
+//   without building a std::string per line
 class HmdfAsciiParser {
  public:
   static bool splitStringHmdfFormat(std::string &data, int &yr, int &month,
                                     int &day, int &hr, int &min, int &sec,
                                     double &value);
+
+  static bool parseRecord(const char *begin, const char *end, int &yr,
+                          int &month, int &day, int &hr, int &min, int &sec,
+                          double &value);
+
+  static bool parseStationHeader(const char *begin, const char *end,
+                                 const char *&name, const char *&nameEnd,
+                                 double &latitude, double &longitude);
+
+  static bool parseInt(const char *begin, const char *end, int &value);
+  static bool parseDouble(const char *begin, const char *end, double &value);
+
+  static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+  }
+
+  //...Returns the end of the line starting at p (the newline or end)
+  static const char *lineEnd(const char *p, const char *end) {
+    const void *nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return nl ? static_cast<const char *>(nl) : end;
+  }
+
+  //...Advances p to the start of the next whitespace delimited token on
+  //   the line and returns its end. Returns false if the line is exhausted
+  static bool nextToken(const char *&p, const char *end,
+                        const char *&tokenEnd) {
+    while (p < end && isBlank(*p)) ++p;
+    if (p == end) return false;
+    tokenEnd = p;
+    while (tokenEnd < end && !isBlank(*tokenEnd)) ++tokenEnd;
+    return true;
+  }
 };
 
 #endif  // HMDFASCIIPARSER_H
@@ -0,0 +1,216 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "hmdfasciiwriter.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "timeconversion.h"
+
+//...Longest single record either format can produce
+static const size_t c_maxRecordLength = 96;
+
+static char *writeDigits(char *out, int value, int width) {
+  for (int i = width - 1; i >= 0; --i) {
+    out[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return out + width;
+}
+
+static char *writeText(char *out, const char *text) {
+  size_t n = std::strlen(text);
+  std::memcpy(out, text, n);
+  return out + n;
+}
+
+//...True when |value| is exactly halfway between two 5 digit mantissas,
+//   i.e. value == n * 10^p with n ending in 5
+static bool isHalfway(double value, uint64_t n, int p) {
+  static const uint64_t c_maxExact = 9007199254740992ULL;
+  if (p >= 0) {
+    uint64_t scaled = n;
+    for (int i = 0; i < p; ++i) {
+      scaled *= 5;
+      if (scaled >= c_maxExact) return false;
+    }
+    return value == std::ldexp(static_cast<double>(scaled), p);
+  } else {
+    uint64_t m = n;
+    for (int i = 0; i < -p; ++i) {
+      if (m % 5 != 0) return false;
+      m /= 5;
+    }
+    return value == std::ldexp(static_cast<double>(m), p);
+  }
+}
+
+HmdfAsciiWriter::HmdfAsciiWriter(QFile *file, size_t bufferSize)
+    : m_file(file), m_buffer(std::max(bufferSize, 4 * c_maxRecordLength)),
+      m_used(0), m_failed(false) {}
+
+HmdfAsciiWriter::~HmdfAsciiWriter() { this->flush(); }
+
+//...A failed write is remembered. The buffers after it are dropped rather
+//   than written, so the file is never left with a hole in the middle, and
+//   every later flush reports the failure
+bool HmdfAsciiWriter::flush() {
+  if (this->m_used > 0 && !this->m_failed) {
+    qint64 n = this->m_file->write(this->m_buffer.data(),
+                                   static_cast<qint64>(this->m_used));
+    if (n != static_cast<qint64>(this->m_used)) this->m_failed = true;
+  }
+  this->m_used = 0;
+  return !this->m_failed;
+}
+
+bool HmdfAsciiWriter::failed() const { return this->m_failed; }
+
+char *HmdfAsciiWriter::reserve(size_t length) {
+  if (this->m_used + length > this->m_buffer.size()) {
+    this->flush();
+    if (length > this->m_buffer.size()) this->m_buffer.resize(length);
+  }
+  return this->m_buffer.data() + this->m_used;
+}
+
+void HmdfAsciiWriter::write(const char *text, size_t length) {
+  char *out = this->reserve(length);
+  std::memcpy(out, text, length);
+  this->m_used += length;
+}
+
+void HmdfAsciiWriter::write(const QString &text) {
+  QByteArray utf8 = text.toUtf8();
+  this->write(utf8.constData(), static_cast<size_t>(utf8.size()));
+}
+
+size_t HmdfAsciiWriter::formatValue(double value, char *out) {
+  char buffer[32];
+  char *p = buffer;
+
+  if (std::isnan(value)) {
+    p = writeText(p, "nan");
+  } else if (std::isinf(value)) {
+    p = writeText(p, value < 0 ? "-inf" : "inf");
+  } else {
+    //...printf gives the correctly rounded 5 digit mantissa, but rounds
+    //   exact halfway cases to even where Qt rounds them away from zero.
+    //   Those are detected exactly and bumped so the output is unchanged
+    char digits[32];
+    std::snprintf(digits, sizeof(digits), "%.4e", std::fabs(value));
+    int mantissa = (digits[0] - '0') * 10000 + (digits[2] - '0') * 1000 +
+                   (digits[3] - '0') * 100 + (digits[4] - '0') * 10 +
+                   (digits[5] - '0');
+    int exponent = std::atoi(digits + 7);
+    if (mantissa % 2 == 0 &&
+        isHalfway(std::fabs(value), static_cast<uint64_t>(mantissa) * 10 + 5,
+                  exponent - 5)) {
+      if (++mantissa == 100000) {
+        mantissa = 10000;
+        ++exponent;
+      }
+    }
+
+    if (std::signbit(value)) *p++ = '-';
+    *p++ = static_cast<char>('0' + mantissa / 10000);
+    *p++ = '.';
+    p = writeDigits(p, mantissa % 10000, 4);
+    *p++ = 'e';
+    *p++ = exponent < 0 ? '-' : '+';
+    int e = std::abs(exponent);
+    p = writeDigits(p, e, e >= 100 ? 3 : 2);
+  }
+
+  //...Right align to a width of 10
+  size_t n = static_cast<size_t>(p - buffer);
+  size_t pad = n < 10 ? 10 - n : 0;
+  std::memset(out, ' ', pad);
+  std::memcpy(out + pad, buffer, n);
+  return pad + n;
+}
+
+void HmdfAsciiWriter::writeImedsRecord(qint64 date, double value) {
+  int year, month, day, hour, minute, second;
+  TimeConversion::civilFromMsecs(date, year, month, day, hour, minute, second);
+
+  //...QDate has no year zero and formats years past 9999 differently, so
+  //   anything outside the four digit range takes the slow path
+  if (year < 1 || year > 9999) {
+    QDateTime d = QDateTime::fromMSecsSinceEpoch(date, Qt::UTC);
+    if (!d.isValid()) return;
+    QString v;
+    v.sprintf("%10.4e", value);
+    this->write(d.toString("yyyy    MM    dd    hh    mm    ss") + "    " + v +
+                "\n");
+    return;
+  }
+
+  char *out = this->reserve(c_maxRecordLength);
+  char *p = out;
+  p = writeDigits(p, year, 4);
+  p = writeText(p, "    ");
+  p = writeDigits(p, month, 2);
+  p = writeText(p, "    ");
+  p = writeDigits(p, day, 2);
+  p = writeText(p, "    ");
+  p = writeDigits(p, hour, 2);
+  p = writeText(p, "    ");
+  p = writeDigits(p, minute, 2);
+  p = writeText(p, "    ");
+  p = writeDigits(p, second, 2);
+  p = writeText(p, "    ");
+  p += HmdfAsciiWriter::formatValue(value, p);
+  *p++ = '\n';
+  this->m_used += static_cast<size_t>(p - out);
+}
+
+void HmdfAsciiWriter::writeCsvRecord(qint64 date, double value) {
+  int year, month, day, hour, minute, second;
+  TimeConversion::civilFromMsecs(date, year, month, day, hour, minute, second);
+
+  if (year < 1 || year > 9999) {
+    QDateTime d = QDateTime::fromMSecsSinceEpoch(date, Qt::UTC);
+    if (!d.isValid()) return;
+    QString v;
+    v.sprintf("%10.4e", value);
+    this->write(d.toString("MM/dd/yyyy,hh:mm,") + v + "\n");
+    return;
+  }
+
+  char *out = this->reserve(c_maxRecordLength);
+  char *p = out;
+  p = writeDigits(p, month, 2);
+  *p++ = '/';
+  p = writeDigits(p, day, 2);
+  *p++ = '/';
+  p = writeDigits(p, year, 4);
+  *p++ = ',';
+  p = writeDigits(p, hour, 2);
+  *p++ = ':';
+  p = writeDigits(p, minute, 2);
+  *p++ = ',';
+  p += HmdfAsciiWriter::formatValue(value, p);
+  *p++ = '\n';
+  this->m_used += static_cast<size_t>(p - out);
+}
@@ -0,0 +1,57 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef HMDFASCIIWRITER_H
+#define HMDFASCIIWRITER_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+//...Buffered text output for the ascii timeseries formats. Records are
+//   formatted with integer date arithmetic straight into a reusable buffer
+//   that is written to the file in large blocks. The output matches what
+//   QDateTime::toString and QString::sprintf("%10.4e") produce
+class HmdfAsciiWriter {
+ public:
+  explicit HmdfAsciiWriter(QFile *file, size_t bufferSize = 1 << 20);
+  ~HmdfAsciiWriter();
+
+  void write(const QString &text);
+  void write(const char *text, size_t length);
+
+  void writeImedsRecord(qint64 date, double value);
+  void writeCsvRecord(qint64 date, double value);
+
+  //...False if this or any earlier write to the file failed
+  bool flush();
+  bool failed() const;
+
+  static size_t formatValue(double value, char *out);
+
+ private:
+  char *reserve(size_t length);
+
+  QFile *m_file;
+  std::vector<char> m_buffer;
+  size_t m_used;
+  bool m_failed;
+};
+
+#endif  // HMDFASCIIWRITER_H
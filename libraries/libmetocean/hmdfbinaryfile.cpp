@@ -0,0 +1,346 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "hmdfbinaryfile.h"
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const char c_magic[8] = {'M', 'O', 'V', 'H', 'M', 'D', 'F', '\0'};
+const quint32 c_byteOrder = 0x01020304;
+const quint32 c_version = 1;
+const quint64 c_alignment = 64;
+const size_t c_keyLength = 32;
+const size_t c_numText = 5;
+
+struct StringRef {
+  quint64 offset;
+  quint64 length;
+};
+
+struct BinaryHeader {
+  char magic[8];
+  quint32 byteOrder;
+  quint32 version;
+  quint64 fileSize;
+  quint64 numStations;
+  quint64 directoryOffset;
+  quint64 stringOffset;
+  quint64 stringSize;
+  StringRef text[c_numText];
+  char key[c_keyLength];
+};
+
+struct BinaryStation {
+  StringRef name;
+  StringRef id;
+  double latitude;
+  double longitude;
+  double nullValue;
+  qint64 stationIndex;
+  quint64 flags;
+  quint64 length;
+  quint64 dateOffset;
+  quint64 dataOffset;
+};
+
+static_assert(sizeof(BinaryHeader) == 168, "unexpected header padding");
+static_assert(sizeof(BinaryStation) == 96, "unexpected directory padding");
+
+const quint64 c_flagNull = 1;
+const quint64 c_flagSorted = 2;
+
+quint64 align(quint64 offset) {
+  return (offset + c_alignment - 1) / c_alignment * c_alignment;
+}
+
+StringRef addString(QByteArray &table, const QString &s) {
+  QByteArray utf8 = s.toUtf8();
+  StringRef r;
+  r.offset = static_cast<quint64>(table.size());
+  r.length = static_cast<quint64>(utf8.size());
+  table.append(utf8);
+  return r;
+}
+
+bool writePadding(QSaveFile &file, quint64 &position, quint64 target) {
+  static const char zeros[c_alignment] = {};
+  if (target == position) return true;
+  qint64 n = static_cast<qint64>(target - position);
+  position = target;
+  return file.write(zeros, n) == n;
+}
+
+}  // namespace
+
+int HmdfBinaryFile::write(const QString &filename, Hmdf *hmdf,
+                          const QByteArray &key, qint64 startDate,
+                          qint64 endDate) {
+  const size_t n = hmdf->nstations();
+
+  BinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, c_magic, sizeof(c_magic));
+  header.byteOrder = c_byteOrder;
+  header.version = c_version;
+  header.numStations = n;
+  std::memcpy(header.key, key.constData(),
+              std::min(c_keyLength, static_cast<size_t>(key.size())));
+
+  QByteArray strings;
+  header.text[0] = addString(strings, hmdf->header1());
+  header.text[1] = addString(strings, hmdf->header2());
+  header.text[2] = addString(strings, hmdf->header3());
+  header.text[3] = addString(strings, hmdf->datum());
+  header.text[4] = addString(strings, hmdf->units());
+
+  //...Lay out the directory, string table and data blocks. Sorted
+  //   stations are cut to the window with a binary search, unsorted
+  //   stations have to be tested one date at a time
+  std::vector<BinaryStation> directory(n);
+  std::vector<size_t> first(n), last(n);
+  for (size_t i = 0; i < n; ++i) {
+    HmdfStation *s = hmdf->station(static_cast<int>(i));
+    BinaryStation &e = directory[i];
+    std::memset(&e, 0, sizeof(e));
+    e.name = addString(strings, s->name());
+    e.id = addString(strings, s->id());
+    e.latitude = s->latitude();
+    e.longitude = s->longitude();
+    e.nullValue = s->nullValue();
+    e.stationIndex = s->stationIndex();
+    e.flags = s->isNull() ? c_flagNull : 0;
+
+    s->window(startDate, endDate, first[i], last[i]);
+    if (s->isSorted()) {
+      e.flags |= c_flagSorted;
+      e.length = last[i] - first[i];
+    } else {
+      HmdfSpan<const qint64> date = s->dateSpan();
+      e.length = static_cast<quint64>(
+          std::count_if(date.begin(), date.end(), [&](qint64 d) {
+            return d >= startDate && d <= endDate;
+          }));
+    }
+  }
+
+  header.directoryOffset = align(sizeof(BinaryHeader));
+  header.stringOffset = header.directoryOffset + n * sizeof(BinaryStation);
+  header.stringSize = static_cast<quint64>(strings.size());
+
+  quint64 offset = align(header.stringOffset + header.stringSize);
+  for (size_t i = 0; i < n; ++i) {
+    directory[i].dateOffset = offset;
+    offset = align(offset + directory[i].length * sizeof(qint64));
+    directory[i].dataOffset = offset;
+    offset = align(offset + directory[i].length * sizeof(double));
+  }
+  header.fileSize = offset;
+
+  //...Written to a temporary file and renamed into place so that readers
+  //   never see a partial file
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) return CannotOpen;
+
+  quint64 position = 0;
+  const qint64 headerBytes = static_cast<qint64>(sizeof(header));
+  bool ok = file.write(reinterpret_cast<const char *>(&header),
+                       headerBytes) == headerBytes;
+  position += sizeof(header);
+  ok = ok && writePadding(file, position, header.directoryOffset);
+  if (n > 0) {
+    qint64 size = static_cast<qint64>(n * sizeof(BinaryStation));
+    ok = ok && file.write(reinterpret_cast<const char *>(directory.data()),
+                          size) == size;
+    position += static_cast<quint64>(size);
+  }
+  ok = ok && file.write(strings) == strings.size();
+  position += header.stringSize;
+
+  std::vector<qint64> windowDate;
+  std::vector<double> windowData;
+  for (size_t i = 0; i < n && ok; ++i) {
+    HmdfStation *s = hmdf->station(static_cast<int>(i));
+    const qint64 *date = s->dateSpan().data() + first[i];
+    const double *data = s->dataSpan().data() + first[i];
+    const size_t length = static_cast<size_t>(directory[i].length);
+
+    if (length != last[i] - first[i]) {
+      windowDate.clear();
+      windowData.clear();
+      for (size_t j = 0; j < last[i] - first[i]; ++j) {
+        if (date[j] < startDate || date[j] > endDate) continue;
+        windowDate.push_back(date[j]);
+        windowData.push_back(data[j]);
+      }
+      date = windowDate.data();
+      data = windowData.data();
+    }
+
+    qint64 dateBytes = static_cast<qint64>(length * sizeof(qint64));
+    qint64 dataBytes = static_cast<qint64>(length * sizeof(double));
+
+    ok = writePadding(file, position, directory[i].dateOffset);
+    ok = ok && file.write(reinterpret_cast<const char *>(date), dateBytes) ==
+                   dateBytes;
+    position += static_cast<quint64>(dateBytes);
+    ok = ok && writePadding(file, position, directory[i].dataOffset);
+    ok = ok && file.write(reinterpret_cast<const char *>(data), dataBytes) ==
+                   dataBytes;
+    position += static_cast<quint64>(dataBytes);
+  }
+  ok = ok && writePadding(file, position, header.fileSize);
+
+  if (!ok) {
+    file.cancelWriting();
+    return CannotOpen;
+  }
+  return file.commit() ? NoError : CannotOpen;
+}
+
+int HmdfBinaryFile::read(const QString &filename, Hmdf *hmdf,
+                         const QByteArray &key) {
+  return HmdfBinaryFile::readMapped(filename, hmdf, key, nullptr);
+}
+
+int HmdfBinaryFile::readStations(const QString &filename, Hmdf *hmdf,
+                                 const std::vector<size_t> &stations) {
+  return HmdfBinaryFile::readMapped(filename, hmdf, QByteArray(), &stations);
+}
+
+bool HmdfBinaryFile::isBinaryFile(const QString &filename) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+  char magic[sizeof(c_magic)];
+  if (file.read(magic, sizeof(magic)) != sizeof(magic)) return false;
+  return std::memcmp(magic, c_magic, sizeof(c_magic)) == 0;
+}
+
+//...Only the header and the directory entries that are used are read up
+//   front. The date and value blocks are never touched here; the pages of
+//   a station are brought in when that station is first accessed
+int HmdfBinaryFile::readMapped(const QString &filename, Hmdf *hmdf,
+                               const QByteArray &key,
+                               const std::vector<size_t> *stations) {
+  std::shared_ptr<QFile> file = std::make_shared<QFile>(filename);
+  if (!file->open(QIODevice::ReadOnly)) return CannotOpen;
+
+  const quint64 size = static_cast<quint64>(file->size());
+  if (size < sizeof(BinaryHeader)) return BadFormat;
+
+  const uchar *map = file->map(0, file->size());
+  if (!map) return CannotOpen;
+
+  //...Validate everything before any station is created
+  const BinaryHeader *header = reinterpret_cast<const BinaryHeader *>(map);
+  if (std::memcmp(header->magic, c_magic, sizeof(c_magic)) != 0 ||
+      header->byteOrder != c_byteOrder || header->version != c_version ||
+      header->fileSize != size)
+    return BadFormat;
+
+  if (!key.isEmpty()) {
+    char expected[c_keyLength] = {};
+    std::memcpy(expected, key.constData(),
+                std::min(c_keyLength, static_cast<size_t>(key.size())));
+    if (std::memcmp(expected, header->key, c_keyLength) != 0)
+      return KeyMismatch;
+  }
+
+  const quint64 n = header->numStations;
+  if (header->directoryOffset % 8 != 0 || header->directoryOffset > size ||
+      n > (size - header->directoryOffset) / sizeof(BinaryStation) ||
+      header->stringOffset > size ||
+      header->stringSize > size - header->stringOffset)
+    return BadFormat;
+
+  std::vector<size_t> selection;
+  if (stations) {
+    for (size_t index : *stations) {
+      if (index >= n) return NoStation;
+    }
+    selection = *stations;
+  } else {
+    selection.resize(static_cast<size_t>(n));
+    for (size_t i = 0; i < selection.size(); ++i) selection[i] = i;
+  }
+
+  auto validString = [&](const StringRef &r) {
+    return r.offset <= header->stringSize &&
+           r.length <= header->stringSize - r.offset;
+  };
+  auto validBlock = [&](quint64 offset, quint64 length) {
+    return offset % 8 == 0 && offset <= size &&
+           length <= (size - offset) / 8;
+  };
+
+  for (size_t i = 0; i < c_numText; ++i) {
+    if (!validString(header->text[i])) return BadFormat;
+  }
+
+  const BinaryStation *directory = reinterpret_cast<const BinaryStation *>(
+      map + header->directoryOffset);
+  for (size_t index : selection) {
+    const BinaryStation &e = directory[index];
+    if (!validString(e.name) || !validString(e.id) ||
+        !validBlock(e.dateOffset, e.length) ||
+        !validBlock(e.dataOffset, e.length))
+      return BadFormat;
+  }
+
+  const char *strings =
+      reinterpret_cast<const char *>(map + header->stringOffset);
+  auto text = [&](const StringRef &r) {
+    return QString::fromUtf8(strings + r.offset, static_cast<int>(r.length));
+  };
+
+  hmdf->setHeader1(text(header->text[0]));
+  hmdf->setHeader2(text(header->text[1]));
+  hmdf->setHeader3(text(header->text[2]));
+  hmdf->setDatum(text(header->text[3]));
+  hmdf->setUnits(text(header->text[4]));
+
+  //...The store keeps the mapping alive for as long as any station
+  //   (possibly moved to another Hmdf) still refers to it
+  hmdf->store()->retain(file);
+
+  for (size_t index : selection) {
+    const BinaryStation &e = directory[index];
+    HmdfStation *station = new HmdfStation(hmdf);
+    station->setName(text(e.name));
+    station->setId(text(e.id));
+    station->setLatitude(e.latitude);
+    station->setLongitude(e.longitude);
+    station->setNullValue(e.nullValue);
+    station->setStationIndex(static_cast<int>(e.stationIndex));
+    station->setIsNull((e.flags & c_flagNull) != 0);
+    station->attach(reinterpret_cast<const qint64 *>(map + e.dateOffset),
+                    reinterpret_cast<const double *>(map + e.dataOffset),
+                    static_cast<size_t>(e.length),
+                    (e.flags & c_flagSorted) != 0);
+    hmdf->addStation(station);
+  }
+
+  hmdf->setNull(false);
+  return NoError;
+}
@@ -0,0 +1,69 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef HMDFBINARYFILE_H
+#define HMDFBINARYFILE_H
+
+#include <QByteArray>
+#include <QString>
+#include <limits>
+#include <vector>
+#include "hmdf.h"
+
+//...Native binary timeseries layout (*.movts). A fixed header is followed
+//   by a station directory (names, coordinates, block offsets), a string
+//   table and one 64 byte aligned date block and value block per station.
+//   Files are memory mapped on read and the stations point straight into
+//   the mapping, so nothing is parsed or copied until a station is
+//   modified.
+//
+//   The header carries an optional opaque key (up to 32 bytes) that
+//   readers can require to match, which is how sidecar caches are tied to
+//   the file they were built from.
+//
+//   readStations() creates only the requested stations (by position in
+//   the file) and never looks at the directory entries of the others
+class HmdfBinaryFile {
+ public:
+  enum Status {
+    NoError = 0,
+    CannotOpen = -1,
+    BadFormat = 1,
+    KeyMismatch = 2,
+    NoStation = 3
+  };
+
+  static int write(const QString &filename, Hmdf *hmdf,
+                   const QByteArray &key = QByteArray(),
+                   qint64 startDate = std::numeric_limits<qint64>::min(),
+                   qint64 endDate = std::numeric_limits<qint64>::max());
+  static int read(const QString &filename, Hmdf *hmdf,
+                  const QByteArray &key = QByteArray());
+  static int readStations(const QString &filename, Hmdf *hmdf,
+                          const std::vector<size_t> &stations);
+
+  static bool isBinaryFile(const QString &filename);
+
+ private:
+  static int readMapped(const QString &filename, Hmdf *hmdf,
+                        const QByteArray &key,
+                        const std::vector<size_t> *stations);
+};
+
+#endif  // HMDFBINARYFILE_H
@@ -0,0 +1,88 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "hmdfcache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include "hmdfbinaryfile.h"
+
+//...Files up to this size are hashed in full. Larger files are sampled
+//   with c_hashSamples blocks spread evenly from the first to the last byte
+static const qint64 c_fullHashSize = 1024 * 1024;
+static const qint64 c_hashBlockSize = 64 * 1024;
+static const int c_hashSamples = 16;
+
+QString HmdfCache::cacheFilename(const QString &source) {
+  return source + ".movcache";
+}
+
+QByteArray HmdfCache::sourceKey(const QStringList &sources,
+                                const QString &salt) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  for (const QString &source : sources) {
+    QFileInfo info(source);
+    if (!info.exists()) return QByteArray();
+
+    qint64 size = info.size();
+    qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    hash.addData(reinterpret_cast<const char *>(&size), sizeof(size));
+    hash.addData(reinterpret_cast<const char *>(&mtime), sizeof(mtime));
+
+    QFile file(source);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    if (size <= c_fullHashSize) {
+      hash.addData(file.readAll());
+    } else {
+      for (int i = 0; i < c_hashSamples; ++i) {
+        qint64 position =
+            (size - c_hashBlockSize) * i / (c_hashSamples - 1);
+        if (!file.seek(position)) return QByteArray();
+        hash.addData(file.read(c_hashBlockSize));
+      }
+    }
+  }
+  hash.addData(salt.toUtf8());
+  return hash.result();
+}
+
+bool HmdfCache::load(const QStringList &sources, Hmdf *hmdf,
+                     const QString &salt) {
+  if (sources.isEmpty()) return false;
+  QString cache = HmdfCache::cacheFilename(sources.first());
+  if (!QFileInfo::exists(cache)) return false;
+
+  QByteArray key = HmdfCache::sourceKey(sources, salt);
+  if (key.isEmpty()) return false;
+
+  int ierr = HmdfBinaryFile::read(cache, hmdf, key);
+  if (ierr == HmdfBinaryFile::KeyMismatch || ierr == HmdfBinaryFile::BadFormat)
+    QFile::remove(cache);
+  return ierr == HmdfBinaryFile::NoError;
+}
+
+bool HmdfCache::save(const QStringList &sources, Hmdf *hmdf,
+                     const QString &salt) {
+  if (sources.isEmpty()) return false;
+  QByteArray key = HmdfCache::sourceKey(sources, salt);
+  if (key.isEmpty()) return false;
+  return HmdfBinaryFile::write(HmdfCache::cacheFilename(sources.first()), hmdf,
+                               key) == HmdfBinaryFile::NoError;
+}
@@ -0,0 +1,46 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef HMDFCACHE_H
+#define HMDFCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include "hmdf.h"
+
+//...Binary sidecar cache (<file>.movcache) for ascii station files. The
+//   cache is an HmdfBinaryFile keyed by the size, modification time and a
+//   sampled content hash of every source file plus any settings that
+//   changed how the data was read (the salt). A cache whose key no longer
+//   matches is deleted when it is found.
+class HmdfCache {
+ public:
+  static QString cacheFilename(const QString &source);
+
+  static QByteArray sourceKey(const QStringList &sources,
+                              const QString &salt = QString());
+
+  static bool load(const QStringList &sources, Hmdf *hmdf,
+                   const QString &salt = QString());
+  static bool save(const QStringList &sources, Hmdf *hmdf,
+                   const QString &salt = QString());
+};
+
+#endif  // HMDFCACHE_H
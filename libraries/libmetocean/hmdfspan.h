@@ -0,0 +1,56 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef HMDFSPAN_H
+#define HMDFSPAN_H
+
+#include <cstddef>
+
+//...Non-owning pointer range over contiguous station memory. A span is
+//   invalidated by anything that can grow or repack the underlying store
+//   (setNext, setData, setDate, resize, or adding a station to the same
+//   Hmdf)
+template <typename T>
+class HmdfSpan {
+ public:
+  HmdfSpan() : m_data(nullptr), m_size(0) {}
+  HmdfSpan(T *data, size_t size) : m_data(data), m_size(size) {}
+
+  T *data() const { return this->m_data; }
+  size_t size() const { return this->m_size; }
+  bool empty() const { return this->m_size == 0; }
+
+  T *begin() const { return this->m_data; }
+  T *end() const { return this->m_data + this->m_size; }
+
+  T &operator[](size_t index) const { return this->m_data[index]; }
+
+  T &front() const { return this->m_data[0]; }
+  T &back() const { return this->m_data[this->m_size - 1]; }
+
+  HmdfSpan<T> subspan(size_t offset, size_t count) const {
+    return HmdfSpan<T>(this->m_data + offset, count);
+  }
+
+ private:
+  T *m_data;
+  size_t m_size;
+};
+
+#endif  // HMDFSPAN_H
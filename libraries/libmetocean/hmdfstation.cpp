@@ -18,14 +18,33 @@
 //
 //-----------------------------------------------------------------------*/
 #include "hmdfstation.h"
+#include <algorithm>
+#include <limits>
+#include "hmdf.h"
+
+//...Stations created as children of an Hmdf view into that object's
+//   columnar store. Anything else gets a private store
+static std::shared_ptr<HmdfStore> parentStore(QObject *parent) {
+  Hmdf *h = qobject_cast<Hmdf *>(parent);
+  if (h) return h->store();
+  return std::make_shared<HmdfStore>();
+}
+
+HmdfStation::HmdfStation(QObject *parent)
+    : HmdfStation(parentStore(parent), parent) {}
 
-HmdfStation::HmdfStation(QObject *parent) : QObject(parent) {
+HmdfStation::HmdfStation(std::shared_ptr<HmdfStore> store, QObject *parent)
+    : QObject(parent), m_store(store) {
+  this->m_slot = this->m_store->addSeries();
   this->m_coordinate = QGeoCoordinate();
   this->m_name = "noname";
   this->m_id = "noid";
   this->m_isNull = true;
   this->m_stationIndex = 0;
   this->m_nullValue = HmdfStation::nullDataValue();
+  this->m_boundsValid = false;
+  this->m_sortState = Sorted;
+  this->m_writing = false;
 }
 
 void HmdfStation::clear() {
@@ -34,8 +53,11 @@ void HmdfStation::clear() {
   this->m_id = "noid";
   this->m_isNull = true;
   this->m_stationIndex = 0;
-  this->m_data.clear();
-  this->m_date.clear();
+  this->m_loader.reset();
+  this->m_store->clear(this->m_slot);
+  this->m_sortState = Sorted;
+  this->m_writing = false;
+  this->invalidateBounds();
   return;
 }
 
@@ -47,7 +69,59 @@ QString HmdfStation::id() const { return this->m_id; }
 
 void HmdfStation::setId(const QString &id) { this->m_id = id; }
 
-size_t HmdfStation::numSnaps() const { return this->m_data.size(); }
+size_t HmdfStation::numSnaps() const {
+  this->loadDeferred();
+  return this->m_store->length(this->m_slot);
+}
+
+void HmdfStation::reserve(size_t numSnaps) {
+  this->loadDeferred();
+  this->m_store->reserve(this->m_slot, numSnaps);
+}
+
+void HmdfStation::resize(size_t numSnaps) {
+  this->loadDeferred();
+  this->m_store->resize(this->m_slot, numSnaps);
+  this->m_sortState = SortUnknown;
+  this->invalidateBounds();
+}
+
+std::shared_ptr<HmdfStore> HmdfStation::store() const { return this->m_store; }
+
+void HmdfStation::setLoader(std::shared_ptr<HmdfStationLoader> loader) {
+  this->m_loader = loader;
+}
+
+bool HmdfStation::isLoaded() const { return !this->m_loader; }
+
+//...The loader is released before it runs so that the setters it calls
+//   do not try to load again. A station that fails to load is left empty
+//   and marked null
+int HmdfStation::load() {
+  if (!this->m_loader) return 0;
+  std::shared_ptr<HmdfStationLoader> loader = this->m_loader;
+  this->m_loader.reset();
+  int ierr = loader->load(this);
+  if (ierr != 0) {
+    this->m_store->clear(this->m_slot);
+    this->m_sortState = Sorted;
+    this->invalidateBounds();
+    this->m_isNull = true;
+  }
+  return ierr;
+}
+
+void HmdfStation::loadDeferred() const {
+  if (this->m_loader) const_cast<HmdfStation *>(this)->load();
+}
+
+void HmdfStation::attach(const qint64 *date, const double *data,
+                         size_t numSnaps, bool sorted) {
+  this->m_loader.reset();
+  this->m_store->attach(this->m_slot, date, data, numSnaps);
+  this->m_sortState = sorted ? Sorted : SortUnknown;
+  this->invalidateBounds();
+}
 
 int HmdfStation::stationIndex() const { return this->m_stationIndex; }
 
@@ -58,7 +132,7 @@ void HmdfStation::setStationIndex(int stationIndex) {
 qint64 HmdfStation::date(int index) const {
   Q_ASSERT(index >= 0 && index < this->numSnaps());
   if (index >= 0 || index < this->numSnaps())
-    return this->m_date[index];
+    return this->dateSpan()[index];
   else
     return 0;
 }
@@ -66,19 +140,26 @@ qint64 HmdfStation::date(int index) const {
 double HmdfStation::data(int index) const {
   Q_ASSERT(index >= 0 && index < this->numSnaps());
   if (index >= 0 || index < this->numSnaps())
-    return this->m_data[index];
+    return this->dataSpan()[index];
   else
     return 0;
 }
 
 void HmdfStation::setData(const double &data, int index) {
+  this->loadDeferred();
   Q_ASSERT(index >= 0 && index < this->numSnaps());
-  if (index >= 0 || index < this->numSnaps()) this->m_data[index] = data;
+  if (index >= 0 || index < this->numSnaps())
+    this->m_store->data(this->m_slot)[index] = data;
+  this->invalidateBounds();
 }
 
 void HmdfStation::setDate(const qint64 &date, int index) {
+  this->loadDeferred();
   Q_ASSERT(index >= 0 && index < this->numSnaps());
-  if (index >= 0 || index < this->numSnaps()) this->m_date[index] = date;
+  if (index >= 0 || index < this->numSnaps())
+    this->m_store->date(this->m_slot)[index] = date;
+  this->m_sortState = SortUnknown;
+  this->invalidateBounds();
 }
 
 bool HmdfStation::isNull() const { return this->m_isNull; }
@@ -86,31 +167,96 @@ bool HmdfStation::isNull() const { return this->m_isNull; }
 void HmdfStation::setIsNull(bool isNull) { this->m_isNull = isNull; }
 
 void HmdfStation::setDate(const QVector<qint64> &date) {
-  this->m_date = date;
+  this->loadDeferred();
+  this->m_store->resize(this->m_slot, date.size());
+  std::copy(date.begin(), date.end(), this->m_store->date(this->m_slot));
+  this->m_sortState = SortUnknown;
+  this->invalidateBounds();
   return;
 }
 
 void HmdfStation::setData(const QVector<double> &data) {
-  this->m_data = data;
+  this->loadDeferred();
+  this->m_store->resize(this->m_slot, data.size());
+  std::copy(data.begin(), data.end(), this->m_store->data(this->m_slot));
+  this->invalidateBounds();
   return;
 }
 
 void HmdfStation::setData(const QVector<float> &data) {
-  this->m_data.resize(data.size());
+  this->loadDeferred();
+  this->m_store->resize(this->m_slot, data.size());
+  double *d = this->m_store->data(this->m_slot);
   for (size_t i = 0; i < data.size(); ++i) {
-    this->m_data[i] = static_cast<double>(data[i]);
+    d[i] = static_cast<double>(data[i]);
   }
+  this->invalidateBounds();
   return;
 }
 
 void HmdfStation::setNext(const qint64 &date, const double &data) {
-  this->m_date.push_back(date);
-  this->m_data.push_back(data);
+  this->loadDeferred();
+  const size_t n = this->numSnaps();
+  if (this->m_sortState == Sorted && n > 0 && date < this->dateSpan()[n - 1])
+    this->m_sortState = Unsorted;
+  this->m_store->append(this->m_slot, date, data);
+  this->invalidateBounds();
+}
+
+QVector<qint64> HmdfStation::allDate() const {
+  HmdfSpan<const qint64> d = this->dateSpan();
+  QVector<qint64> v(static_cast<int>(d.size()));
+  std::copy(d.begin(), d.end(), v.begin());
+  return v;
 }
 
-QVector<qint64> HmdfStation::allDate() const { return this->m_date; }
+QVector<double> HmdfStation::allData() const {
+  HmdfSpan<const double> d = this->dataSpan();
+  QVector<double> v(static_cast<int>(d.size()));
+  std::copy(d.begin(), d.end(), v.begin());
+  return v;
+}
 
-QVector<double> HmdfStation::allData() const { return this->m_data; }
+HmdfSpan<const qint64> HmdfStation::dateSpan() const {
+  this->loadDeferred();
+  const HmdfStore *store = this->m_store.get();
+  return HmdfSpan<const qint64>(store->date(this->m_slot),
+                                store->length(this->m_slot));
+}
+
+HmdfSpan<const double> HmdfStation::dataSpan() const {
+  this->loadDeferred();
+  const HmdfStore *store = this->m_store.get();
+  return HmdfSpan<const double>(store->data(this->m_slot),
+                                store->length(this->m_slot));
+}
+
+//...Handing out a writable span puts the station in the writing state.
+//   Until commitWrites() the bounds and the sort state are computed on
+//   every query and never cached, so a query made between writes cannot
+//   leave stale values behind
+HmdfSpan<qint64> HmdfStation::mutableDateSpan() {
+  this->loadDeferred();
+  this->m_writing = true;
+  this->m_sortState = SortUnknown;
+  this->invalidateBounds();
+  return HmdfSpan<qint64>(this->m_store->date(this->m_slot),
+                          this->m_store->length(this->m_slot));
+}
+
+HmdfSpan<double> HmdfStation::mutableDataSpan() {
+  this->loadDeferred();
+  this->m_writing = true;
+  this->invalidateBounds();
+  return HmdfSpan<double>(this->m_store->data(this->m_slot),
+                          this->m_store->length(this->m_slot));
+}
+
+void HmdfStation::commitWrites() {
+  this->m_writing = false;
+  this->m_sortState = SortUnknown;
+  this->invalidateBounds();
+}
 
 void HmdfStation::setLatitude(const double latitude) {
   this->m_coordinate.setLatitude(latitude);
@@ -130,22 +276,105 @@ void HmdfStation::setCoordinate(const QGeoCoordinate coordinate) {
 
 QGeoCoordinate *HmdfStation::coordinate() { return &this->m_coordinate; }
 
+//...Single pass min/max over the values, ignoring null entries. Four
+//   independent accumulators keep the loop free of a serial dependency
+//   and the null test is a select rather than a branch
+static bool valueBounds(const double *data, size_t n, double null1,
+                        double null2, double &minValue, double &maxValue) {
+  const double big = std::numeric_limits<double>::max();
+  double lo[4] = {big, big, big, big};
+  double hi[4] = {-big, -big, -big, -big};
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (size_t k = 0; k < 4; ++k) {
+      const double v = data[i + k];
+      const bool valid = (v != null1) & (v != null2);
+      lo[k] = std::min(lo[k], valid ? v : big);
+      hi[k] = std::max(hi[k], valid ? v : -big);
+    }
+  }
+  for (; i < n; ++i) {
+    const double v = data[i];
+    const bool valid = (v != null1) & (v != null2);
+    lo[0] = std::min(lo[0], valid ? v : big);
+    hi[0] = std::max(hi[0], valid ? v : -big);
+  }
+
+  minValue = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+  maxValue = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+  return minValue <= maxValue;
+}
+
+static void dateBounds(const qint64 *date, size_t n, qint64 &minDate,
+                       qint64 &maxDate) {
+  qint64 lo = std::numeric_limits<qint64>::max();
+  qint64 hi = std::numeric_limits<qint64>::min();
+  for (size_t i = 0; i < n; ++i) {
+    lo = std::min(lo, date[i]);
+    hi = std::max(hi, date[i]);
+  }
+  minDate = lo;
+  maxDate = hi;
+}
+
 void HmdfStation::dataBounds(qint64 &minDate, qint64 &maxDate, double &minValue,
-                             double &maxValue) {
-  minDate = *std::min_element(this->m_date.begin(), this->m_date.end());
-  maxDate = *std::max_element(this->m_date.begin(), this->m_date.end());
-
-  std::vector<double> sortedData = this->m_data.toStdVector();
-  std::sort(sortedData.begin(), sortedData.end());
-
-  if (sortedData.front() != sortedData.back()) {
-    minValue = *std::upper_bound(sortedData.begin(), sortedData.end(),
-                                 this->nullDataValue());
-  } else {
-    minValue = sortedData.front();
+                             double &maxValue) const {
+  if (!this->m_boundsValid) {
+    HmdfSpan<const qint64> date = this->dateSpan();
+    HmdfSpan<const double> data = this->dataSpan();
+
+    if (date.empty()) {
+      this->m_minDate = this->m_maxDate = HmdfStation::nullDateValue();
+    } else if (this->isSorted()) {
+      this->m_minDate = date.front();
+      this->m_maxDate = date.back();
+    } else {
+      dateBounds(date.data(), date.size(), this->m_minDate, this->m_maxDate);
+    }
+
+    if (!valueBounds(data.data(), data.size(), HmdfStation::nullDataValue(),
+                     this->m_nullValue, this->m_minValue, this->m_maxValue)) {
+      this->m_minValue = this->m_maxValue = HmdfStation::nullDataValue();
+    }
+    this->m_boundsValid = !this->m_writing;
   }
-  maxValue = sortedData.back();
 
+  minDate = this->m_minDate;
+  maxDate = this->m_maxDate;
+  minValue = this->m_minValue;
+  maxValue = this->m_maxValue;
+  return;
+}
+
+void HmdfStation::invalidateBounds() { this->m_boundsValid = false; }
+
+bool HmdfStation::isSorted() const {
+  if (this->m_sortState == SortUnknown) {
+    HmdfSpan<const qint64> date = this->dateSpan();
+    const bool sorted = std::is_sorted(date.begin(), date.end());
+    if (!this->m_writing) this->m_sortState = sorted ? Sorted : Unsorted;
+    return sorted;
+  }
+  return this->m_sortState == Sorted;
+}
+
+//...Index range [first, last) of the samples that fall inside
+//   [startDate, endDate]. Sorted series are searched with a binary search.
+//   Unsorted series return the full range and the caller still needs to
+//   test each date
+void HmdfStation::window(qint64 startDate, qint64 endDate, size_t &first,
+                         size_t &last) const {
+  HmdfSpan<const qint64> date = this->dateSpan();
+  if (!this->isSorted()) {
+    first = 0;
+    last = date.size();
+    return;
+  }
+  const qint64 *lo = std::lower_bound(date.begin(), date.end(), startDate);
+  const qint64 *hi = std::upper_bound(lo, date.end(), endDate);
+  first = static_cast<size_t>(lo - date.begin());
+  last = static_cast<size_t>(hi - date.begin());
   return;
 }
 
@@ -153,6 +382,7 @@ double HmdfStation::nullValue() const { return this->m_nullValue; }
 
 void HmdfStation::setNullValue(double nullValue) {
   this->m_nullValue = nullValue;
+  this->invalidateBounds();
 }
 
 int HmdfStation::applyDatumCorrection(Station s, Datum::VDatum datum) {
@@ -176,9 +406,10 @@ int HmdfStation::applyDatumCorrection(Station s, Datum::VDatum datum) {
 
   if (s.isNullOffset(shift)) return 1;
 
-  for (auto &d : this->m_data) {
+  for (auto &d : this->mutableDataSpan()) {
     d += shift;
   }
+  this->commitWrites();
 
   return 0;
 }
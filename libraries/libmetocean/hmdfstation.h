@@ -24,15 +24,29 @@
 #include <QObject>
 #include <QString>
 #include <QVector>
+#include <memory>
 #include "datum.h"
+#include "hmdfspan.h"
+#include "hmdfstore.h"
 #include "metocean_global.h"
 #include "station.h"
 
+class HmdfStation;
+
+//...Supplies the data of a station that was created from metadata only.
+//   The station calls load() the first time its data is needed
+class HmdfStationLoader {
+ public:
+  virtual ~HmdfStationLoader() {}
+  virtual int load(HmdfStation *station) = 0;
+};
+
 class HmdfStation : public QObject {
   Q_OBJECT
 
  public:
   explicit HmdfStation(QObject *parent = nullptr);
+  HmdfStation(std::shared_ptr<HmdfStore> store, QObject *parent = nullptr);
 
   void clear();
 
@@ -60,6 +74,8 @@ class HmdfStation : public QObject {
   void setId(const QString &id);
 
   size_t numSnaps() const;
+  void reserve(size_t numSnaps);
+  void resize(size_t numSnaps);
 
   int stationIndex() const;
   void setStationIndex(int stationIndex);
@@ -81,15 +97,48 @@ class HmdfStation : public QObject {
   QVector<qint64> allDate() const;
   QVector<double> allData() const;
 
+  HmdfSpan<const qint64> dateSpan() const;
+  HmdfSpan<const double> dataSpan() const;
+
+  //...Writable views of the station data. While one is in use the bounds
+  //   and sort state are not cached. Call commitWrites() once the writes
+  //   are finished so that they are cached again
+  HmdfSpan<qint64> mutableDateSpan();
+  HmdfSpan<double> mutableDataSpan();
+  void commitWrites();
+
   void dataBounds(qint64 &minDate, qint64 &maxDate, double &minValue,
-                  double &maxValue);
+                  double &maxValue) const;
+
+  bool isSorted() const;
+  void window(qint64 startDate, qint64 endDate, size_t &first,
+              size_t &last) const;
 
   double nullValue() const;
   void setNullValue(double nullValue);
 
   int applyDatumCorrection(Station s, Datum::VDatum datum);
 
+  std::shared_ptr<HmdfStore> store() const;
+
+  //...Use memory owned elsewhere (kept alive through HmdfStore::retain)
+  //   as this station's data until it is first modified. Pass sorted when
+  //   the dates are known to be in order so they are never scanned
+  void attach(const qint64 *date, const double *data, size_t numSnaps,
+              bool sorted = false);
+
+  //...Defer reading the data until it is first accessed. Metadata (name,
+  //   id, coordinates, null flag) has to be set up front
+  void setLoader(std::shared_ptr<HmdfStationLoader> loader);
+  bool isLoaded() const;
+  int load();
+
  private:
+  enum SortState { SortUnknown, Sorted, Unsorted };
+
+  void invalidateBounds();
+  void loadDeferred() const;
+
   QGeoCoordinate m_coordinate;
 
   QString m_name;
@@ -99,10 +148,20 @@ class HmdfStation : public QObject {
 
   double m_nullValue;
 
-  QVector<qint64> m_date;
-  QVector<double> m_data;
+  std::shared_ptr<HmdfStore> m_store;
+  size_t m_slot;
+
+  std::shared_ptr<HmdfStationLoader> m_loader;
 
   bool m_isNull;
+
+  bool m_writing;
+  mutable SortState m_sortState;
+  mutable bool m_boundsValid;
+  mutable qint64 m_minDate;
+  mutable qint64 m_maxDate;
+  mutable double m_minValue;
+  mutable double m_maxValue;
 };
 
 #endif  // HMDFSTATION
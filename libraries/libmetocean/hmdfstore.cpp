@@ -0,0 +1,194 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "hmdfstore.h"
+#include <algorithm>
+
+HmdfStore::HmdfStore() : m_used(0), m_abandoned(0) {}
+
+size_t HmdfStore::numSeries() const { return this->m_series.size(); }
+
+size_t HmdfStore::arenaSize() const { return this->m_used; }
+
+size_t HmdfStore::addSeries(size_t reserve) {
+  //...Trim the unused tail of the previous series so that stations
+  //   filled in order stay packed together
+  if (!this->m_series.empty()) {
+    Series &last = this->m_series.back();
+    if (!last.externalDate && last.offset + last.capacity == this->m_used) {
+      last.capacity = last.length;
+      this->m_used = last.offset + last.length;
+    }
+  }
+
+  Series s;
+  s.offset = this->m_used;
+  s.length = 0;
+  s.capacity = reserve;
+  s.externalDate = nullptr;
+  s.externalData = nullptr;
+  this->m_used += reserve;
+  this->ensureArena(this->m_used);
+  this->m_series.push_back(s);
+  return this->m_series.size() - 1;
+}
+
+void HmdfStore::resize(size_t slot, size_t length) {
+  Series &s = this->m_series[slot];
+  if (length > s.capacity) this->grow(slot, length);
+  s.length = length;
+}
+
+void HmdfStore::reserve(size_t slot, size_t capacity) {
+  if (capacity > this->m_series[slot].capacity) this->grow(slot, capacity);
+}
+
+void HmdfStore::clear(size_t slot) {
+  Series &s = this->m_series[slot];
+  if (s.externalDate) {
+    s.externalDate = nullptr;
+    s.externalData = nullptr;
+    s.offset = this->m_used;
+    s.capacity = 0;
+  }
+  s.length = 0;
+}
+
+void HmdfStore::attach(size_t slot, const qint64 *date, const double *data,
+                       size_t length) {
+  //...The slot's arena region (if any) is abandoned. The capacity is the
+  //   attached length so that any growth goes through grow()
+  Series &s = this->m_series[slot];
+  if (!s.externalDate) this->m_abandoned += s.capacity;
+  s.externalDate = date;
+  s.externalData = data;
+  s.length = length;
+  s.capacity = length;
+}
+
+void HmdfStore::retain(const std::shared_ptr<void> &owner) {
+  this->m_owners.push_back(owner);
+}
+
+void HmdfStore::materialize(size_t slot) {
+  this->grow(slot, this->m_series[slot].length);
+}
+
+void HmdfStore::reserveArena(size_t numValues) {
+  this->m_date.reserve(numValues);
+  this->m_data.reserve(numValues);
+}
+
+void HmdfStore::grow(size_t slot, size_t minCapacity) {
+  Series &s = this->m_series[slot];
+
+  if (s.externalDate) {
+    //...Copy attached data into a fresh region at the end of the arena
+    size_t capacity = std::max(minCapacity, s.length);
+    size_t offset = this->m_used;
+    this->m_used += capacity;
+    this->ensureArena(this->m_used);
+    std::copy(s.externalDate, s.externalDate + s.length,
+              this->m_date.begin() + offset);
+    std::copy(s.externalData, s.externalData + s.length,
+              this->m_data.begin() + offset);
+    s.offset = offset;
+    s.capacity = capacity;
+    s.externalDate = nullptr;
+    s.externalData = nullptr;
+    return;
+  }
+
+  size_t capacity = std::max(minCapacity, std::max<size_t>(2 * s.capacity, 16));
+
+  //...If the arena is about to outgrow its allocation and at least half of
+  //   it is regions left behind by moved series, pack it first
+  if (this->m_abandoned > 0 && 2 * this->m_abandoned >= this->m_used &&
+      this->m_used + capacity > this->m_date.capacity()) {
+    this->compact();
+  }
+
+  if (s.offset + s.capacity == this->m_used) {
+    //...Last series in the arena, extend it in place
+    this->m_used = s.offset + capacity;
+    this->ensureArena(this->m_used);
+  } else {
+    //...Move the series to the end of the arena. The old region is
+    //   abandoned until the next compaction
+    size_t offset = this->m_used;
+    this->m_abandoned += s.capacity;
+    this->m_used += capacity;
+    this->ensureArena(this->m_used);
+    std::copy(this->m_date.begin() + s.offset,
+              this->m_date.begin() + s.offset + s.length,
+              this->m_date.begin() + offset);
+    std::copy(this->m_data.begin() + s.offset,
+              this->m_data.begin() + s.offset + s.length,
+              this->m_data.begin() + offset);
+    s.offset = offset;
+  }
+  s.capacity = capacity;
+}
+
+void HmdfStore::compact() {
+  std::vector<size_t> order;
+  order.reserve(this->m_series.size());
+  for (size_t i = 0; i < this->m_series.size(); ++i) {
+    if (!this->m_series[i].externalDate) order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return this->m_series[a].offset < this->m_series[b].offset;
+  });
+
+  //...Regions are visited in arena order so every copy moves data toward
+  //   the front and never overwrites a region that has not been moved yet
+  size_t used = 0;
+  for (auto i : order) {
+    Series &s = this->m_series[i];
+    if (s.offset != used) {
+      std::copy(this->m_date.begin() + s.offset,
+                this->m_date.begin() + s.offset + s.length,
+                this->m_date.begin() + used);
+      std::copy(this->m_data.begin() + s.offset,
+                this->m_data.begin() + s.offset + s.length,
+                this->m_data.begin() + used);
+      s.offset = used;
+    }
+    used += s.capacity;
+  }
+
+  this->m_used = used;
+  this->m_abandoned = 0;
+}
+
+void HmdfStore::ensureArena(size_t size) {
+  if (this->m_date.size() >= size) return;
+
+  //...Fill out a reserved arena before asking for more memory so that a
+  //   store sized up front with reserveArena never reallocates. Only an
+  //   arena that has run out of room is doubled
+  size_t n;
+  if (size <= this->m_date.capacity()) {
+    n = this->m_date.capacity();
+  } else {
+    n = std::max(size, 2 * this->m_date.size());
+  }
+  this->m_date.resize(n);
+  this->m_data.resize(n);
+}
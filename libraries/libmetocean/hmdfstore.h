@@ -0,0 +1,114 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef HMDFSTORE_H
+#define HMDFSTORE_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//...Columnar backing store for Hmdf station data. All stations share one
+//   contiguous date arena and one contiguous value arena. Each station is a
+//   slot described by an offset/length/capacity entry in the series table.
+//   Slots filled one after another (the way all of the readers work) are
+//   packed back to back without gaps.
+//
+//   A slot can also be attached to read-only memory owned by someone else
+//   (a mapped file). Const access reads it in place; the first mutable
+//   access copies it into the arena.
+//
+//   Pointers returned by date() and data() are invalidated by any call to
+//   addSeries, resize, reserve or append, and by the first mutable access
+//   to an attached slot. Any of these may move the arena. Reserve the whole
+//   arena up front with reserveArena to keep it from reallocating.
+class HmdfStore {
+ public:
+  HmdfStore();
+
+  size_t addSeries(size_t reserve = 0);
+  size_t numSeries() const;
+
+  size_t length(size_t slot) const {
+    return this->m_series[slot].length;
+  }
+
+  const qint64 *date(size_t slot) const {
+    const Series &s = this->m_series[slot];
+    return s.externalDate ? s.externalDate : this->m_date.data() + s.offset;
+  }
+  qint64 *date(size_t slot) {
+    if (this->m_series[slot].externalDate) this->materialize(slot);
+    return this->m_date.data() + this->m_series[slot].offset;
+  }
+
+  const double *data(size_t slot) const {
+    const Series &s = this->m_series[slot];
+    return s.externalData ? s.externalData : this->m_data.data() + s.offset;
+  }
+  double *data(size_t slot) {
+    if (this->m_series[slot].externalData) this->materialize(slot);
+    return this->m_data.data() + this->m_series[slot].offset;
+  }
+
+  void append(size_t slot, qint64 date, double data) {
+    Series &s = this->m_series[slot];
+    if (s.length == s.capacity) this->grow(slot, s.length + 1);
+    const size_t p = s.offset + s.length;
+    this->m_date[p] = date;
+    this->m_data[p] = data;
+    ++s.length;
+  }
+
+  void resize(size_t slot, size_t length);
+  void reserve(size_t slot, size_t capacity);
+  void clear(size_t slot);
+
+  void attach(size_t slot, const qint64 *date, const double *data,
+              size_t length);
+  void retain(const std::shared_ptr<void> &owner);
+
+  void reserveArena(size_t numValues);
+
+  size_t arenaSize() const;
+
+ private:
+  struct Series {
+    size_t offset;
+    size_t length;
+    size_t capacity;
+    const qint64 *externalDate;
+    const double *externalData;
+  };
+
+  void grow(size_t slot, size_t minCapacity);
+  void materialize(size_t slot);
+  void compact();
+  void ensureArena(size_t size);
+
+  size_t m_used;
+  size_t m_abandoned;
+  std::vector<Series> m_series;
+  std::vector<qint64> m_date;
+  std::vector<double> m_data;
+  std::vector<std::shared_ptr<void>> m_owners;
+};
+
+#endif  // HMDFSTORE_H
@@ -0,0 +1,143 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "hmdfstreamwriter.h"
+#include <QFileInfo>
+#include "hmdfasciiwriter.h"
+#include "netcdfstreamwriter.h"
+
+HmdfStreamWriter::HmdfStreamWriter(const QString &filename,
+                                   const QString &datum, const QString &units)
+    : m_filename(filename), m_datum(datum), m_units(units) {}
+
+HmdfStreamWriter::~HmdfStreamWriter() {}
+
+HmdfStreamWriter *HmdfStreamWriter::create(const QString &filename,
+                                           FileType fileType,
+                                           const QString &datum,
+                                           const QString &units) {
+  if (fileType == Imeds) {
+    return new ImedsStreamWriter(filename, datum, units);
+  } else if (fileType == Csv) {
+    return new CsvStreamWriter(filename, datum, units);
+  } else if (fileType == NetCdf) {
+    return new NetcdfStreamWriter(filename, datum, units);
+  }
+  return nullptr;
+}
+
+HmdfStreamWriter *HmdfStreamWriter::create(const QString &filename,
+                                           const QString &datum,
+                                           const QString &units) {
+  QFileInfo info(filename);
+  if (info.suffix().toLower() == "imeds") {
+    return HmdfStreamWriter::create(filename, Imeds, datum, units);
+  } else if (info.suffix().toLower() == "csv") {
+    return HmdfStreamWriter::create(filename, Csv, datum, units);
+  } else if (info.suffix().toLower() == "nc") {
+    return HmdfStreamWriter::create(filename, NetCdf, datum, units);
+  }
+  return nullptr;
+}
+
+ImedsStreamWriter::ImedsStreamWriter(const QString &filename,
+                                     const QString &datum,
+                                     const QString &units)
+    : HmdfStreamWriter(filename, datum, units), m_file(filename) {}
+
+ImedsStreamWriter::~ImedsStreamWriter() { this->close(); }
+
+int ImedsStreamWriter::open(const std::vector<HmdfStreamStation> &stations) {
+  this->m_stations = stations;
+  if (!this->m_file.open(QIODevice::WriteOnly)) return -1;
+  this->m_writer.reset(new HmdfAsciiWriter(&this->m_file));
+  this->m_writer->write(QString("% IMEDS generic format\n"));
+  this->m_writer->write(QString("% year month day hour min sec value\n"));
+  this->m_writer->write("MetOceanViewer    UTC    " + this->m_datum + "   " +
+                        this->m_units + "\n");
+  return 0;
+}
+
+int ImedsStreamWriter::beginStation(size_t index) {
+  const HmdfStreamStation &s = this->m_stations[index];
+  QString stationName = s.name;
+  stationName.replace(" ", "_").replace(",", "_").replace("__", "_");
+  this->m_writer->write(stationName + "   " + QString::number(s.latitude) +
+                        "   " + QString::number(s.longitude) + "\n");
+  return 0;
+}
+
+int ImedsStreamWriter::write(const qint64 *date, const double *data,
+                             size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    this->m_writer->writeImedsRecord(date[i], data[i]);
+  }
+  return this->m_writer->failed() ? -1 : 0;
+}
+
+int ImedsStreamWriter::endStation() { return 0; }
+
+int ImedsStreamWriter::close() {
+  if (!this->m_writer) return 0;
+  bool ok = this->m_writer->flush();
+  this->m_writer.reset();
+  this->m_file.close();
+  return ok ? 0 : -1;
+}
+
+CsvStreamWriter::CsvStreamWriter(const QString &filename,
+                                 const QString &datum, const QString &units)
+    : HmdfStreamWriter(filename, datum, units), m_file(filename) {}
+
+CsvStreamWriter::~CsvStreamWriter() { this->close(); }
+
+int CsvStreamWriter::open(const std::vector<HmdfStreamStation> &stations) {
+  this->m_stations = stations;
+  if (!this->m_file.open(QIODevice::WriteOnly)) return -1;
+  this->m_writer.reset(new HmdfAsciiWriter(&this->m_file));
+  return 0;
+}
+
+int CsvStreamWriter::beginStation(size_t index) {
+  this->m_writer->write("Station: " + this->m_stations[index].name + "\n");
+  this->m_writer->write("Datum: " + this->m_datum + "\n");
+  this->m_writer->write("Units: " + this->m_units + "\n");
+  this->m_writer->write("\n", 1);
+  return 0;
+}
+
+int CsvStreamWriter::write(const qint64 *date, const double *data, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    this->m_writer->writeCsvRecord(date[i], data[i]);
+  }
+  return this->m_writer->failed() ? -1 : 0;
+}
+
+int CsvStreamWriter::endStation() {
+  this->m_writer->write("\n\n\n", 3);
+  return 0;
+}
+
+int CsvStreamWriter::close() {
+  if (!this->m_writer) return 0;
+  bool ok = this->m_writer->flush();
+  this->m_writer.reset();
+  this->m_file.close();
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,115 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef HMDFSTREAMWRITER_H
+#define HMDFSTREAMWRITER_H
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include <limits>
+#include <memory>
+#include <vector>
+
+class HmdfAsciiWriter;
+
+//...Description of one station in a streamed dataset. The length is the
+//   number of records that will be written for the station, which formats
+//   with fixed size variables (netCDF) need to know up front. Values equal
+//   to nullValue (by default HmdfStation::nullDataValue()) are missing
+struct HmdfStreamStation {
+  QString name;
+  QString id;
+  double latitude;
+  double longitude;
+  double nullValue;
+  size_t length;
+
+  HmdfStreamStation()
+      : latitude(0.0),
+        longitude(0.0),
+        nullValue(-std::numeric_limits<double>::max()),
+        length(0) {}
+};
+
+//...Writes a timeseries dataset one station and one chunk at a time so
+//   that the full dataset never has to be held in memory. Usage is
+//   open(), then for every station in order beginStation() followed by
+//   any number of write() calls and endStation(), then close()
+class HmdfStreamWriter {
+ public:
+  enum FileType { Imeds, Csv, NetCdf };
+
+  HmdfStreamWriter(const QString &filename, const QString &datum,
+                   const QString &units);
+  virtual ~HmdfStreamWriter();
+
+  static HmdfStreamWriter *create(const QString &filename,
+                                  const QString &datum, const QString &units);
+  static HmdfStreamWriter *create(const QString &filename, FileType fileType,
+                                  const QString &datum, const QString &units);
+
+  virtual int open(const std::vector<HmdfStreamStation> &stations) = 0;
+  virtual int beginStation(size_t index) = 0;
+  virtual int write(const qint64 *date, const double *data, size_t n) = 0;
+  virtual int endStation() = 0;
+  virtual int close() = 0;
+
+ protected:
+  QString m_filename;
+  QString m_datum;
+  QString m_units;
+  std::vector<HmdfStreamStation> m_stations;
+};
+
+class ImedsStreamWriter : public HmdfStreamWriter {
+ public:
+  ImedsStreamWriter(const QString &filename, const QString &datum,
+                    const QString &units);
+  ~ImedsStreamWriter() override;
+
+  int open(const std::vector<HmdfStreamStation> &stations) override;
+  int beginStation(size_t index) override;
+  int write(const qint64 *date, const double *data, size_t n) override;
+  int endStation() override;
+  int close() override;
+
+ private:
+  QFile m_file;
+  std::unique_ptr<HmdfAsciiWriter> m_writer;
+};
+
+class CsvStreamWriter : public HmdfStreamWriter {
+ public:
+  CsvStreamWriter(const QString &filename, const QString &datum,
+                  const QString &units);
+  ~CsvStreamWriter() override;
+
+  int open(const std::vector<HmdfStreamStation> &stations) override;
+  int beginStation(size_t index) override;
+  int write(const qint64 *date, const double *data, size_t n) override;
+  int endStation() override;
+  int close() override;
+
+ private:
+  QFile m_file;
+  std::unique_ptr<HmdfAsciiWriter> m_writer;
+};
+
+#endif  // HMDFSTREAMWRITER_H
@@ -0,0 +1,287 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "imedsreader.h"
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include "hmdfasciiparser.h"
+#include "timeconversion.h"
+
+//...Files smaller than this are parsed on the calling thread
+static const qint64 c_parallelThreshold = 8 * 1024 * 1024;
+
+static const char *nextLine(const char *eol, const char *end) {
+  return eol < end ? eol + 1 : end;
+}
+
+ImedsReader::ImedsReader(const QString &filename)
+    : m_file(filename), m_map(nullptr), m_begin(nullptr), m_end(nullptr) {}
+
+ImedsReader::~ImedsReader() { this->unmap(); }
+
+int ImedsReader::map() {
+  if (!this->m_file.open(QIODevice::ReadOnly)) return -1;
+
+  //...Map the file and parse it in place. Fall back to reading it into
+  //   memory where the file cannot be mapped
+  qint64 size = this->m_file.size();
+  this->m_map = size > 0 ? this->m_file.map(0, size) : nullptr;
+  if (this->m_map) {
+    this->m_begin = reinterpret_cast<const char *>(this->m_map);
+  } else {
+    this->m_buffer = this->m_file.readAll();
+    this->m_begin = this->m_buffer.constData();
+    size = this->m_buffer.size();
+  }
+  this->m_end = this->m_begin + size;
+  return 0;
+}
+
+void ImedsReader::unmap() {
+  if (this->m_map) this->m_file.unmap(this->m_map);
+  this->m_map = nullptr;
+  this->m_buffer.clear();
+  if (this->m_file.isOpen()) this->m_file.close();
+}
+
+int ImedsReader::read(Hmdf *hmdf) {
+  int ierr = this->map();
+  if (ierr != 0) return ierr;
+
+  const char *p = this->m_begin;
+  const char *end = this->m_end;
+
+  //...Read Header
+  QString header[3];
+  for (int i = 0; i < 3; i++) {
+    const char *eol = HmdfAsciiParser::lineEnd(p, end);
+    header[i] = QString::fromUtf8(p, static_cast<int>(eol - p)).trimmed();
+    p = nextLine(eol, end);
+  }
+  hmdf->setHeader1(header[0]);
+  hmdf->setHeader2(header[1]);
+  hmdf->setHeader3(header[2]);
+
+  //...Read Body
+  if (end - p < c_parallelThreshold || QThread::idealThreadCount() < 2) {
+    //...Every line is at most one record, so the line count bounds the
+    //   size of the arena
+    hmdf->reserve(static_cast<size_t>(std::count(p, end, '\n')) + 1);
+    ierr = ImedsReader::parseSerial(p, end, hmdf);
+  } else {
+    ierr = this->readParallel(p, end, hmdf);
+  }
+
+  this->unmap();
+  return ierr;
+}
+
+int ImedsReader::readParallel(const char *begin, const char *end,
+                              Hmdf *hmdf) const {
+  std::vector<Header> headers = this->scan(begin, end);
+  if (headers.empty()) return ImedsReader::parseSerial(begin, end, hmdf);
+
+  size_t total = 0;
+  for (size_t i = 0; i < headers.size(); ++i) total += headers[i].numLines;
+  hmdf->reserve(total);
+
+  //...Anything ahead of the first header line is read exactly the way the
+  //   serial reader would
+  int ierr = ImedsReader::parseSerial(begin, headers.front().line, hmdf);
+  if (ierr != 0) return ierr;
+
+  //...Allocate every station up front, sized by its line count
+  std::vector<Block> blocks(headers.size());
+  for (size_t i = 0; i < headers.size(); ++i) {
+    const char *eol = HmdfAsciiParser::lineEnd(headers[i].line, end);
+    Block &b = blocks[i];
+    b.station = ImedsReader::createStation(headers[i].line, eol, hmdf);
+    if (!b.station) return 1;
+    b.station->resize(headers[i].numLines);
+    b.begin = nextLine(eol, end);
+    b.end = i + 1 < headers.size() ? headers[i + 1].line : end;
+    b.count = 0;
+    b.tail = b.begin;
+  }
+
+  //...Arena pointers are only stable once every slot has been allocated
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i].date = blocks[i].station->mutableDateSpan().data();
+    blocks[i].data = blocks[i].station->mutableDataSpan().data();
+  }
+
+  QtConcurrent::blockingMap(blocks, &ImedsReader::parseBlock);
+
+  //...Assemble in file order. A block that stopped early on a line that
+  //   is not a record is finished by the serial reader, which treats that
+  //   line as the next station header
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i].station->resize(blocks[i].count);
+    blocks[i].station->commitWrites();
+    hmdf->addStation(blocks[i].station);
+    if (blocks[i].tail < blocks[i].end) {
+      ierr = ImedsReader::parseSerial(blocks[i].tail, blocks[i].end, hmdf);
+      if (ierr != 0) return ierr;
+    }
+  }
+
+  return 0;
+}
+
+std::vector<ImedsReader::Header> ImedsReader::scan(const char *begin,
+                                                   const char *end) const {
+  //...Split the body into one chunk per thread on line boundaries
+  const int nChunks = std::max(1, QThread::idealThreadCount());
+  std::vector<ScanChunk> chunks;
+  chunks.reserve(nChunks);
+  const char *chunkBegin = begin;
+  for (int i = 1; i <= nChunks; ++i) {
+    const char *chunkEnd =
+        i == nChunks ? end : begin + (end - begin) * i / nChunks;
+    if (chunkEnd <= chunkBegin) continue;
+    if (chunkEnd < end)
+      chunkEnd = nextLine(HmdfAsciiParser::lineEnd(chunkEnd - 1, end), end);
+    ScanChunk c;
+    c.begin = chunkBegin;
+    c.end = chunkEnd;
+    c.leadLines = 0;
+    chunks.push_back(c);
+    chunkBegin = chunkEnd;
+  }
+
+  QtConcurrent::blockingMap(chunks, &ImedsReader::scanChunk);
+
+  //...Lines at the top of a chunk belong to the last station of the
+  //   chunk before it
+  std::vector<Header> headers;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    if (!headers.empty()) headers.back().numLines += chunks[i].leadLines;
+    headers.insert(headers.end(), chunks[i].headers.begin(),
+                   chunks[i].headers.end());
+  }
+  return headers;
+}
+
+void ImedsReader::scanChunk(ScanChunk &chunk) {
+  //...A record has at least six fields, a station header has three. Only
+  //   the field count is checked here; records that fail to parse are
+  //   caught later by parseBlock
+  const char *p = chunk.begin;
+  while (p < chunk.end) {
+    const char *eol = HmdfAsciiParser::lineEnd(p, chunk.end);
+    int nTokens = 0;
+    const char *q = p;
+    const char *tokenEnd;
+    while (nTokens < 6 && HmdfAsciiParser::nextToken(q, eol, tokenEnd)) {
+      ++nTokens;
+      q = tokenEnd;
+    }
+    if (nTokens > 0 && nTokens < 6) {
+      Header h;
+      h.line = p;
+      h.numLines = 0;
+      chunk.headers.push_back(h);
+    } else if (chunk.headers.empty()) {
+      ++chunk.leadLines;
+    } else {
+      ++chunk.headers.back().numLines;
+    }
+    p = nextLine(eol, chunk.end);
+  }
+}
+
+void ImedsReader::parseBlock(Block &block) {
+  const char *p = block.begin;
+  size_t n = 0;
+  while (p < block.end) {
+    const char *eol = HmdfAsciiParser::lineEnd(p, block.end);
+
+    int year, month, day, hour, minute, second;
+    double value;
+
+    if (!HmdfAsciiParser::parseRecord(p, eol, year, month, day, hour, minute,
+                                      second, value))
+      break;
+
+    block.date[n] = TimeConversion::msecsFromCivil(year, month, day, hour,
+                                                   minute, second);
+    block.data[n] = value;
+    ++n;
+    p = nextLine(eol, block.end);
+  }
+  block.count = n;
+  block.tail = p;
+}
+
+int ImedsReader::parseSerial(const char *begin, const char *end, Hmdf *hmdf) {
+  const char *p = begin;
+  while (p < end) {
+    const char *eol = HmdfAsciiParser::lineEnd(p, end);
+
+    //...Skip blank lines between stations
+    const char *q = p;
+    const char *tokenEnd;
+    if (!HmdfAsciiParser::nextToken(q, eol, tokenEnd)) {
+      p = nextLine(eol, end);
+      continue;
+    }
+
+    HmdfStation *station = ImedsReader::createStation(p, eol, hmdf);
+    if (!station) return 1;
+
+    p = nextLine(eol, end);
+
+    while (p < end) {
+      eol = HmdfAsciiParser::lineEnd(p, end);
+
+      int year, month, day, hour, minute, second;
+      double value;
+
+      if (!HmdfAsciiParser::parseRecord(p, eol, year, month, day, hour, minute,
+                                        second, value))
+        break;
+
+      //...Append to the station data
+      station->setNext(TimeConversion::msecsFromCivil(year, month, day, hour,
+                                                      minute, second),
+                       value);
+      p = nextLine(eol, end);
+    }
+
+    //...Add the station
+    hmdf->addStation(station);
+  }
+  return 0;
+}
+
+HmdfStation *ImedsReader::createStation(const char *begin, const char *end,
+                                        Hmdf *hmdf) {
+  const char *name, *nameEnd;
+  double latitude, longitude;
+  if (!HmdfAsciiParser::parseStationHeader(begin, end, name, nameEnd, latitude,
+                                           longitude))
+    return nullptr;
+
+  HmdfStation *station = new HmdfStation(hmdf);
+  station->setName(QString::fromUtf8(name, static_cast<int>(nameEnd - name)));
+  station->setLongitude(longitude);
+  station->setLatitude(latitude);
+  return station;
+}
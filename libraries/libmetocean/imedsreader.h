@@ -0,0 +1,82 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef IMEDSREADER_H
+#define IMEDSREADER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "hmdf.h"
+
+//...Reads IMEDS files into an Hmdf object. The file is memory mapped and
+//   parsed in two phases: a scan that finds the station header lines,
+//   then a parallel parse of each station block directly into the store
+class ImedsReader {
+ public:
+  explicit ImedsReader(const QString &filename);
+  ~ImedsReader();
+
+  int read(Hmdf *hmdf);
+
+ private:
+  struct Header {
+    const char *line;
+    size_t numLines;
+  };
+
+  struct Block {
+    HmdfStation *station;
+    const char *begin;
+    const char *end;
+    qint64 *date;
+    double *data;
+    size_t count;
+    const char *tail;
+  };
+
+  struct ScanChunk {
+    const char *begin;
+    const char *end;
+    size_t leadLines;
+    std::vector<Header> headers;
+  };
+
+  int map();
+  void unmap();
+
+  int readParallel(const char *begin, const char *end, Hmdf *hmdf) const;
+
+  static void scanChunk(ScanChunk &chunk);
+  static void parseBlock(Block &block);
+  static int parseSerial(const char *begin, const char *end, Hmdf *hmdf);
+  static HmdfStation *createStation(const char *begin, const char *end,
+                                    Hmdf *hmdf);
+
+  std::vector<Header> scan(const char *begin, const char *end) const;
+
+  QFile m_file;
+  QByteArray m_buffer;
+  uchar *m_map;
+  const char *m_begin;
+  const char *m_end;
+};
+
+#endif  // IMEDSREADER_H
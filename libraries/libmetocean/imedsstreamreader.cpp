@@ -0,0 +1,237 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "imedsstreamreader.h"
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+#include "hmdfasciiparser.h"
+#include "timeconversion.h"
+
+ImedsStreamReader::ImedsStreamReader(const QString &filename,
+                                     size_t bufferSize)
+    : m_file(filename),
+      m_buffer(std::max<size_t>(bufferSize, 4096)),
+      m_begin(0),
+      m_end(0),
+      m_eof(false),
+      m_state(Finished),
+      m_error(0),
+      m_hasPending(false),
+      m_windowStart(std::numeric_limits<qint64>::min()),
+      m_windowEnd(std::numeric_limits<qint64>::max()) {}
+
+int ImedsStreamReader::open() {
+  if (!this->m_file.open(QIODevice::ReadOnly)) return -1;
+  return this->rewind();
+}
+
+void ImedsStreamReader::close() {
+  this->m_file.close();
+  this->m_state = Finished;
+}
+
+int ImedsStreamReader::rewind() {
+  if (!this->m_file.seek(0)) return -1;
+  this->m_begin = 0;
+  this->m_end = 0;
+  this->m_eof = false;
+  this->m_error = 0;
+  this->m_hasPending = false;
+  this->m_state = BetweenStations;
+
+  //...Read Header
+  for (int i = 0; i < 3; ++i) {
+    const char *begin, *end;
+    if (this->nextLine(begin, end)) {
+      this->m_header[i] =
+          QString::fromUtf8(begin, static_cast<int>(end - begin)).trimmed();
+    } else {
+      this->m_header[i] = QString();
+    }
+  }
+
+  //...The third header line is "source timezone datum [units]"
+  QStringList fields = this->m_header[2].simplified().split(
+      QLatin1Char(' '), QString::SkipEmptyParts);
+  this->m_datum = fields.value(2);
+  this->m_units = fields.value(3);
+
+  return 0;
+}
+
+QString ImedsStreamReader::header1() const { return this->m_header[0]; }
+
+QString ImedsStreamReader::header2() const { return this->m_header[1]; }
+
+QString ImedsStreamReader::header3() const { return this->m_header[2]; }
+
+QString ImedsStreamReader::datum() const { return this->m_datum; }
+
+QString ImedsStreamReader::units() const { return this->m_units; }
+
+int ImedsStreamReader::error() const { return this->m_error; }
+
+void ImedsStreamReader::setWindow(qint64 startDate, qint64 endDate) {
+  this->m_windowStart = startDate;
+  this->m_windowEnd = endDate;
+}
+
+bool ImedsStreamReader::fill() {
+  //...Move the unread tail to the front and grow the buffer only when a
+  //   single line does not fit in it
+  size_t remaining = this->m_end - this->m_begin;
+  if (this->m_begin > 0 && remaining > 0) {
+    std::memmove(this->m_buffer.data(), this->m_buffer.data() + this->m_begin,
+                 remaining);
+  }
+  this->m_begin = 0;
+  this->m_end = remaining;
+  if (this->m_end == this->m_buffer.size())
+    this->m_buffer.resize(2 * this->m_buffer.size());
+
+  qint64 n = this->m_file.read(this->m_buffer.data() + this->m_end,
+                               this->m_buffer.size() - this->m_end);
+  if (n <= 0) {
+    this->m_eof = true;
+    return false;
+  }
+  this->m_end += static_cast<size_t>(n);
+  return true;
+}
+
+bool ImedsStreamReader::nextLine(const char *&begin, const char *&end) {
+  for (;;) {
+    const char *base = this->m_buffer.data();
+    const char *p = base + this->m_begin;
+    const char *last = base + this->m_end;
+    const void *eol = std::memchr(p, '\n', static_cast<size_t>(last - p));
+    if (eol) {
+      begin = p;
+      end = static_cast<const char *>(eol);
+      this->m_begin = static_cast<size_t>(end - base) + 1;
+      return true;
+    }
+    if (this->m_eof) {
+      if (p == last) return false;
+      begin = p;
+      end = last;
+      this->m_begin = this->m_end;
+      return true;
+    }
+    this->fill();
+  }
+}
+
+bool ImedsStreamReader::nextStation(HmdfStreamStation &station) {
+  //...Skip whatever is left of the current station
+  if (this->m_state == InStation) {
+    qint64 date[256];
+    double data[256];
+    while (this->read(date, data, 256) > 0) {
+    }
+  }
+
+  while (this->m_state == BetweenStations) {
+    const char *begin, *end;
+    if (this->m_hasPending) {
+      begin = this->m_pending.data();
+      end = begin + this->m_pending.size();
+      this->m_hasPending = false;
+    } else if (!this->nextLine(begin, end)) {
+      this->m_state = Finished;
+      break;
+    }
+
+    //...Skip blank lines between stations
+    const char *q = begin;
+    const char *tokenEnd;
+    if (!HmdfAsciiParser::nextToken(q, end, tokenEnd)) continue;
+
+    const char *name, *nameEnd;
+    double latitude, longitude;
+    if (!HmdfAsciiParser::parseStationHeader(begin, end, name, nameEnd,
+                                             latitude, longitude)) {
+      this->m_error = 1;
+      this->m_state = Finished;
+      break;
+    }
+
+    station = HmdfStreamStation();
+    station.name = QString::fromUtf8(name, static_cast<int>(nameEnd - name));
+    station.id = "noid";
+    station.latitude = latitude;
+    station.longitude = longitude;
+    this->m_state = InStation;
+    return true;
+  }
+  return false;
+}
+
+size_t ImedsStreamReader::read(qint64 *date, double *data, size_t capacity) {
+  size_t n = 0;
+  while (this->m_state == InStation && n < capacity) {
+    const char *begin, *end;
+    if (!this->nextLine(begin, end)) {
+      this->m_state = Finished;
+      break;
+    }
+
+    int year, month, day, hour, minute, second;
+    double value;
+    if (!HmdfAsciiParser::parseRecord(begin, end, year, month, day, hour,
+                                      minute, second, value)) {
+      //...This line starts the next station
+      this->m_pending.assign(begin, end);
+      this->m_hasPending = true;
+      this->m_state = BetweenStations;
+      break;
+    }
+
+    qint64 t = TimeConversion::msecsFromCivil(year, month, day, hour, minute,
+                                              second);
+    if (t < this->m_windowStart || t > this->m_windowEnd) continue;
+    date[n] = t;
+    data[n] = value;
+    ++n;
+  }
+  return n;
+}
+
+int ImedsStreamReader::scan(std::vector<HmdfStreamStation> &stations) {
+  //...Counts the records of every station (inside the window) without
+  //   keeping them, then rewinds so the data can be read
+  int ierr = this->rewind();
+  if (ierr != 0) return ierr;
+
+  std::vector<qint64> date(65536);
+  std::vector<double> data(65536);
+  stations.clear();
+  HmdfStreamStation station;
+  while (this->nextStation(station)) {
+    size_t n;
+    while ((n = this->read(date.data(), data.data(), date.size())) > 0) {
+      station.length += n;
+    }
+    stations.push_back(station);
+  }
+  if (this->m_error != 0) return this->m_error;
+
+  return this->rewind();
+}
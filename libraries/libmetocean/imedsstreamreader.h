@@ -0,0 +1,82 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef IMEDSSTREAMREADER_H
+#define IMEDSSTREAMREADER_H
+
+#include <QFile>
+#include <QString>
+#include <limits>
+#include <string>
+#include <vector>
+#include "hmdfstreamwriter.h"
+
+//...Pull based IMEDS reader that holds at most one read buffer of the file
+//   in memory. Stations are visited in file order with nextStation() and
+//   their records are pulled in chunks with read(), which returns 0 once
+//   the station is exhausted. Parsing follows ImedsReader exactly
+class ImedsStreamReader {
+ public:
+  explicit ImedsStreamReader(const QString &filename,
+                             size_t bufferSize = 4 * 1024 * 1024);
+
+  int open();
+  int rewind();
+  void close();
+
+  QString header1() const;
+  QString header2() const;
+  QString header3() const;
+
+  //...Datum and units named in the third header line (empty if absent)
+  QString datum() const;
+  QString units() const;
+
+  void setWindow(qint64 startDate, qint64 endDate);
+
+  bool nextStation(HmdfStreamStation &station);
+  size_t read(qint64 *date, double *data, size_t capacity);
+
+  int scan(std::vector<HmdfStreamStation> &stations);
+
+  int error() const;
+
+ private:
+  enum State { BetweenStations, InStation, Finished };
+
+  bool nextLine(const char *&begin, const char *&end);
+  bool fill();
+
+  QFile m_file;
+  std::vector<char> m_buffer;
+  size_t m_begin;
+  size_t m_end;
+  bool m_eof;
+  State m_state;
+  int m_error;
+  bool m_hasPending;
+  std::string m_pending;
+  qint64 m_windowStart;
+  qint64 m_windowEnd;
+  QString m_header[3];
+  QString m_datum;
+  QString m_units;
+};
+
+#endif  // IMEDSSTREAMREADER_H
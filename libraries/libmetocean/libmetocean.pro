@@ -18,7 +18,7 @@
 #
 #-----------------------------------------------------------------------#
 
-QT       += network positioning
+QT       += network positioning concurrent
 
 TARGET = metocean
 TEMPLATE = lib
@@ -43,10 +43,19 @@ INCLUDEPATH += $$PWD/../../thirdparty/boost_1_67_0
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += hmdfasciiparser.cpp  \
+           hmdfasciiwriter.cpp \
+           hmdfbinaryfile.cpp \
+           hmdfcache.cpp \
            crmsdata.cpp \
            hmdf.cpp  \
            hmdfstation.cpp  \
+           hmdfstore.cpp \
+           imedsreader.cpp \
+           imedsstreamreader.cpp \
+           hmdfstreamwriter.cpp \
+           netcdfstreamwriter.cpp \
            netcdftimeseries.cpp  \
+           netcdfwriteprofile.cpp \
            noaacoops.cpp  \
            stringutil.cpp  \
            timezone.cpp  \
@@ -63,14 +72,26 @@ SOURCES += hmdfasciiparser.cpp  \
            highwatermarks.cpp \
            hwmdata.cpp
 
-HEADERS += hmdfasciiparser.h  \
+HEADERS += boundedqueue.h \
+           hmdfasciiparser.h  \
+           hmdfasciiwriter.h \
+           hmdfbinaryfile.h \
+           hmdfcache.h \
            crmsdata.h \
            datum.h \
            hmdf.h  \
+           hmdfspan.h \
            hmdfstation.h  \
+           hmdfstore.h \
+           imedsreader.h \
+           imedsstreamreader.h \
+           hmdfstreamwriter.h \
+           netcdfstreamwriter.h \
            netcdftimeseries.h  \
+           netcdfwriteprofile.h \
            noaacoops.h  \
            stringutil.h  \
+           timeconversion.h \
            timezone.h  \
            timezonestruct.h  \
            tzdata.h  \
@@ -0,0 +1,629 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "netcdfstreamwriter.h"
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QHostInfo>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include "netcdf.h"
+
+#define NCCHECK(ierr)     \
+  if (ierr != NC_NOERR) { \
+    this->close();        \
+    return ierr;          \
+  }
+
+static const size_t c_stationNameLength = 200;
+
+//...Stored in place of missing values. NetcdfTimeseries uses the same
+//   value for files without a fill value
+static const double c_fillValue = -99999.0;
+
+//...Integer attribute of a time variable, 1 when its values are stored in
+//   order. NetcdfTimeseries then locates a time window by bisection
+static const char *c_sortedAttribute = "sorted";
+
+//...Entry of a fixed width (space or null padded) character table
+static QString directoryString(const std::string &table, size_t index,
+                               size_t width) {
+  std::string s = table.substr(index * width, width);
+  size_t end = s.find('\0');
+  if (end != std::string::npos) s.resize(end);
+  return QString::fromStdString(s).trimmed();
+}
+
+//...Key used to match a station against the stations already in a file.
+//   The id is used when it is a real one. "noid" is the placeholder given
+//   to every station read without an id, so those (and stations with no id
+//   at all) are matched by name instead
+static QString stationKey(const QString &id, const QString &name) {
+  if (!id.isEmpty() && id != QStringLiteral("noid"))
+    return QStringLiteral("id:") + id;
+  return QStringLiteral("name:") + name;
+}
+
+NetcdfStreamWriter::NetcdfStreamWriter(const QString &filename,
+                                       const QString &datum,
+                                       const QString &units)
+    : HmdfStreamWriter(filename, datum, units),
+      m_layout(StationVariables),
+      m_profile(NetcdfWriteProfile::Default),
+      m_append(false),
+      m_ncid(-1),
+      m_varidStationName(-1),
+      m_varidStationId(-1),
+      m_varidStationX(-1),
+      m_varidStationY(-1),
+      m_varidRowSize(-1),
+      m_current(0) {}
+
+NetcdfStreamWriter::~NetcdfStreamWriter() { this->close(); }
+
+NetcdfStreamWriter::Layout NetcdfStreamWriter::layout() const {
+  return this->m_layout;
+}
+
+void NetcdfStreamWriter::setLayout(Layout layout) { this->m_layout = layout; }
+
+NetcdfWriteProfile NetcdfStreamWriter::profile() const {
+  return this->m_profile;
+}
+
+void NetcdfStreamWriter::setProfile(const NetcdfWriteProfile &profile) {
+  this->m_profile = profile;
+}
+
+bool NetcdfStreamWriter::append() const { return this->m_append; }
+
+void NetcdfStreamWriter::setAppend(bool append) { this->m_append = append; }
+
+int NetcdfStreamWriter::open(const std::vector<HmdfStreamStation> &stations) {
+  this->m_stations = stations;
+  const size_t n = this->m_stations.size();
+  this->m_varidDate.assign(n, -1);
+  this->m_varidData.assign(n, -1);
+  this->m_fileIndex.resize(n);
+  for (size_t i = 0; i < n; i++) this->m_fileIndex[i] = i;
+  this->m_rowStart.assign(n, 0);
+  this->m_lastDate.assign(n, std::numeric_limits<qint64>::min());
+  this->m_fillValue.assign(n, c_fillValue);
+  this->m_written.assign(n, 0);
+  this->m_lastTime.assign(n, std::numeric_limits<long long>::min());
+  this->m_sorted.assign(n, true);
+  this->m_varidRowSize = -1;
+
+  if (this->m_append && QFile::exists(this->m_filename))
+    return this->openArchive();
+
+  int ncid;
+  int ierr = nc_create(this->m_filename.toStdString().c_str(), NC_NETCDF4,
+                       &ncid);
+  if (ierr != NC_NOERR) return ierr;
+  this->m_ncid = ncid;
+
+  //...Dimensions
+  int dimid_nstations, dimid_stationNameLength;
+  NCCHECK(nc_def_dim(ncid, "numStations",
+                     this->m_append ? NC_UNLIMITED : this->m_stations.size(),
+                     &dimid_nstations));
+  NCCHECK(nc_def_dim(ncid, "stationNameLen", c_stationNameLength,
+                     &dimid_stationNameLength));
+
+  //...Variables
+  int stationNameDims[2] = {dimid_nstations, dimid_stationNameLength};
+  int nstationDims[1] = {dimid_nstations};
+  int wgs84[1] = {4326};
+
+  NCCHECK(nc_def_var(ncid, "stationName", NC_CHAR, 2, stationNameDims,
+                     &this->m_varidStationName));
+  NCCHECK(nc_def_var(ncid, "stationId", NC_CHAR, 2, stationNameDims,
+                     &this->m_varidStationId));
+  NCCHECK(nc_def_var(ncid, "stationXCoordinate", NC_DOUBLE, 1, nstationDims,
+                     &this->m_varidStationX));
+  NCCHECK(nc_def_var(ncid, "stationYCoordinate", NC_DOUBLE, 1, nstationDims,
+                     &this->m_varidStationY));
+
+  NCCHECK(nc_put_att_text(ncid, this->m_varidStationX,
+                          "HorizontalProjectionName", 5, "WGS84"));
+  NCCHECK(nc_put_att_text(ncid, this->m_varidStationY,
+                          "HorizontalProjectionName", 5, "WGS84"));
+
+  NCCHECK(nc_put_att_int(ncid, this->m_varidStationX,
+                         "HorizontalProjectionEPSG", NC_INT, 1, wgs84));
+  NCCHECK(nc_put_att_int(ncid, this->m_varidStationY,
+                         "HorizontalProjectionEPSG", NC_INT, 1, wgs84));
+
+  ierr = this->m_layout == RaggedArray && !this->m_append
+             ? this->defineRaggedArray(dimid_nstations)
+             : this->defineStationVariables();
+  if (ierr != NC_NOERR) return ierr;
+
+  //...Metadata
+  QString user = qgetenv("USER");
+  if (user.isEmpty()) user = qgetenv("USERNAME");
+  QString host = QHostInfo::localHostName();
+  QString createTime =
+      QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
+  QString source = "MetOceanViewer";
+  QString ncVersion = QString(nc_inq_libvers());
+  QString format = "20180123";
+
+  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "source", NC_CHAR, source.length(),
+                     source.toStdString().c_str()));
+  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "creation_date", NC_CHAR,
+                     createTime.length(), createTime.toStdString().c_str()));
+  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "created_by", NC_CHAR, user.length(),
+                     user.toStdString().c_str()));
+  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "host", NC_CHAR, host.length(),
+                     host.toStdString().c_str()));
+  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "netCDF_version", NC_CHAR,
+                     ncVersion.length(), ncVersion.toStdString().c_str()));
+  NCCHECK(nc_put_att(ncid, NC_GLOBAL, "fileformat", NC_CHAR, format.length(),
+                     format.toStdString().c_str()));
+
+  NCCHECK(nc_enddef(ncid));
+
+  return this->writeDirectory();
+}
+
+int NetcdfStreamWriter::defineStationVariables() {
+  for (size_t i = 0; i < this->m_stations.size(); i++) {
+    int ierr = this->defineStation(i);
+    if (ierr != NC_NOERR) return ierr;
+  }
+  return NC_NOERR;
+}
+
+//...Defines the dimension and time/data variables of one station under
+//   its index in the file. In append mode the dimension is unlimited
+int NetcdfStreamWriter::defineStation(size_t index) {
+  int ncid = this->m_ncid;
+  std::string units = this->m_units.toStdString();
+  std::string datum = this->m_datum.toStdString();
+
+  const int fileIndex = static_cast<int>(this->m_fileIndex[index] + 1);
+  const size_t length = this->m_stations[index].length;
+  QString stationName, timeVarName, dataVarName, dimname;
+  int d[1];
+  char epoch[20] = "1970-01-01 00:00:00";
+  char utc[4] = "utc";
+  char timeunit[27] = "second since referenceDate";
+  int v;
+
+  std::string name = this->m_stations[index].name.toStdString();
+  std::string id = this->m_stations[index].id.toStdString();
+
+  dimname.sprintf("%s%4.4i", "stationLength_", fileIndex);
+  NCCHECK(nc_def_dim(ncid, dimname.toStdString().c_str(),
+                     this->m_append ? NC_UNLIMITED : length, &d[0]));
+  const std::vector<size_t> shape(1, length);
+
+  stationName.sprintf("%s%4.4i", "station_", fileIndex);
+  timeVarName = "time_" + stationName;
+  dataVarName = "data_" + stationName;
+
+  NCCHECK(nc_def_var(ncid, timeVarName.toStdString().c_str(), NC_INT64, 1, d,
+                     &v));
+  NCCHECK(nc_put_att_text(ncid, v, "StationName", name.size(), name.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "StationID", id.size(), id.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "referenceDate", 20, epoch));
+  NCCHECK(nc_put_att_text(ncid, v, "timezone", 3, utc));
+  NCCHECK(nc_put_att_text(ncid, v, "units", 3, timeunit));
+  NCCHECK(this->m_profile.apply(ncid, v, shape, this->m_append));
+  this->m_varidDate[index] = v;
+
+  NCCHECK(nc_def_var(ncid, dataVarName.toStdString().c_str(), NC_DOUBLE, 1, d,
+                     &v));
+  NCCHECK(nc_put_att_text(ncid, v, "StationName", name.size(), name.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "StationID", id.size(), id.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "units", units.size(), units.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "datum", datum.size(), datum.c_str()));
+  NCCHECK(nc_def_var_fill(ncid, v, 0, &c_fillValue));
+  NCCHECK(this->m_profile.apply(ncid, v, shape, this->m_append));
+  this->m_varidData[index] = v;
+
+  return NC_NOERR;
+}
+
+//...Opens an existing file for appending. Records of a station that is
+//   already in the file continue after its last record. Stations that are
+//   not in the file are added after the existing ones. Both need unlimited
+//   dimensions, so only files created in append mode can grow. Any other
+//   file fails with NC_EDIMSIZE before anything is written
+int NetcdfStreamWriter::openArchive() {
+  int ncid;
+  int ierr = nc_open(this->m_filename.toStdString().c_str(), NC_WRITE, &ncid);
+  if (ierr != NC_NOERR) return ierr;
+  this->m_ncid = ncid;
+
+  //...A contiguous ragged array cannot grow without rewriting the file
+  int varid_rowSize;
+  if (nc_inq_varid(ncid, "rowSize", &varid_rowSize) == NC_NOERR) {
+    this->close();
+    return NC_EINVAL;
+  }
+
+  int dimid_nstations, dimid_nameLength;
+  size_t numStations, nameLength;
+  NCCHECK(nc_inq_dimid(ncid, "numStations", &dimid_nstations));
+  NCCHECK(nc_inq_dimlen(ncid, dimid_nstations, &numStations));
+  NCCHECK(nc_inq_dimid(ncid, "stationNameLen", &dimid_nameLength));
+  NCCHECK(nc_inq_dimlen(ncid, dimid_nameLength, &nameLength));
+  NCCHECK(nc_inq_varid(ncid, "stationName", &this->m_varidStationName));
+  NCCHECK(nc_inq_varid(ncid, "stationId", &this->m_varidStationId));
+  NCCHECK(nc_inq_varid(ncid, "stationXCoordinate", &this->m_varidStationX));
+  NCCHECK(nc_inq_varid(ncid, "stationYCoordinate", &this->m_varidStationY));
+
+  std::string names(numStations * nameLength, ' ');
+  std::string ids(numStations * nameLength, ' ');
+  if (numStations > 0) {
+    NCCHECK(nc_get_var_text(ncid, this->m_varidStationName, &names[0]));
+    NCCHECK(nc_get_var_text(ncid, this->m_varidStationId, &ids[0]));
+  }
+
+  //...Two stations with the same key on either side cannot be told apart.
+  //   Matching them would write both into one slot, so this is an error
+  QHash<QString, size_t> byKey;
+  for (size_t j = 0; j < numStations; j++) {
+    QString key = stationKey(directoryString(ids, j, nameLength),
+                             directoryString(names, j, nameLength));
+    if (byKey.contains(key)) {
+      this->close();
+      return NC_EINVAL;
+    }
+    byKey.insert(key, j);
+  }
+
+  std::vector<QString> keys(this->m_stations.size());
+  QSet<QString> incoming;
+  for (size_t i = 0; i < this->m_stations.size(); i++) {
+    keys[i] = stationKey(this->m_stations[i].id.left(nameLength).trimmed(),
+                         this->m_stations[i].name.left(nameLength).trimmed());
+    if (incoming.contains(keys[i])) {
+      this->close();
+      return NC_EINVAL;
+    }
+    incoming.insert(keys[i]);
+  }
+
+  //...Only unlimited dimensions can grow. Files written without append
+  //   have fixed ones, so they are rejected here before anything is written
+  int nunlimited;
+  NCCHECK(nc_inq_unlimdims(ncid, &nunlimited, nullptr));
+  std::vector<int> unlimited(nunlimited);
+  if (nunlimited > 0)
+    NCCHECK(nc_inq_unlimdims(ncid, &nunlimited, unlimited.data()));
+
+  std::vector<size_t> added;
+  size_t next = numStations;
+  for (size_t i = 0; i < this->m_stations.size(); i++) {
+    const bool found = byKey.contains(keys[i]);
+    const size_t j = byKey.value(keys[i]);
+
+    if (!found) {
+      this->m_fileIndex[i] = next++;
+      added.push_back(i);
+      continue;
+    }
+
+    this->m_fileIndex[i] = j;
+    QString suffix;
+    suffix.sprintf("%4.4i", static_cast<int>(j + 1));
+    int dimid_length;
+    size_t length;
+    NCCHECK(nc_inq_varid(ncid,
+                         ("time_station_" + suffix).toStdString().c_str(),
+                         &this->m_varidDate[i]));
+    NCCHECK(nc_inq_varid(ncid,
+                         ("data_station_" + suffix).toStdString().c_str(),
+                         &this->m_varidData[i]));
+    NCCHECK(nc_inq_dimid(ncid,
+                         ("stationLength_" + suffix).toStdString().c_str(),
+                         &dimid_length));
+    if (std::find(unlimited.begin(), unlimited.end(), dimid_length) ==
+        unlimited.end()) {
+      this->close();
+      return NC_EDIMSIZE;
+    }
+    NCCHECK(nc_inq_dimlen(ncid, dimid_length, &length));
+    NCCHECK(nc_inq_var_fill(ncid, this->m_varidData[i], nullptr,
+                            &this->m_fillValue[i]));
+    if (this->m_fillValue[i] == NC_FILL_DOUBLE)
+      this->m_fillValue[i] = c_fillValue;
+
+    //...Records are appended in time order, so the last record of the
+    //   station holds its latest time
+    this->m_rowStart[i] = length;
+    if (length > 0) {
+      size_t last = length - 1;
+      long long t;
+      NCCHECK(nc_get_var1_longlong(ncid, this->m_varidDate[i], &last, &t));
+      this->m_lastDate[i] = static_cast<qint64>(t) * 1000;
+      this->m_lastTime[i] = t;
+
+      //...Files without the attribute are treated as unsorted
+      int sorted = 0;
+      if (nc_get_att_int(ncid, this->m_varidDate[i], c_sortedAttribute,
+                         &sorted) != NC_NOERR)
+        sorted = 0;
+      this->m_sorted[i] = sorted == 1;
+    }
+  }
+
+  if (added.empty()) return NC_NOERR;
+
+  if (std::find(unlimited.begin(), unlimited.end(), dimid_nstations) ==
+      unlimited.end()) {
+    this->close();
+    return NC_EDIMSIZE;
+  }
+
+  NCCHECK(nc_redef(ncid));
+  for (size_t k = 0; k < added.size(); k++) {
+    ierr = this->defineStation(added[k]);
+    if (ierr != NC_NOERR) return ierr;
+  }
+  NCCHECK(nc_enddef(ncid));
+
+  for (size_t k = 0; k < added.size(); k++) {
+    ierr = this->writeDirectoryEntry(added[k]);
+    if (ierr != NC_NOERR) return ierr;
+  }
+  return NC_NOERR;
+}
+
+//...CF-1.6 contiguous ragged array (H.2.4). Station i occupies
+//   [rowStart[i], rowStart[i] + rowSize[i]) of the numObs dimension
+int NetcdfStreamWriter::defineRaggedArray(int dimid_nstations) {
+  int ncid = this->m_ncid;
+  std::string units = this->m_units.toStdString();
+  std::string datum = this->m_datum.toStdString();
+
+  size_t total = 0, longest = 0;
+  this->m_rowStart.resize(this->m_stations.size());
+  for (size_t i = 0; i < this->m_stations.size(); i++) {
+    this->m_rowStart[i] = total;
+    total += this->m_stations[i].length;
+    longest = std::max(longest, this->m_stations[i].length);
+  }
+
+  //...Rows do not line up with chunks here, so station sized chunks are
+  //   sized to the longest station
+  NetcdfWriteProfile profile(this->m_profile);
+  profile.setMaxChunkLength(std::min(profile.maxChunkLength(), longest));
+  const std::vector<size_t> shape(1, total);
+
+  //...A zero length dimension would be unlimited
+  int dimid_obs;
+  NCCHECK(nc_def_dim(ncid, "numObs", total > 0 ? total : NC_UNLIMITED,
+                     &dimid_obs));
+
+  const char *epoch = "1970-01-01 00:00:00";
+  const char *timeunit = "seconds since 1970-01-01 00:00:00";
+  const char *coordinates = "time stationYCoordinate stationXCoordinate";
+  int nstationDims[1] = {dimid_nstations};
+  int obsDims[1] = {dimid_obs};
+  int v;
+
+  NCCHECK(nc_def_var(ncid, "rowSize", NC_INT64, 1, nstationDims, &v));
+  const char *rowSizeName = "number of observations for this station";
+  NCCHECK(nc_put_att_text(ncid, v, "long_name", strlen(rowSizeName),
+                          rowSizeName));
+  NCCHECK(nc_put_att_text(ncid, v, "sample_dimension", 6, "numObs"));
+  this->m_varidRowSize = v;
+
+  NCCHECK(nc_put_att_text(ncid, this->m_varidStationName, "cf_role", 13,
+                          "timeseries_id"));
+  NCCHECK(nc_put_att_text(ncid, this->m_varidStationX, "standard_name", 9,
+                          "longitude"));
+  NCCHECK(nc_put_att_text(ncid, this->m_varidStationY, "standard_name", 8,
+                          "latitude"));
+
+  NCCHECK(nc_def_var(ncid, "time", NC_INT64, 1, obsDims, &v));
+  NCCHECK(nc_put_att_text(ncid, v, "standard_name", 4, "time"));
+  NCCHECK(nc_put_att_text(ncid, v, "units", strlen(timeunit), timeunit));
+  NCCHECK(nc_put_att_text(ncid, v, "calendar", 8, "standard"));
+  NCCHECK(nc_put_att_text(ncid, v, "referenceDate", 19, epoch));
+  NCCHECK(nc_put_att_text(ncid, v, "timezone", 3, "utc"));
+  NCCHECK(profile.apply(ncid, v, shape));
+  this->m_varidDate.assign(1, v);
+
+  NCCHECK(nc_def_var(ncid, "data", NC_DOUBLE, 1, obsDims, &v));
+  NCCHECK(nc_put_att_text(ncid, v, "units", units.size(), units.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "datum", datum.size(), datum.c_str()));
+  NCCHECK(nc_put_att_text(ncid, v, "coordinates", strlen(coordinates),
+                          coordinates));
+  NCCHECK(nc_def_var_fill(ncid, v, 0, &c_fillValue));
+  NCCHECK(profile.apply(ncid, v, shape));
+  this->m_varidData.assign(1, v);
+
+  NCCHECK(nc_put_att_text(ncid, NC_GLOBAL, "Conventions", 6, "CF-1.6"));
+  NCCHECK(nc_put_att_text(ncid, NC_GLOBAL, "featureType", 10, "timeSeries"));
+
+  return NC_NOERR;
+}
+
+int NetcdfStreamWriter::writeDirectory() {
+  for (size_t i = 0; i < this->m_stations.size(); i++) {
+    int ierr = this->writeDirectoryEntry(i);
+    if (ierr != NC_NOERR) return ierr;
+  }
+
+  if (this->m_varidRowSize >= 0 && !this->m_stations.empty()) {
+    std::vector<long long> rowSize(this->m_stations.size());
+    for (size_t i = 0; i < this->m_stations.size(); i++) {
+      rowSize[i] = static_cast<long long>(this->m_stations[i].length);
+    }
+    NCCHECK(nc_put_var_longlong(this->m_ncid, this->m_varidRowSize,
+                                rowSize.data()));
+  }
+  return 0;
+}
+
+int NetcdfStreamWriter::writeDirectoryEntry(size_t index) {
+  int ncid = this->m_ncid;
+  const size_t i = this->m_fileIndex[index];
+  size_t nameIndex[2] = {i, 0};
+  size_t stindex[1] = {i};
+  size_t count[2] = {1, c_stationNameLength};
+  double lat[1] = {this->m_stations[index].latitude};
+  double lon[1] = {this->m_stations[index].longitude};
+
+  //...Names are padded (or cut) to the fixed name length
+  std::string name = this->m_stations[index].name.toStdString();
+  std::string id = this->m_stations[index].id.toStdString();
+  name.resize(c_stationNameLength, ' ');
+  id.resize(c_stationNameLength, ' ');
+
+  NCCHECK(nc_put_var1_double(ncid, this->m_varidStationX, stindex, lon));
+  NCCHECK(nc_put_var1_double(ncid, this->m_varidStationY, stindex, lat));
+  NCCHECK(nc_put_vara_text(ncid, this->m_varidStationName, nameIndex, count,
+                           &name[0]));
+  NCCHECK(nc_put_vara_text(ncid, this->m_varidStationId, nameIndex, count,
+                           &id[0]));
+  return 0;
+}
+
+int NetcdfStreamWriter::beginStation(size_t index) {
+  if (index >= this->m_stations.size()) return NC_EINVALCOORDS;
+  this->m_current = index;
+  return 0;
+}
+
+int NetcdfStreamWriter::write(const qint64 *date, const double *data,
+                              size_t n) {
+  int ierr =
+      this->prepare(this->m_current, date, data, n, this->m_buffer);
+  if (ierr != 0) return ierr;
+  return this->commit(this->m_buffer);
+}
+
+//...Converts dates to seconds and missing values to the fill value of the
+//   file. When appending, records that are not newer than the file are
+//   dropped
+int NetcdfStreamWriter::prepare(size_t index, const qint64 *date,
+                                const double *data, size_t n,
+                                StationBuffer &buffer) const {
+  if (index >= this->m_stations.size()) return NC_EINVALCOORDS;
+  buffer.index = index;
+  buffer.time.clear();
+  buffer.data.clear();
+
+  const qint64 lastDate = this->m_lastDate[index];
+  const double nullValue = this->m_stations[index].nullValue;
+  const double fillValue = this->m_fillValue[index];
+
+  size_t first = 0;
+  if (lastDate != std::numeric_limits<qint64>::min()) {
+    while (first < n && date[first] <= lastDate) ++first;
+  }
+  buffer.time.reserve(n - first);
+  buffer.data.reserve(n - first);
+  for (size_t i = first; i < n; i++) {
+    if (date[i] <= lastDate) continue;
+    const double v = data[i];
+    buffer.time.push_back(date[i] / 1000);
+    buffer.data.push_back(v == nullValue || !std::isfinite(v) ? fillValue
+                                                              : v);
+  }
+  return 0;
+}
+
+//...Writes a prepared buffer after the records already written for its
+//   station. The ragged layout has a single variable pair where records
+//   start at the row start of the station; when appending they start
+//   after the records already in the file
+int NetcdfStreamWriter::commit(const StationBuffer &buffer) {
+  const size_t index = buffer.index;
+  const size_t n = buffer.time.size();
+  if (index >= this->m_stations.size()) return NC_EINVALCOORDS;
+  if (n == 0) return 0;
+  if (this->m_written[index] + n > this->m_stations[index].length)
+    return NC_EEDGE;
+
+  //...Keep track of whether the station's stored times stay in order
+  if (this->m_sorted[index]) {
+    this->m_sorted[index] =
+        buffer.time.front() >= this->m_lastTime[index] &&
+        std::is_sorted(buffer.time.begin(), buffer.time.end());
+  }
+  this->m_lastTime[index] = buffer.time.back();
+
+  const bool ragged = this->m_layout == RaggedArray && !this->m_append;
+  const size_t var = ragged ? 0 : index;
+  size_t start[1] = {this->m_rowStart[index] + this->m_written[index]};
+  size_t count[1] = {n};
+  NCCHECK(nc_put_vara_longlong(this->m_ncid, this->m_varidDate[var], start,
+                               count, buffer.time.data()));
+  NCCHECK(nc_put_vara_double(this->m_ncid, this->m_varidData[var], start,
+                             count, buffer.data.data()));
+  this->m_written[index] += n;
+  return 0;
+}
+
+int NetcdfStreamWriter::endStation() { return 0; }
+
+int NetcdfStreamWriter::close() {
+  if (this->m_ncid < 0) return 0;
+  int ierr = this->writeSortedAttributes();
+  int ierrClose = nc_close(this->m_ncid);
+  this->m_ncid = -1;
+  return ierr != NC_NOERR ? ierr : ierrClose;
+}
+
+//...Sets the sorted attribute of every time variable written to. A fixed
+//   length station that was not written in full still holds fill values
+//   and is not sorted. The ragged layout has one time variable, which is
+//   only sorted if every row is. Called from close(), so it cannot use
+//   NCCHECK
+int NetcdfStreamWriter::writeSortedAttributes() {
+  const size_t n = this->m_stations.size();
+  const bool ragged = this->m_layout == RaggedArray && !this->m_append;
+  if (n == 0 || this->m_varidDate.size() != (ragged ? 1 : n))
+    return NC_NOERR;
+
+  int ierr = nc_redef(this->m_ncid);
+  if (ierr != NC_NOERR) return ierr;
+
+  int all = 1;
+  for (size_t i = 0; i < n && ierr == NC_NOERR; i++) {
+    const bool complete = this->m_append ||
+                          this->m_written[i] == this->m_stations[i].length;
+    const int sorted = this->m_sorted[i] && complete ? 1 : 0;
+    all = all && sorted;
+    if (!ragged && this->m_varidDate[i] >= 0) {
+      ierr = nc_put_att_int(this->m_ncid, this->m_varidDate[i],
+                            c_sortedAttribute, NC_INT, 1, &sorted);
+    }
+  }
+  if (ragged && ierr == NC_NOERR && this->m_varidDate[0] >= 0) {
+    ierr = nc_put_att_int(this->m_ncid, this->m_varidDate[0],
+                          c_sortedAttribute, NC_INT, 1, &all);
+  }
+
+  int ierrEnd = nc_enddef(this->m_ncid);
+  return ierr != NC_NOERR ? ierr : ierrEnd;
+}
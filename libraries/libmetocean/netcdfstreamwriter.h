@@ -0,0 +1,128 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef NETCDFSTREAMWRITER_H
+#define NETCDFSTREAMWRITER_H
+
+#include <vector>
+#include "hmdfstreamwriter.h"
+#include "netcdfwriteprofile.h"
+
+//...Writes the MetOceanViewer netCDF station format incrementally. The
+//   station directory passed to open() fixes the length of every station
+//   so that chunks can be written with hyperslab puts as they arrive.
+//
+//   Two layouts are available. StationVariables is the original format
+//   with a dimension and a time/data variable pair per station.
+//   RaggedArray is the CF discrete sampling geometry contiguous ragged
+//   array: one time and one data variable holding all stations back to
+//   back, and a rowSize variable with the number of samples per station.
+//   Its metadata does not grow with the number of stations.
+//
+//   Compression and chunking of the time and data variables follow the
+//   write profile (see NetcdfWriteProfile).
+//
+//   With append set, open() adds to an existing file instead of replacing
+//   it. Stations are matched by id, or by name when the id is empty or the
+//   "noid" placeholder. Records that are not newer than the last record
+//   of the station in the file are skipped and stations not yet in the
+//   file are added. If two stations share a key, in the file or in the
+//   stations being written, open() fails with NC_EINVAL. Files created in
+//   append mode use unlimited dimensions so that they can keep growing.
+//   Only those files can be appended to. Opening a file written without
+//   append fails with NC_EDIMSIZE before anything is written.
+//   Only the StationVariables layout can be appended to.
+//
+//   close() marks every time variable with an integer "sorted" attribute,
+//   1 when its values were written in order, so that windowed reads can
+//   bisect the time axis (see NetcdfTimeseries).
+//
+//   write() is prepare() followed by commit(). The two can also be called
+//   directly: prepare() only reads state fixed by open() and may run on
+//   any number of threads at once, while commit() calls into the netCDF
+//   library and must stay on one thread. Buffers of different stations
+//   can be committed in any order
+class NetcdfStreamWriter : public HmdfStreamWriter {
+ public:
+  enum Layout { StationVariables, RaggedArray };
+
+  //...Records of one station converted to the stored representation
+  struct StationBuffer {
+    size_t index;
+    std::vector<long long> time;
+    std::vector<double> data;
+
+    StationBuffer() : index(0) {}
+  };
+
+  NetcdfStreamWriter(const QString &filename, const QString &datum,
+                     const QString &units);
+  ~NetcdfStreamWriter() override;
+
+  Layout layout() const;
+  void setLayout(Layout layout);
+
+  NetcdfWriteProfile profile() const;
+  void setProfile(const NetcdfWriteProfile &profile);
+
+  bool append() const;
+  void setAppend(bool append);
+
+  int open(const std::vector<HmdfStreamStation> &stations) override;
+  int beginStation(size_t index) override;
+  int write(const qint64 *date, const double *data, size_t n) override;
+  int endStation() override;
+  int close() override;
+
+  int prepare(size_t index, const qint64 *date, const double *data,
+              size_t n, StationBuffer &buffer) const;
+  int commit(const StationBuffer &buffer);
+
+ private:
+  int openArchive();
+  int defineStationVariables();
+  int defineStation(size_t index);
+  int defineRaggedArray(int dimid_nstations);
+  int writeDirectory();
+  int writeDirectoryEntry(size_t index);
+  int writeSortedAttributes();
+
+  Layout m_layout;
+  NetcdfWriteProfile m_profile;
+  bool m_append;
+  int m_ncid;
+  int m_varidStationName;
+  int m_varidStationId;
+  int m_varidStationX;
+  int m_varidStationY;
+  int m_varidRowSize;
+  std::vector<int> m_varidDate;
+  std::vector<int> m_varidData;
+  std::vector<size_t> m_fileIndex;
+  std::vector<size_t> m_rowStart;
+  std::vector<qint64> m_lastDate;
+  std::vector<double> m_fillValue;
+  std::vector<size_t> m_written;
+  std::vector<long long> m_lastTime;
+  std::vector<bool> m_sorted;
+  size_t m_current;
+  StationBuffer m_buffer;
+};
+
+#endif  // NETCDFSTREAMWRITER_H
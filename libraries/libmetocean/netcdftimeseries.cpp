@@ -18,9 +18,13 @@
 //
 //-----------------------------------------------------------------------*/
 #include "netcdftimeseries.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <string>
 #include "boost/format.hpp"
 #include "netcdf.h"
+#include "timeconversion.h"
 
 #define NCCHECK(ierr)     \
   if (ierr != NC_NOERR) { \
@@ -28,6 +32,120 @@
     return ierr;          \
   }
 
+namespace {
+
+//...Reads one station of a generic netCDF file the first time the station
+//   is used. The file is opened for each station so that nothing is held
+//   open while the data sits unused
+class NetcdfStationLoader : public HmdfStationLoader {
+ public:
+  NetcdfStationLoader(const QString &filename, size_t station,
+                      qint64 startDate, qint64 endDate)
+      : m_filename(filename),
+        m_station(station),
+        m_ragged(false),
+        m_rowStart(0),
+        m_rowSize(0),
+        m_startDate(startDate),
+        m_endDate(endDate) {}
+
+  NetcdfStationLoader(const QString &filename, size_t rowStart,
+                      size_t rowSize, qint64 startDate, qint64 endDate)
+      : m_filename(filename),
+        m_station(0),
+        m_ragged(true),
+        m_rowStart(rowStart),
+        m_rowSize(rowSize),
+        m_startDate(startDate),
+        m_endDate(endDate) {}
+
+  int load(HmdfStation *station) override {
+    int ncid;
+    int ierr = nc_open(this->m_filename.toStdString().c_str(), NC_NOWRITE,
+                       &ncid);
+    if (ierr != NC_NOERR) return ierr;
+
+    QVector<qint64> time;
+    QVector<double> data;
+    if (this->m_ragged) {
+      ierr = NetcdfTimeseries::readRaggedStation(
+          ncid, this->m_rowStart, this->m_rowSize, this->m_startDate,
+          this->m_endDate, time, data);
+    } else {
+      ierr = NetcdfTimeseries::readStation(ncid, this->m_station,
+                                           this->m_startDate,
+                                           this->m_endDate, time, data);
+    }
+    nc_close(ncid);
+    if (ierr != NC_NOERR) return ierr;
+
+    station->setDate(time);
+    station->setData(data);
+    return 0;
+  }
+
+ private:
+  QString m_filename;
+  size_t m_station;
+  bool m_ragged;
+  size_t m_rowStart;
+  size_t m_rowSize;
+  qint64 m_startDate;
+  qint64 m_endDate;
+};
+
+qint64 floorDiv(qint64 a, qint64 b) {
+  qint64 q = a / b;
+  if ((a % b != 0) && ((a < 0) != (b < 0))) --q;
+  return q;
+}
+
+//...Offsets are clamped well inside the qint64 range so that the window
+//   arithmetic cannot overflow
+qint64 clampOffset(qint64 value) {
+  const qint64 limit = std::numeric_limits<qint64>::max() / 4;
+  return std::max(-limit, std::min(limit, value));
+}
+
+//...True when NetcdfStreamWriter marked the time variable as written in
+//   order. Files without the attribute are scanned instead
+bool markedSorted(int ncid, int varid) {
+  int sorted = 0;
+  return nc_get_att_int(ncid, varid, "sorted", &sorted) == NC_NOERR &&
+         sorted == 1;
+}
+
+int getTime(int ncid, int varid, const size_t *index, long long *value) {
+  return nc_get_var1_longlong(ncid, varid, index, value);
+}
+
+int getTime(int ncid, int varid, const size_t *index, double *value) {
+  return nc_get_var1_double(ncid, varid, index, value);
+}
+
+//...Bisection over [first, last) of a sorted time variable, starting at
+//   offset, reading one value per step. Gives the first position whose
+//   value is not less than key, or with upper set, greater than key
+template <typename T>
+int bisectTime(int ncid, int varid, size_t offset, size_t first, size_t last,
+               T key, bool upper, size_t &position) {
+  while (first < last) {
+    const size_t mid = first + (last - first) / 2;
+    const size_t index = offset + mid;
+    T value;
+    int ierr = getTime(ncid, varid, &index, &value);
+    if (ierr != NC_NOERR) return ierr;
+    if (upper ? !(key < value) : value < key)
+      first = mid + 1;
+    else
+      last = mid;
+  }
+  position = first;
+  return NC_NOERR;
+}
+
+}  // namespace
+
 NetcdfTimeseries::NetcdfTimeseries(QObject *parent) : QObject(parent) {
   this->m_filename = QString();
   this->m_epsg = 4326;
@@ -35,6 +153,8 @@ NetcdfTimeseries::NetcdfTimeseries(QObject *parent) : QObject(parent) {
   this->m_verticalDatum = "unknown";
   this->m_horizontalProjection = "WGS84";
   this->m_numStations = 0;
+  this->m_ragged = false;
+  this->clearSelection();
 }
 
 QString NetcdfTimeseries::filename() const { return this->m_filename; }
@@ -47,13 +167,84 @@ int NetcdfTimeseries::epsg() const { return this->m_epsg; }
 
 void NetcdfTimeseries::setEpsg(int epsg) { this->m_epsg = epsg; }
 
-int NetcdfTimeseries::read() {
+void NetcdfTimeseries::setStations(const std::vector<size_t> &stations) {
+  this->m_filterIndex = stations;
+}
+
+void NetcdfTimeseries::setStations(const QStringList &names) {
+  this->m_filterName = names;
+}
+
+void NetcdfTimeseries::setBoundingBox(double xmin, double ymin, double xmax,
+                                      double ymax) {
+  this->m_useBoundingBox = true;
+  this->m_bbox[0] = xmin;
+  this->m_bbox[1] = ymin;
+  this->m_bbox[2] = xmax;
+  this->m_bbox[3] = ymax;
+}
+
+void NetcdfTimeseries::setTimeWindow(qint64 startDate, qint64 endDate) {
+  this->m_startDate = startDate;
+  this->m_endDate = endDate;
+}
+
+void NetcdfTimeseries::clearSelection() {
+  this->m_filterIndex.clear();
+  this->m_filterName.clear();
+  this->m_useBoundingBox = false;
+  this->m_startDate = std::numeric_limits<qint64>::min();
+  this->m_endDate = std::numeric_limits<qint64>::max();
+}
+
+size_t NetcdfTimeseries::numStations() const { return this->m_numStations; }
+
+size_t NetcdfTimeseries::numSelected() const { return this->m_selected.size(); }
+
+bool NetcdfTimeseries::isRaggedArray() const { return this->m_ragged; }
+
+void NetcdfTimeseries::select() {
+  std::vector<char> use(this->m_numStations, 1);
+
+  if (!this->m_filterIndex.empty()) {
+    std::vector<char> listed(this->m_numStations, 0);
+    for (size_t i : this->m_filterIndex) {
+      if (i < this->m_numStations) listed[i] = 1;
+    }
+    for (size_t i = 0; i < this->m_numStations; ++i) use[i] &= listed[i];
+  }
+
+  if (!this->m_filterName.isEmpty()) {
+    for (size_t i = 0; i < this->m_numStations; ++i) {
+      if (!this->m_filterName.contains(this->m_stationName[i])) use[i] = 0;
+    }
+  }
+
+  if (this->m_useBoundingBox) {
+    for (size_t i = 0; i < this->m_numStations; ++i) {
+      if (this->m_xcoor[i] < this->m_bbox[0] ||
+          this->m_xcoor[i] > this->m_bbox[2] ||
+          this->m_ycoor[i] < this->m_bbox[1] ||
+          this->m_ycoor[i] > this->m_bbox[3])
+        use[i] = 0;
+    }
+  }
+
+  this->m_selected.clear();
+  for (size_t i = 0; i < this->m_numStations; ++i) {
+    if (use[i]) this->m_selected.push_back(i);
+  }
+}
+
+//...Reads the station table (names, coordinates, lengths, fill values)
+//   without touching any of the timeseries and applies the selection
+int NetcdfTimeseries::readMetadata() {
   if (this->m_filename == QString()) return 1;
 
   size_t stationNameLength, length;
   int ierr, ncid;
   int dimid_nstations, dimidStationLength, dimid_stationNameLen;
-  int varid_time, varid_data, varid_xcoor, varid_ycoor, varid_stationName;
+  int varid_data, varid_xcoor, varid_ycoor, varid_stationName;
   int epsg;
   NCCHECK(nc_open(this->m_filename.toStdString().c_str(), NC_NOWRITE, &ncid));
   NCCHECK(nc_inq_dimid(ncid, "numStations", &dimid_nstations));
@@ -86,72 +277,307 @@ int NetcdfTimeseries::read() {
       std::string((stationNameLength + 1) * this->m_numStations, ' ');
 
   NCCHECK(nc_get_var_text(ncid, varid_stationName, &stationName[0]));
+  this->m_stationName.clear();
   for (size_t i = 0; i < this->m_numStations; i++) {
-    QString s = QByteArray::fromStdString(stationName.substr(200 * i, 200))
+    QString s = QByteArray::fromStdString(stationName.substr(
+                                              stationNameLength * i,
+                                              stationNameLength))
                     .simplified();
     this->m_stationName.push_back(s);
   }
 
-  this->m_time.resize(this->m_numStations);
-  this->m_data.resize(this->m_numStations);
+  this->m_stationLength.clear();
+  this->m_rowStart.clear();
+  this->m_fillValue.clear();
+
+  int varid_rowSize;
+  this->m_ragged = nc_inq_varid(ncid, "rowSize", &varid_rowSize) == NC_NOERR;
+  if (this->m_ragged) {
+    std::vector<long long> rowSize(this->m_numStations);
+    if (this->m_numStations > 0)
+      NCCHECK(nc_get_var_longlong(ncid, varid_rowSize, rowSize.data()));
+    NCCHECK(nc_inq_varid(ncid, "data", &varid_data));
+    double fillValue;
+    NCCHECK(nc_inq_var_fill(ncid, varid_data, NULL, &fillValue));
+    if (fillValue == NC_FILL_DOUBLE) fillValue = -99999.0;
 
-  for (size_t i = 0; i < this->m_numStations; i++) {
+    size_t start = 0;
+    for (size_t i = 0; i < this->m_numStations; i++) {
+      this->m_rowStart.push_back(start);
+      this->m_stationLength.push_back(static_cast<size_t>(rowSize[i]));
+      this->m_fillValue.push_back(fillValue);
+      start += static_cast<size_t>(rowSize[i]);
+    }
+  }
+
+  for (size_t i = 0; i < this->m_numStations && !this->m_ragged; i++) {
     auto station_dim_string =
         boost::str(boost::format("stationLength_%04i") % (i + 1));
-    auto station_time_var_string =
-        boost::str(boost::format("time_station_%04i") % (i + 1));
     auto station_data_var_string =
         boost::str(boost::format("data_station_%04i") % (i + 1));
 
     NCCHECK(
         nc_inq_dimid(ncid, station_dim_string.c_str(), &dimidStationLength));
-
     NCCHECK(nc_inq_dimlen(ncid, dimidStationLength, &length));
     this->m_stationLength.push_back(length);
 
-    NCCHECK(nc_inq_varid(ncid, station_time_var_string.c_str(), &varid_time));
-
     NCCHECK(nc_inq_varid(ncid, station_data_var_string.c_str(), &varid_data));
 
-    std::string timeStdString(80,' ');
-    NCCHECK(nc_get_att_text(ncid, varid_time, "referenceDate", &timeStdString[0]));
-    QString timeString = QString::fromStdString(timeStdString.substr(0, 19));
-    QDateTime refTime = QDateTime::fromString(timeString, "yyyy-MM-dd hh:mm:ss");
-    refTime.setTimeSpec(Qt::UTC);
-
     double fillValue;
     NCCHECK(nc_inq_var_fill(ncid, varid_data, NULL, &fillValue));
     if (fillValue == NC_FILL_DOUBLE) fillValue = -99999.0;
     this->m_fillValue.push_back(fillValue);
+  }
+
+  NCCHECK(nc_close(ncid));
+
+  this->select();
+
+  return 0;
+}
+
+int NetcdfTimeseries::read() {
+  int ierr = this->readMetadata();
+  if (ierr != 0) return ierr;
 
-    std::vector<qint64> timeData(length);
-    std::vector<double> varData(length);
+  int ncid;
+  NCCHECK(nc_open(this->m_filename.toStdString().c_str(), NC_NOWRITE, &ncid));
 
-    ierr = nc_get_var_double(ncid, varid_data, varData.data());
+  this->m_time.resize(this->m_selected.size());
+  this->m_data.resize(this->m_selected.size());
+
+  for (size_t k = 0; k < this->m_selected.size(); k++) {
+    const size_t i = this->m_selected[k];
+    if (this->m_ragged) {
+      ierr = NetcdfTimeseries::readRaggedStation(
+          ncid, this->m_rowStart[i], this->m_stationLength[i],
+          this->m_startDate, this->m_endDate, this->m_time[k],
+          this->m_data[k]);
+    } else {
+      ierr = NetcdfTimeseries::readStation(ncid, i, this->m_startDate,
+                                           this->m_endDate, this->m_time[k],
+                                           this->m_data[k]);
+    }
     if (ierr != NC_NOERR) {
       nc_close(ncid);
       return ierr;
     }
+  }
 
-    ierr = nc_get_var_longlong(ncid, varid_time, timeData.data());
-    if (ierr != NC_NOERR) {
-      nc_close(ncid);
-      return ierr;
+  NCCHECK(nc_close(ncid));
+
+  return 0;
+}
+
+//...Reads the part of one station that falls inside [startDate, endDate].
+//   When the time variable is marked sorted the window is located by
+//   bisection and only that hyperslab of the time and data variables is
+//   read. Otherwise the time axis is read whole; if it turns out to be in
+//   order the window is located in memory, else the whole station is read
+//   and filtered
+int NetcdfTimeseries::readStation(int ncid, size_t station, qint64 startDate,
+                                  qint64 endDate, QVector<qint64> &time,
+                                  QVector<double> &data) {
+  auto station_dim_string =
+      boost::str(boost::format("stationLength_%04i") % (station + 1));
+  auto station_time_var_string =
+      boost::str(boost::format("time_station_%04i") % (station + 1));
+  auto station_data_var_string =
+      boost::str(boost::format("data_station_%04i") % (station + 1));
+
+  int dimidStationLength, varid_time, varid_data;
+  size_t length;
+  int ierr =
+      nc_inq_dimid(ncid, station_dim_string.c_str(), &dimidStationLength);
+  if (ierr != NC_NOERR) return ierr;
+  ierr = nc_inq_dimlen(ncid, dimidStationLength, &length);
+  if (ierr != NC_NOERR) return ierr;
+  ierr = nc_inq_varid(ncid, station_time_var_string.c_str(), &varid_time);
+  if (ierr != NC_NOERR) return ierr;
+  ierr = nc_inq_varid(ncid, station_data_var_string.c_str(), &varid_data);
+  if (ierr != NC_NOERR) return ierr;
+
+  std::string timeStdString(80, ' ');
+  ierr = nc_get_att_text(ncid, varid_time, "referenceDate", &timeStdString[0]);
+  if (ierr != NC_NOERR) return ierr;
+  QString timeString = QString::fromStdString(timeStdString.substr(0, 19));
+  qint64 refTime;
+  if (!TimeConversion::parseDateTime(timeString, refTime)) return NC_EINVAL;
+
+  const bool windowed = startDate != std::numeric_limits<qint64>::min() ||
+                        endDate != std::numeric_limits<qint64>::max();
+
+  const long long lo = -floorDiv(-(clampOffset(startDate) - refTime), 1000);
+  const long long hi = floorDiv(clampOffset(endDate) - refTime, 1000);
+
+  //...timeData holds the times from index timeOffset onward
+  std::vector<long long> timeData;
+  size_t timeOffset = 0;
+  size_t first = 0, last = length;
+  bool filter = false;
+  if (windowed && markedSorted(ncid, varid_time)) {
+    ierr = bisectTime(ncid, varid_time, 0, 0, length, lo, false, first);
+    if (ierr != NC_NOERR) return ierr;
+    ierr = bisectTime(ncid, varid_time, 0, first, length, hi, true, last);
+    if (ierr != NC_NOERR) return ierr;
+    timeData.resize(last - first);
+    timeOffset = first;
+    if (last > first) {
+      size_t start = first, count = last - first;
+      ierr = nc_get_vara_longlong(ncid, varid_time, &start, &count,
+                                  timeData.data());
+      if (ierr != NC_NOERR) return ierr;
+    }
+  } else {
+    timeData.resize(length);
+    if (length > 0) {
+      ierr = nc_get_var_longlong(ncid, varid_time, timeData.data());
+      if (ierr != NC_NOERR) return ierr;
     }
+    if (windowed) {
+      if (std::is_sorted(timeData.begin(), timeData.end())) {
+        first = static_cast<size_t>(
+            std::lower_bound(timeData.begin(), timeData.end(), lo) -
+            timeData.begin());
+        last = static_cast<size_t>(
+            std::upper_bound(timeData.begin() + first, timeData.end(), hi) -
+            timeData.begin());
+      } else {
+        filter = true;
+      }
+    }
+  }
 
-    this->m_data[i].resize(length);
-    this->m_time[i].resize(length);
+  data.resize(static_cast<int>(last - first));
+  if (last > first) {
+    size_t start = first, count = last - first;
+    ierr = nc_get_vara_double(ncid, varid_data, &start, &count, data.data());
+    if (ierr != NC_NOERR) return ierr;
+  }
 
-    for (size_t j = 0; j < length; j++) {
-      this->m_data[i][j] = varData[j];
-      this->m_time[i][j] = refTime.addSecs(timeData[j]).toMSecsSinceEpoch();
+  time.resize(static_cast<int>(last - first));
+  TimeConversion::secondsToMsecs(timeData.data() + (first - timeOffset),
+                                 last - first, refTime, time.data());
+
+  if (filter) {
+    int n = 0;
+    for (int j = 0; j < time.size(); ++j) {
+      if (time[j] < startDate || time[j] > endDate) continue;
+      time[n] = time[j];
+      data[n] = data[j];
+      ++n;
     }
+    time.resize(n);
+    data.resize(n);
+  }
+
+  return NC_NOERR;
+}
 
+//...Reads rows [rowStart, rowStart + rowSize) of a contiguous ragged
+//   array file, restricted to [startDate, endDate] the same way as
+//   readStation(). The time units are taken from the CF units attribute.
+//   The sorted attribute covers the whole time variable, so it holds for
+//   every row
+int NetcdfTimeseries::readRaggedStation(int ncid, size_t rowStart,
+                                        size_t rowSize, qint64 startDate,
+                                        qint64 endDate, QVector<qint64> &time,
+                                        QVector<double> &data) {
+  int varid_time, varid_data;
+  int ierr = nc_inq_varid(ncid, "time", &varid_time);
+  if (ierr != NC_NOERR) return ierr;
+  ierr = nc_inq_varid(ncid, "data", &varid_data);
+  if (ierr != NC_NOERR) return ierr;
+
+  size_t unitsLength;
+  ierr = nc_inq_attlen(ncid, varid_time, "units", &unitsLength);
+  if (ierr != NC_NOERR) return ierr;
+  std::string unitsString(unitsLength, ' ');
+  ierr = nc_get_att_text(ncid, varid_time, "units", &unitsString[0]);
+  if (ierr != NC_NOERR) return ierr;
+
+  TimeConversion::Unit unit;
+  qint64 refTime;
+  if (!TimeConversion::parseUnits(QString::fromStdString(unitsString), unit,
+                                  refTime))
+    return NC_EINVAL;
+  const double scale =
+      static_cast<double>(TimeConversion::msecsPerUnit(unit));
+
+  const bool windowed = startDate != std::numeric_limits<qint64>::min() ||
+                        endDate != std::numeric_limits<qint64>::max();
+
+  const double lo = std::ceil(
+      static_cast<double>(clampOffset(startDate) - refTime) / scale);
+  const double hi = std::floor(
+      static_cast<double>(clampOffset(endDate) - refTime) / scale);
+
+  //...timeData holds the row's times from index timeOffset onward
+  std::vector<double> timeData;
+  size_t timeOffset = 0;
+  size_t first = 0, last = rowSize;
+  bool filter = false;
+  if (windowed && markedSorted(ncid, varid_time)) {
+    ierr = bisectTime(ncid, varid_time, rowStart, 0, rowSize, lo, false,
+                      first);
+    if (ierr != NC_NOERR) return ierr;
+    ierr = bisectTime(ncid, varid_time, rowStart, first, rowSize, hi, true,
+                      last);
+    if (ierr != NC_NOERR) return ierr;
+    timeData.resize(last - first);
+    timeOffset = first;
+    if (last > first) {
+      size_t start = rowStart + first, count = last - first;
+      ierr = nc_get_vara_double(ncid, varid_time, &start, &count,
+                                timeData.data());
+      if (ierr != NC_NOERR) return ierr;
+    }
+  } else {
+    timeData.resize(rowSize);
+    if (rowSize > 0) {
+      size_t start = rowStart, count = rowSize;
+      ierr = nc_get_vara_double(ncid, varid_time, &start, &count,
+                                timeData.data());
+      if (ierr != NC_NOERR) return ierr;
+    }
+    if (windowed) {
+      if (std::is_sorted(timeData.begin(), timeData.end())) {
+        first = static_cast<size_t>(
+            std::lower_bound(timeData.begin(), timeData.end(), lo) -
+            timeData.begin());
+        last = static_cast<size_t>(
+            std::upper_bound(timeData.begin() + first, timeData.end(), hi) -
+            timeData.begin());
+      } else {
+        filter = true;
+      }
+    }
   }
 
-  NCCHECK(nc_close(ncid));
+  data.resize(static_cast<int>(last - first));
+  if (last > first) {
+    size_t start = rowStart + first, count = last - first;
+    ierr = nc_get_vara_double(ncid, varid_data, &start, &count, data.data());
+    if (ierr != NC_NOERR) return ierr;
+  }
 
-  return 0;
+  time.resize(static_cast<int>(last - first));
+  TimeConversion::toMsecs(timeData.data() + (first - timeOffset),
+                          last - first, refTime, unit, time.data());
+
+  if (filter) {
+    int n = 0;
+    for (int j = 0; j < time.size(); ++j) {
+      if (time[j] < startDate || time[j] > endDate) continue;
+      time[n] = time[j];
+      data[n] = data[j];
+      ++n;
+    }
+    time.resize(n);
+    data.resize(n);
+  }
+
+  return NC_NOERR;
 }
 
 int NetcdfTimeseries::toHmdf(Hmdf *hmdf) {
@@ -161,16 +587,57 @@ int NetcdfTimeseries::toHmdf(Hmdf *hmdf) {
   hmdf->setHeader3("none");
   hmdf->setSuccess(false);
 
-  for (size_t i = 0; i < this->m_numStations; i++) {
+  size_t nValues = 0;
+  for (auto &t : this->m_time) nValues += t.size();
+  hmdf->reserve(nValues);
+
+  for (size_t k = 0; k < this->m_selected.size(); k++) {
+    const size_t i = this->m_selected[k];
     HmdfStation *station = new HmdfStation(hmdf);
-    station->setDate(this->m_time[i]);
-    station->setData(this->m_data[i]);
+    station->setDate(this->m_time[k]);
+    station->setData(this->m_data[k]);
     station->setLatitude(this->m_ycoor[i]);
     station->setLongitude(this->m_xcoor[i]);
     station->setName(this->m_stationName[i]);
     station->setId(this->m_stationName[i]);
     station->setStationIndex(i);
     station->setNullValue(this->m_fillValue[i]);
+    station->setIsNull(this->m_stationLength[i] == 0);
+    hmdf->addStation(station);
+  }
+
+  hmdf->setSuccess(true);
+
+  return 0;
+}
+
+//...Builds the stations from the metadata alone. Each station reads its
+//   own data (restricted to the time window) the first time it is used
+int NetcdfTimeseries::toHmdfDeferred(Hmdf *hmdf) {
+  hmdf->setDatum("unknown");
+  hmdf->setHeader1("none");
+  hmdf->setHeader2("none");
+  hmdf->setHeader3("none");
+  hmdf->setSuccess(false);
+
+  for (size_t k = 0; k < this->m_selected.size(); k++) {
+    const size_t i = this->m_selected[k];
+    HmdfStation *station = new HmdfStation(hmdf);
+    station->setLatitude(this->m_ycoor[i]);
+    station->setLongitude(this->m_xcoor[i]);
+    station->setName(this->m_stationName[i]);
+    station->setId(this->m_stationName[i]);
+    station->setStationIndex(i);
+    station->setNullValue(this->m_fillValue[i]);
+    station->setIsNull(this->m_stationLength[i] == 0);
+    if (this->m_ragged) {
+      station->setLoader(std::make_shared<NetcdfStationLoader>(
+          this->m_filename, this->m_rowStart[i], this->m_stationLength[i],
+          this->m_startDate, this->m_endDate));
+    } else {
+      station->setLoader(std::make_shared<NetcdfStationLoader>(
+          this->m_filename, i, this->m_startDate, this->m_endDate));
+    }
     hmdf->addStation(station);
   }
 
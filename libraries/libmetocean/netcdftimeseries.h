@@ -22,7 +22,10 @@
 
 #include <QDateTime>
 #include <QObject>
+#include <QStringList>
 #include <QVector>
+#include <limits>
+#include <vector>
 #include "hmdf.h"
 #include "metocean_global.h"
 
@@ -32,8 +35,10 @@ class NetcdfTimeseries : public QObject {
   explicit NetcdfTimeseries(QObject *parent = nullptr);
 
   int read();
+  int readMetadata();
 
   int toHmdf(Hmdf *hmdf);
+  int toHmdfDeferred(Hmdf *hmdf);
 
   QString filename() const;
   void setFilename(const QString &filename);
@@ -41,20 +46,58 @@ class NetcdfTimeseries : public QObject {
   int epsg() const;
   void setEpsg(int epsg);
 
+  //...Station and time selection applied by read() and toHmdfDeferred().
+  //   The station filters are combined, a station has to pass every filter
+  //   that has been set. The bounding box is in the coordinate system of
+  //   the file. Dates are milliseconds since the epoch (inclusive)
+  void setStations(const std::vector<size_t> &stations);
+  void setStations(const QStringList &names);
+  void setBoundingBox(double xmin, double ymin, double xmax, double ymax);
+  void setTimeWindow(qint64 startDate, qint64 endDate);
+  void clearSelection();
+
+  size_t numStations() const;
+  size_t numSelected() const;
+
+  //...True when the file uses the CF contiguous ragged array layout
+  //   (single time/data variables indexed by rowSize) rather than a
+  //   variable pair per station. Detected by readMetadata()
+  bool isRaggedArray() const;
+
   static int getEpsg(QString file);
 
-private:
+  static int readStation(int ncid, size_t station, qint64 startDate,
+                         qint64 endDate, QVector<qint64> &time,
+                         QVector<double> &data);
+  static int readRaggedStation(int ncid, size_t rowStart, size_t rowSize,
+                               qint64 startDate, qint64 endDate,
+                               QVector<qint64> &time, QVector<double> &data);
+
+ private:
+  void select();
+
   QString m_filename;
   QString m_units;
   QString m_verticalDatum;
   QString m_horizontalProjection;
   int m_epsg;
   size_t m_numStations;
+  bool m_ragged;
+
+  std::vector<size_t> m_filterIndex;
+  QStringList m_filterName;
+  bool m_useBoundingBox;
+  double m_bbox[4];
+  qint64 m_startDate;
+  qint64 m_endDate;
+
+  std::vector<size_t> m_selected;
 
   QVector<double> m_fillValue;
   QVector<double> m_xcoor;
   QVector<double> m_ycoor;
   QVector<size_t> m_stationLength;
+  QVector<size_t> m_rowStart;
   QVector<QString> m_stationName;
   QVector<QVector<qint64> > m_time;
   QVector<QVector<double> > m_data;
@@ -0,0 +1,151 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include "netcdfwriteprofile.h"
+#include <algorithm>
+#include "netcdf.h"
+
+//...One million samples (8 MB of doubles) per chunk at most
+static const size_t c_maxChunkLength = 1048576;
+
+//...Smallest chunk used along an unlimited dimension
+static const size_t c_minUnlimitedChunkLength = 4096;
+
+NetcdfWriteProfile::NetcdfWriteProfile(Profile profile)
+    : m_compress(true),
+      m_deflateLevel(2),
+      m_shuffle(true),
+      m_chunking(LibraryChunking),
+      m_maxChunkLength(c_maxChunkLength) {
+  switch (profile) {
+    case FastWrite:
+      this->m_name = "fast-write";
+      this->m_compress = false;
+      this->m_deflateLevel = 0;
+      this->m_shuffle = false;
+      this->m_chunking = Contiguous;
+      break;
+    case SmallFile:
+      this->m_name = "small-file";
+      this->m_deflateLevel = 6;
+      this->m_chunking = StationChunking;
+      break;
+    case FastRead:
+      this->m_name = "fast-read";
+      this->m_deflateLevel = 1;
+      this->m_chunking = StationChunking;
+      break;
+    default:
+      this->m_name = "default";
+      break;
+  }
+}
+
+bool NetcdfWriteProfile::fromName(const QString &name,
+                                  NetcdfWriteProfile &profile) {
+  QString n = name.trimmed().toLower();
+  if (n == "default") {
+    profile = NetcdfWriteProfile(Default);
+  } else if (n == "fast-write") {
+    profile = NetcdfWriteProfile(FastWrite);
+  } else if (n == "small-file") {
+    profile = NetcdfWriteProfile(SmallFile);
+  } else if (n == "fast-read") {
+    profile = NetcdfWriteProfile(FastRead);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+QStringList NetcdfWriteProfile::names() {
+  return QStringList() << "default"
+                       << "fast-write"
+                       << "small-file"
+                       << "fast-read";
+}
+
+QString NetcdfWriteProfile::name() const { return this->m_name; }
+
+bool NetcdfWriteProfile::compress() const { return this->m_compress; }
+
+void NetcdfWriteProfile::setCompress(bool compress) {
+  this->m_compress = compress;
+}
+
+int NetcdfWriteProfile::deflateLevel() const { return this->m_deflateLevel; }
+
+void NetcdfWriteProfile::setDeflateLevel(int deflateLevel) {
+  this->m_deflateLevel = std::max(0, std::min(9, deflateLevel));
+}
+
+bool NetcdfWriteProfile::shuffle() const { return this->m_shuffle; }
+
+void NetcdfWriteProfile::setShuffle(bool shuffle) {
+  this->m_shuffle = shuffle;
+}
+
+NetcdfWriteProfile::Chunking NetcdfWriteProfile::chunking() const {
+  return this->m_chunking;
+}
+
+void NetcdfWriteProfile::setChunking(Chunking chunking) {
+  this->m_chunking = chunking;
+}
+
+size_t NetcdfWriteProfile::maxChunkLength() const {
+  return this->m_maxChunkLength;
+}
+
+void NetcdfWriteProfile::setMaxChunkLength(size_t maxChunkLength) {
+  this->m_maxChunkLength = std::max(static_cast<size_t>(1), maxChunkLength);
+}
+
+//...Applies the storage settings to a variable that is still in define
+//   mode. shape holds the length of each dimension of the variable with
+//   time last. A zero length means the dimension is unlimited (or empty).
+//   With unlimited set the time dimension is unlimited and shape holds
+//   the number of records expected to be written now
+int NetcdfWriteProfile::apply(int ncid, int varid,
+                              const std::vector<size_t> &shape,
+                              bool unlimited) const {
+  const size_t length = shape.empty() ? 0 : shape.back();
+  const bool compress = this->m_compress && this->m_deflateLevel > 0;
+
+  if (unlimited && !shape.empty()) {
+    std::vector<size_t> chunk(shape);
+    chunk.back() = std::min(std::max(length, c_minUnlimitedChunkLength),
+                            this->m_maxChunkLength);
+    int ierr = nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunk.data());
+    if (ierr != NC_NOERR) return ierr;
+  } else if (this->m_chunking == Contiguous && !compress && length > 0) {
+    return nc_def_var_chunking(ncid, varid, NC_CONTIGUOUS, nullptr);
+  } else if (this->m_chunking == StationChunking && length > 0) {
+    std::vector<size_t> chunk(shape);
+    chunk.back() = std::min(length, this->m_maxChunkLength);
+    int ierr = nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunk.data());
+    if (ierr != NC_NOERR) return ierr;
+  }
+
+  if (compress) {
+    return nc_def_var_deflate(ncid, varid, this->m_shuffle ? 1 : 0, 1,
+                              this->m_deflateLevel);
+  }
+  return NC_NOERR;
+}
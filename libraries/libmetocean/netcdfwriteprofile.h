@@ -0,0 +1,83 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef NETCDFWRITEPROFILE_H
+#define NETCDFWRITEPROFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <cstddef>
+#include <vector>
+
+//...Storage settings applied to the timeseries variables of the netCDF
+//   writers. The named profiles trade write speed, file size and read
+//   speed against each other:
+//
+//     default    : deflate level 2 with shuffle, library chunking (the
+//                  settings used before profiles existed)
+//     fast-write : no compression, contiguous storage
+//     small-file : deflate level 6 with shuffle, one chunk per station
+//     fast-read  : deflate level 1 with shuffle, one chunk per station so
+//                  that a whole station read decompresses a single chunk
+//
+//   Chunks are sized along the time dimension (the last dimension of the
+//   variable) and capped at maxChunkLength() samples. Contiguous storage
+//   is only used for variables with a fixed, non-zero length. Variables
+//   along an unlimited dimension are always chunked by their expected
+//   length since the library default chunks there are very small.
+class NetcdfWriteProfile {
+ public:
+  enum Profile { Default, FastWrite, SmallFile, FastRead };
+  enum Chunking { LibraryChunking, Contiguous, StationChunking };
+
+  NetcdfWriteProfile(Profile profile = Default);
+
+  static bool fromName(const QString &name, NetcdfWriteProfile &profile);
+  static QStringList names();
+
+  QString name() const;
+
+  bool compress() const;
+  void setCompress(bool compress);
+
+  int deflateLevel() const;
+  void setDeflateLevel(int deflateLevel);
+
+  bool shuffle() const;
+  void setShuffle(bool shuffle);
+
+  Chunking chunking() const;
+  void setChunking(Chunking chunking);
+
+  size_t maxChunkLength() const;
+  void setMaxChunkLength(size_t maxChunkLength);
+
+  int apply(int ncid, int varid, const std::vector<size_t> &shape,
+            bool unlimited = false) const;
+
+ private:
+  QString m_name;
+  bool m_compress;
+  int m_deflateLevel;
+  bool m_shuffle;
+  Chunking m_chunking;
+  size_t m_maxChunkLength;
+};
+
+#endif  // NETCDFWRITEPROFILE_H
@@ -27,6 +27,8 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <algorithm>
+#include <functional>
 
 #include "boost/algorithm/string/split.hpp"
 #include "boost/algorithm/string/trim.hpp"
@@ -43,10 +45,31 @@ NoaaCoOps::NoaaCoOps(const Station &station, const QDateTime startDate,
       m_units(units),
       m_datum(datum),
       m_useVdatum(useVdatum),
-      m_useJson(true) {
+      m_useJson(true),
+      m_serverUrl(QStringLiteral(
+          "https://api.tidesandcurrents.noaa.gov/api/prod/datagetter")),
+      m_maxConcurrentRequests(4) {
   this->parseProduct();
 }
 
+int NoaaCoOps::maxConcurrentRequests() const {
+  return this->m_maxConcurrentRequests;
+}
+
+void NoaaCoOps::setMaxConcurrentRequests(int maxConcurrentRequests) {
+  this->m_maxConcurrentRequests = std::max(1, maxConcurrentRequests);
+}
+
+QString NoaaCoOps::serverUrl() const { return this->m_serverUrl; }
+
+void NoaaCoOps::setServerUrl(const QString &serverUrl) {
+  this->m_serverUrl = serverUrl;
+}
+
+bool NoaaCoOps::useJson() const { return this->m_useJson; }
+
+void NoaaCoOps::setUseJson(bool useJson) { this->m_useJson = useJson; }
+
 int NoaaCoOps::parseProduct() {
   this->m_productParsed = this->m_product.split(":");
   return 0;
@@ -95,77 +118,118 @@ int NoaaCoOps::generateDateRanges(QVector<QDateTime> &startDateList,
   return 0;
 }
 
+QString NoaaCoOps::requestUrl(const QDateTime &startDate,
+                              const QDateTime &endDate) {
+  // Make the date string
+  QString startString = startDate.toString(QStringLiteral("yyyyMMdd hh:mm"));
+  QString endString = endDate.toString(QStringLiteral("yyyyMMdd hh:mm"));
+
+  //...Select parser type
+  QString format;
+  if (this->m_useJson) {
+    format = "json";
+  } else {
+    format = "csv";
+  }
+
+  // Build the URL to request data from the NOAA CO-OPS API
+  QString requestURL =
+      this->m_serverUrl + QStringLiteral("?") + QStringLiteral("product=") +
+      this->m_productParsed[0] + QStringLiteral("&application=MetOceanViewer") +
+      QStringLiteral("&begin_date=") + startString +
+      QStringLiteral("&end_date=") + endString + QStringLiteral("&station=") +
+      this->station().id() + QStringLiteral("&time_zone=GMT&units=") +
+      this->m_units + QStringLiteral("&interval=&format=") + format;
+
+  // Allow a different datum where allowed. Use VDatum if the user wants near
+  // the coast
+  if (this->m_datum != QStringLiteral("Stnd")) {
+    if (this->m_useVdatum) {
+      requestURL = requestURL + QStringLiteral("&datum=MSL");
+    } else {
+      requestURL = requestURL + QStringLiteral("&datum=") + this->m_datum;
+    }
+  }
+
+  return requestURL;
+}
+
 int NoaaCoOps::downloadDataFromNoaaServer(
     QVector<QDateTime> startDateList, QVector<QDateTime> endDateList,
     std::vector<std::string> &downloadedData) {
-  QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-
-  for (int i = 0; i < startDateList.length(); i++) {
-    // Make the date string
-    QString startString =
-        startDateList[i].toString(QStringLiteral("yyyyMMdd hh:mm"));
-    QString endString =
-        endDateList[i].toString(QStringLiteral("yyyyMMdd hh:mm"));
-
-    //...Select parser type
-    QString format;
-    if (this->m_useJson) {
-      format = "json";
-    } else {
-      format = "csv";
+  const size_t nChunks = static_cast<size_t>(startDateList.length());
+  if (nChunks == 0) return 0;
+
+  //...All of the date windows go through one manager and one event loop.
+  //   Up to m_maxConcurrentRequests are in flight at once and each response
+  //   lands in its own slot so they are reassembled in date order no matter
+  //   which one finishes first
+  QNetworkAccessManager manager;
+  QEventLoop loop;
+
+  std::vector<std::string> chunks(nChunks);
+  std::vector<int> status(nChunks, 0);
+  size_t nextChunk = 0;
+  size_t nFinished = 0;
+  int nInFlight = 0;
+
+  std::function<void(size_t, const QUrl &, bool)> send;
+  std::function<void()> fill;
+
+  send = [&](size_t chunk, const QUrl &url, bool redirected) {
+    qDebug() << url;
+    QNetworkReply *reply = manager.get(QNetworkRequest(url));
+    connect(reply, &QNetworkReply::finished, &loop,
+            [&, chunk, reply, redirected]() {
+              //...Check for a redirect from NOAA. This fixes bug #26
+              QVariant redirectionTargetURL = reply->attribute(
+                  QNetworkRequest::RedirectionTargetAttribute);
+              if (!redirected && !redirectionTargetURL.isNull()) {
+                reply->deleteLater();
+                send(chunk, reply->url().resolved(redirectionTargetURL.toUrl()),
+                     true);
+                return;
+              }
+
+              status[chunk] = this->readNoaaResponse(reply, chunks[chunk]);
+              nInFlight--;
+              nFinished++;
+
+              if (nFinished == nChunks) {
+                loop.quit();
+              } else {
+                fill();
+              }
+            });
+  };
+
+  fill = [&]() {
+    while (nInFlight < this->m_maxConcurrentRequests && nextChunk < nChunks) {
+      size_t chunk = nextChunk++;
+      nInFlight++;
+      send(chunk,
+           QUrl(this->requestUrl(startDateList[chunk], endDateList[chunk])),
+           false);
     }
+  };
 
-    // Build the URL to request data from the NOAA CO-OPS API
-    QString requestURL =
-        QStringLiteral("https://api.tidesandcurrents.noaa.gov/api/prod/datagetter?") +
-        QStringLiteral("product=") + this->m_productParsed[0] +
-        QStringLiteral("&application=MetOceanViewer") +
-        QStringLiteral("&begin_date=") + startString +
-        QStringLiteral("&end_date=") + endString + QStringLiteral("&station=") +
-        this->station().id() + QStringLiteral("&time_zone=GMT&units=") +
-        this->m_units + QStringLiteral("&interval=&format=") + format;
-
-    // Allow a different datum where allowed. Use VDatum if the user wants near
-    // the coast
-    if (this->m_datum != QStringLiteral("Stnd")) {
-      if (this->m_useVdatum) {
-        requestURL = requestURL + QStringLiteral("&datum=MSL");
-      } else {
-        requestURL = requestURL + QStringLiteral("&datum=") + this->m_datum;
-      }
-    }
+  fill();
+  loop.exec();
+
+  for (size_t i = 0; i < nChunks; ++i) {
+    if (status[i] != 0) return status[i];
+  }
 
-    qDebug() << requestURL;
-
-    // Send the request
-    QEventLoop loop;
-    QNetworkReply *reply = manager->get(QNetworkRequest(QUrl(requestURL)));
-    connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
-    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), &loop,
-            SLOT(quit()));
-    loop.exec();
-
-    //...Check for a redirect from NOAA. This fixes bug #26
-    QVariant redirectionTargetURL =
-        reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
-    if (!redirectionTargetURL.isNull()) {
-      QNetworkReply *reply2 =
-          manager->get(QNetworkRequest(redirectionTargetURL.toUrl()));
-      connect(reply2, SIGNAL(finished()), &loop, SLOT(quit()));
-      connect(reply2, SIGNAL(error(QNetworkReply::NetworkError)), &loop,
-              SLOT(quit()));
-      loop.exec();
-      reply->deleteLater();
-      this->readNoaaResponse(reply2, downloadedData);
-    } else
-      this->readNoaaResponse(reply, downloadedData);
+  downloadedData.reserve(downloadedData.size() + nChunks);
+  for (auto &c : chunks) {
+    downloadedData.push_back(std::move(c));
   }
 
   return 0;
 }
 
 int NoaaCoOps::readNoaaResponse(QNetworkReply *reply,
-                                std::vector<std::string> &downloadedData) {
+                                std::string &downloadedData) {
   // Catch some errors during the download
   if (reply->error() != 0) {
     this->setErrorString(QStringLiteral("ERROR: ") + reply->errorString());
@@ -173,8 +237,8 @@ int NoaaCoOps::readNoaaResponse(QNetworkReply *reply,
     return 1;
   }
 
-  // Store the data at the back of the vector
-  downloadedData.push_back(static_cast<std::string>(reply->readAll()));
+  // Store the data in this window's slot
+  downloadedData = static_cast<std::string>(reply->readAll());
 
   // Delete this response
   reply->deleteLater();
@@ -198,7 +262,7 @@ void NoaaCoOps::parseCsvToValuePair(std::string &data, QDateTime &date,
   namespace phoenix = boost::phoenix;
   std::string dir;
   std::vector<double> v2(3);
-  int year, month, day, hour, minute;
+  int year = 0, month = 0, day = 0, hour = 0, minute = 0;
   qi::phrase_parse(data.begin(), data.begin() + 10,
                    (qi::int_ >> qi::int_ >> qi::int_), qi::skip['-'], year,
                    month, day);
@@ -32,6 +32,16 @@ class NoaaCoOps : public WaterData {
             const QString &product, const QString &datum, const bool useVdatum,const QString &units,
             QObject *parent = nullptr);
 
+  int maxConcurrentRequests() const;
+  void setMaxConcurrentRequests(int maxConcurrentRequests);
+
+  QString serverUrl() const;
+  void setServerUrl(const QString &serverUrl);
+
+  //...Request JSON (the default) or CSV from the server
+  bool useJson() const;
+  void setUseJson(bool useJson);
+
  private:
   int retrieveData(Hmdf *data, Datum::VDatum datum = Datum::VDatum::NullDatum);
 
@@ -44,8 +54,9 @@ class NoaaCoOps : public WaterData {
                                  QVector<QDateTime> endDateList,
                                  std::vector<std::string> &downloadedData);
 
-  int readNoaaResponse(QNetworkReply *reply,
-                       std::vector<std::string> &retrieveData);
+  QString requestUrl(const QDateTime &startDate, const QDateTime &endDate);
+
+  int readNoaaResponse(QNetworkReply *reply, std::string &retrieveData);
 
   int formatNoaaResponse(std::vector<std::string> &downloadedData,
                          Hmdf *outputData);
@@ -59,7 +70,9 @@ class NoaaCoOps : public WaterData {
   QStringList m_productParsed;
   QString m_datum;
   QString m_units;
+  QString m_serverUrl;
   bool m_useJson, m_useVdatum;
+  int m_maxConcurrentRequests;
 };
 
 #endif  // NOAACOOPS_H
@@ -0,0 +1,207 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#ifndef TIMECONVERSION_H
+#define TIMECONVERSION_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+#include <type_traits>
+
+//...Calendar arithmetic on the proleptic Gregorian calendar in UTC. These
+//   avoid building a QDateTime per record in the hot loops of the readers
+//   and writers. Fields are not range checked, so an hour of 24 rolls into
+//   the next day.
+//
+//   The toMsecs() family converts whole arrays of time offsets from a
+//   reference date to epoch milliseconds. The reference is parsed once and
+//   the loops are plain multiply-adds that the compiler can vectorize.
+//   Floating point offsets are rounded to the nearest millisecond
+class TimeConversion {
+ public:
+  enum Unit { Milliseconds, Seconds, Minutes, Hours, Days };
+
+  static qint64 msecsPerUnit(Unit unit) {
+    switch (unit) {
+      case Milliseconds:
+        return 1;
+      case Seconds:
+        return 1000;
+      case Minutes:
+        return 60000;
+      case Hours:
+        return 3600000;
+      case Days:
+        return 86400000;
+    }
+    return 1000;
+  }
+
+  template <typename T>
+  static void toMsecs(const T *offset, size_t n, qint64 referenceMsecs,
+                      Unit unit, qint64 *msecs) {
+    toMsecs(offset, n, referenceMsecs, msecsPerUnit(unit), msecs,
+            std::is_floating_point<T>());
+  }
+
+  template <typename T>
+  static void secondsToMsecs(const T *offset, size_t n,
+                             qint64 referenceMsecs, qint64 *msecs) {
+    toMsecs(offset, n, referenceMsecs, Seconds, msecs);
+  }
+
+  //...Parses "yyyy-MM-dd hh:mm:ss" style dates. The date separator may be
+  //   '-' or '/', the date and time may be separated by ' ' or 'T', the
+  //   time (or its seconds) may be omitted and trailing text (fractional
+  //   seconds, a 'Z' or a zone offset) is ignored. Returns false if no
+  //   date could be read
+  static bool parseDateTime(const QString &text, qint64 &msecs) {
+    const QByteArray latin = text.trimmed().toLatin1();
+    const char *p = latin.constData();
+    const char *end = p + latin.size();
+
+    int field[6] = {0, 1, 1, 0, 0, 0};
+    int count = 0;
+    bool negative = p < end && *p == '-';
+    if (negative) ++p;
+    while (count < 6 && p < end) {
+      if (*p < '0' || *p > '9') break;
+      int v = 0;
+      while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+      field[count++] = v;
+      if (p == end) break;
+      const char sep = *p;
+      const bool dateSep = count < 3 && (sep == '-' || sep == '/');
+      const bool splitSep = count == 3 && (sep == ' ' || sep == 'T');
+      const bool timeSep = count > 3 && sep == ':';
+      if (!dateSep && !splitSep && !timeSep) break;
+      ++p;
+      if (splitSep) {
+        while (p < end && *p == ' ') ++p;
+      }
+    }
+    if (count < 3) return false;
+    if (negative) field[0] = -field[0];
+    msecs = msecsFromCivil(field[0], field[1], field[2], field[3], field[4],
+                           field[5]);
+    return true;
+  }
+
+  //...Parses CF style units, "<unit> since <reference date>"
+  static bool parseUnits(const QString &units, Unit &unit,
+                         qint64 &referenceMsecs) {
+    const QString u = units.trimmed();
+    const int since = u.indexOf(QStringLiteral(" since "), 0,
+                                Qt::CaseInsensitive);
+    if (since < 0) return false;
+    if (!unitFromString(u.left(since), unit)) return false;
+    return parseDateTime(u.mid(since + 7), referenceMsecs);
+  }
+
+  static bool unitFromString(const QString &name, Unit &unit) {
+    const QString n = name.trimmed().toLower();
+    if (n == "milliseconds" || n == "millisecond" || n == "msec" ||
+        n == "msecs" || n == "ms") {
+      unit = Milliseconds;
+    } else if (n == "seconds" || n == "second" || n == "sec" ||
+               n == "secs" || n == "s") {
+      unit = Seconds;
+    } else if (n == "minutes" || n == "minute" || n == "min" ||
+               n == "mins") {
+      unit = Minutes;
+    } else if (n == "hours" || n == "hour" || n == "hr" || n == "hrs" ||
+               n == "h") {
+      unit = Hours;
+    } else if (n == "days" || n == "day" || n == "d") {
+      unit = Days;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  static qint64 daysFromCivil(qint64 year, int month, int day) {
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const qint64 yoe = year - era * 400;
+    const qint64 doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const qint64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+  }
+
+  static qint64 msecsFromCivil(int year, int month, int day, int hour,
+                               int minute, int second) {
+    return (daysFromCivil(year, month, day) * 86400 + hour * 3600 +
+            minute * 60 + second) *
+           1000;
+  }
+
+  static void civilFromDays(qint64 days, int &year, int &month, int &day) {
+    days += 719468;
+    const qint64 era = (days >= 0 ? days : days - 146096) / 146097;
+    const qint64 doe = days - era * 146097;
+    const qint64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const qint64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const qint64 mp = (5 * doy + 2) / 153;
+    day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+  }
+
+  //...Milliseconds are truncated toward the start of the second, the same
+  //   way QDateTime reports them
+  static void civilFromMsecs(qint64 msecs, int &year, int &month, int &day,
+                             int &hour, int &minute, int &second) {
+    qint64 days = msecs / 86400000;
+    qint64 rem = msecs % 86400000;
+    if (rem < 0) {
+      rem += 86400000;
+      --days;
+    }
+    civilFromDays(days, year, month, day);
+    const int secs = static_cast<int>(rem / 1000);
+    hour = secs / 3600;
+    minute = (secs / 60) % 60;
+    second = secs % 60;
+  }
+
+ private:
+  template <typename T>
+  static void toMsecs(const T *offset, size_t n, qint64 referenceMsecs,
+                      qint64 scale, qint64 *msecs, std::false_type) {
+    for (size_t i = 0; i < n; ++i) {
+      msecs[i] = referenceMsecs + static_cast<qint64>(offset[i]) * scale;
+    }
+  }
+
+  template <typename T>
+  static void toMsecs(const T *offset, size_t n, qint64 referenceMsecs,
+                      qint64 scale, qint64 *msecs, std::true_type) {
+    const double s = static_cast<double>(scale);
+    for (size_t i = 0; i < n; ++i) {
+      const double v = static_cast<double>(offset[i]) * s;
+      msecs[i] =
+          referenceMsecs + static_cast<qint64>(v < 0.0 ? v - 0.5 : v + 0.5);
+    }
+  }
+};
+
+#endif  // TIMECONVERSION_H
@@ -0,0 +1,33 @@
+#-------------------------------GPL-------------------------------------#
+#
+# MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+# Copyright (C) 2019  Zach Cobell
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-----------------------------------------------------------------------#
+
+#...Times the ADCIRC ascii station reader on large fort.61/62 files
+#   generated from the function_tests samples
+
+include($$PWD/../tests.pri)
+
+TARGET = bench_adcircascii
+
+INCLUDEPATH += $$PWD/../../MetOceanViewer/src
+
+SOURCES += main.cpp \
+           $$PWD/../../MetOceanViewer/src/adcircstationoutput.cpp
+
+HEADERS += $$PWD/../../MetOceanViewer/src/adcircstationoutput.h
@@ -0,0 +1,282 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "adcircstationoutput.h"
+#include "hmdf.h"
+
+//...Benchmark of AdcircStationOutput::readAscii. The fort.61 (scalar) and
+//   fort.62 (vector) samples in function_tests/ReadADCIRC/ASCII are grown
+//   into large files. Their stations are repeated across the station
+//   dimension and their output steps are repeated forward in time. Each
+//   file is then read three ways:
+//
+//     legacy : the previous QFile::readLine().simplified().split() loop
+//     mapped : AdcircStationOutput::read
+//     window : AdcircStationOutput::read limited to the last tenth of the
+//              run, which only parses the steps it keeps
+//
+//   The mapped read has to match the legacy values exactly.
+//
+//   usage: bench_adcircascii [stationCopies] [timeCopies]
+//
+//   Returns nonzero if a file cannot be generated or the readers disagree
+
+namespace {
+
+struct Sample {
+  QString header1;
+  int numStations;
+  double dt;
+  int nspool;
+  int numColumns;
+  std::vector<double> time;
+  std::vector<int> iteration;
+  std::vector<QStringList> values;  // [step * numStations + station]
+};
+
+int readSample(const QString &filename, Sample &s) {
+  QFile f(filename);
+  if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return 1;
+  s.header1 = QString(f.readLine()).trimmed();
+  QStringList h = QString(f.readLine()).simplified().split(" ");
+  const int numSnaps = h.value(0).toInt();
+  s.numStations = h.value(1).toInt();
+  s.dt = h.value(2).toDouble();
+  s.nspool = h.value(3).toInt();
+  s.numColumns = h.value(4).toInt();
+  for (int i = 0; i < numSnaps; ++i) {
+    QStringList t = QString(f.readLine()).simplified().split(" ");
+    if (t.size() < 2) return 1;
+    s.time.push_back(t.value(0).toDouble());
+    s.iteration.push_back(t.value(1).toInt());
+    for (int j = 0; j < s.numStations; ++j) {
+      QStringList v = QString(f.readLine()).simplified().split(" ");
+      if (v.size() < 1 + s.numColumns) return 1;
+      s.values.push_back(v.mid(1));
+    }
+  }
+  return 0;
+}
+
+//...Writes a file with stationCopies times the stations and timeCopies
+//   times the output steps of the sample, in the fort.61 layout
+int generate(const Sample &s, size_t stationCopies, size_t timeCopies,
+             const QString &filename, size_t &numSnaps, size_t &numStations) {
+  QFile f(filename);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return 1;
+  QTextStream out(&f);
+
+  const size_t sampleSnaps = s.time.size();
+  numSnaps = sampleSnaps * timeCopies;
+  numStations = static_cast<size_t>(s.numStations) * stationCopies;
+  //...The sample's first step is one output interval after the cold start,
+  //   so each copy starts one interval after the previous one ends
+  const double period = s.time.back();
+  const int periodIterations = s.iteration.back();
+
+  out << s.header1 << "\n";
+  out << QString("%1 %2 %3 %4 %5 FileFmtVersion:    1050624\n")
+             .arg(numSnaps, 11)
+             .arg(numStations, 10)
+             .arg(s.dt, 15, 'E', 7)
+             .arg(s.nspool, 5)
+             .arg(s.numColumns, 5);
+
+  for (size_t c = 0; c < timeCopies; ++c) {
+    for (size_t i = 0; i < sampleSnaps; ++i) {
+      out << QString("%1 %2\n")
+                 .arg(s.time[i] + c * period, 22, 'E', 10)
+                 .arg(s.iteration[i] + static_cast<int>(c) * periodIterations,
+                      14);
+      for (size_t j = 0; j < numStations; ++j) {
+        const QStringList &v = s.values[i * s.numStations + j % s.numStations];
+        out << QString("%1").arg(j + 1, 10);
+        for (auto &x : v) out << "    " << x;
+        out << "\n";
+      }
+    }
+  }
+  return out.status() == QTextStream::Ok ? 0 : 1;
+}
+
+int generateStations(const QString &sample, size_t stationCopies,
+                     const QString &filename) {
+  QFile in(sample);
+  if (!in.open(QIODevice::ReadOnly | QIODevice::Text)) return 1;
+  const int n = QString(in.readLine()).trimmed().toInt();
+  QStringList lines;
+  for (int i = 0; i < n; ++i) lines << QString(in.readLine()).trimmed();
+
+  QFile out(filename);
+  if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) return 1;
+  QTextStream s(&out);
+  s << n * stationCopies << "\n";
+  for (size_t c = 0; c < stationCopies; ++c) {
+    for (auto &l : lines) s << l << "\n";
+  }
+  return 0;
+}
+
+//...The loop the reader used before it was memory mapped
+void legacyRead(const QString &filename, std::vector<double> &time,
+                std::vector<std::vector<double>> &data) {
+  QFile f(filename);
+  f.open(QIODevice::ReadOnly | QIODevice::Text);
+  f.readLine();
+  QStringList header = QString(f.readLine()).simplified().split(" ");
+  const size_t numSnaps = header.value(0).toULongLong();
+  const size_t numStations = header.value(1).toULongLong();
+  const int numColumns = header.value(4).toInt();
+
+  time.resize(numSnaps);
+  data.assign(numStations, std::vector<double>(numSnaps));
+  for (size_t i = 0; i < numSnaps; ++i) {
+    QStringList t = QString(f.readLine()).simplified().split(" ");
+    time[i] = t.value(0).toDouble();
+    for (size_t j = 0; j < numStations; ++j) {
+      QStringList v = QString(f.readLine()).simplified().split(" ");
+      const double u = v.value(1).toDouble();
+      if (u < -900) {
+        data[j][i] = HmdfStation::nullDataValue();
+      } else if (numColumns == 2) {
+        const double w = v.value(2).toDouble();
+        data[j][i] = std::sqrt(u * u + w * w);
+      } else {
+        data[j][i] = u;
+      }
+    }
+  }
+}
+
+double msecs(const QElapsedTimer &timer) {
+  return static_cast<double>(timer.nsecsElapsed()) / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  size_t stationCopies = 20;
+  size_t timeCopies = 100;
+  if (argc > 1)
+    stationCopies = std::max<size_t>(1, std::strtoul(argv[1], 0, 10));
+  if (argc > 2) timeCopies = std::max<size_t>(1, std::strtoul(argv[2], 0, 10));
+
+  const QString samples =
+      QStringLiteral(MOV_FUNCTION_TESTS) + "/ReadADCIRC/ASCII/";
+  const QDateTime coldStart(QDate(2015, 1, 1), QTime(0, 0, 0), Qt::UTC);
+
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) return 1;
+
+  const QString stationFile = tmp.path() + "/stations.csv";
+  if (generateStations(samples + "stations.csv", stationCopies,
+                       stationFile) != 0) {
+    std::fprintf(stderr, "Could not generate the station file\n");
+    return 1;
+  }
+
+  std::printf("%-8s %8s %8s %8s %10s %10s %10s %8s\n", "file", "steps",
+              "stations", "MB", "legacy ms", "mapped ms", "window ms",
+              "speedup");
+
+  for (const char *name : {"fort.61", "fort.62"}) {
+    Sample sample;
+    if (readSample(samples + name, sample) != 0) {
+      std::fprintf(stderr, "Could not read the %s sample\n", name);
+      return 1;
+    }
+
+    size_t numSnaps, numStations;
+    const QString file = tmp.path() + "/" + name;
+    if (generate(sample, stationCopies, timeCopies, file, numSnaps,
+                 numStations) != 0) {
+      std::fprintf(stderr, "Could not generate %s\n", name);
+      return 1;
+    }
+
+    QElapsedTimer timer;
+    std::vector<double> legacyTime;
+    std::vector<std::vector<double>> legacyData;
+    timer.start();
+    legacyRead(file, legacyTime, legacyData);
+    const double tLegacy = msecs(timer);
+
+    AdcircStationOutput mapped;
+    timer.restart();
+    int ierr = mapped.read(file, stationFile, coldStart);
+    const double tMapped = msecs(timer);
+    Hmdf hmdf;
+    if (ierr != 0 || mapped.toHmdf(&hmdf) != 0 ||
+        hmdf.nstations() != numStations) {
+      std::fprintf(stderr, "%s: read failed (%d)\n", name, ierr);
+      return 1;
+    }
+    for (size_t j = 0; j < numStations; ++j) {
+      HmdfStation *s = hmdf.station(static_cast<int>(j));
+      if (s->numSnaps() != numSnaps) {
+        std::fprintf(stderr, "%s: station %zu has %zu steps\n", name, j,
+                     s->numSnaps());
+        return 1;
+      }
+      for (size_t i = 0; i < numSnaps; ++i) {
+        const qint64 date = coldStart.toMSecsSinceEpoch() +
+                            std::llround(legacyTime[i] * 1000.0);
+        if (s->data(static_cast<int>(i)) != legacyData[j][i] ||
+            s->date(static_cast<int>(i)) != date) {
+          std::fprintf(stderr, "%s: mismatch at station %zu step %zu\n",
+                       name, j, i);
+          return 1;
+        }
+      }
+    }
+
+    AdcircStationOutput window;
+    const qint64 last = coldStart.toMSecsSinceEpoch() +
+                        std::llround(legacyTime.back() * 1000.0);
+    const qint64 first =
+        coldStart.toMSecsSinceEpoch() +
+        std::llround(legacyTime[numSnaps - numSnaps / 10] * 1000.0);
+    window.setTimeWindow(first, last);
+    timer.restart();
+    ierr = window.read(file, stationFile, coldStart);
+    const double tWindow = msecs(timer);
+    if (ierr != 0) return 1;
+
+    std::printf("%-8s %8zu %8zu %8.1f %10.1f %10.1f %10.1f %7.1fx\n", name,
+                numSnaps, numStations, QFileInfo(file).size() / 1048576.0,
+                tLegacy, tMapped, tWindow, tLegacy / std::max(tMapped, 1e-3));
+  }
+
+  return 0;
+}
@@ -0,0 +1,252 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "boost/config/warning_disable.hpp"
+#include "boost/fusion/include/adapt_struct.hpp"
+#include "boost/spirit/include/qi.hpp"
+#include "hmdf.h"
+#include "hmdfasciiparser.h"
+
+//...Benchmark of the IMEDS record tokenizer against the Boost.Spirit
+//   grammar it replaced. The record lines of the IMEDS samples in
+//   function_tests are repeated to build a large input, parsed both ways
+//   and checked for identical results. A synthetic IMEDS file of the same
+//   size is then read end to end through Hmdf::readImeds.
+//
+//   usage: bench_asciiparser [copies]
+//
+//   Returns nonzero if the two parsers disagree or the file read fails
+
+namespace {
+
+struct Record {
+  int yr, mo, da, hr, mi, sec;
+  double value;
+};
+
+//...The grammars from the previous HmdfAsciiParser::splitStringHmdfFormat.
+//   They are built on every call, the same way the old code built them
+struct SpiritWithSeconds {
+  int yr, mo, da, hr, min, sec;
+  double val;
+};
+
+struct SpiritWithoutSeconds {
+  int yr, mo, da, hr, min;
+  double val;
+};
+
+}  // namespace
+
+BOOST_FUSION_ADAPT_STRUCT(SpiritWithSeconds,
+                          (int, yr)(int, mo)(int, da)(int, hr)(int, min)(
+                              int, sec)(double, val))
+
+BOOST_FUSION_ADAPT_STRUCT(SpiritWithoutSeconds,
+                          (int, yr)(int, mo)(int, da)(int, hr)(int,
+                                                               min)(double,
+                                                                    val))
+
+namespace {
+
+namespace qi = boost::spirit::qi;
+namespace ascii = boost::spirit::ascii;
+typedef std::string::const_iterator Iterator;
+
+struct SpiritWithSecondsParser
+    : qi::grammar<Iterator, SpiritWithSeconds(), ascii::space_type> {
+  SpiritWithSecondsParser() : SpiritWithSecondsParser::base_type(start) {
+    start %= qi::int_ >> qi::int_ >> qi::int_ >> qi::int_ >> qi::int_ >>
+             qi::int_ >> qi::double_;
+  }
+  qi::rule<Iterator, SpiritWithSeconds(), ascii::space_type> start;
+};
+
+struct SpiritWithoutSecondsParser
+    : qi::grammar<Iterator, SpiritWithoutSeconds(), ascii::space_type> {
+  SpiritWithoutSecondsParser() : SpiritWithoutSecondsParser::base_type(start) {
+    start %=
+        qi::int_ >> qi::int_ >> qi::int_ >> qi::int_ >> qi::int_ >> qi::double_;
+  }
+  qi::rule<Iterator, SpiritWithoutSeconds(), ascii::space_type> start;
+};
+
+bool spiritRecord(const std::string &data, Record &r) {
+  SpiritWithSecondsParser p1;
+  SpiritWithoutSecondsParser p2;
+  SpiritWithSeconds r1;
+  SpiritWithoutSeconds r2;
+
+  Iterator iter = data.begin();
+  Iterator end = data.end();
+
+  if (qi::phrase_parse(iter, end, p1, ascii::space, r1)) {
+    r.yr = r1.yr;
+    r.mo = r1.mo;
+    r.da = r1.da;
+    r.hr = r1.hr;
+    r.mi = r1.min;
+    r.sec = r1.sec;
+    r.value = r1.val;
+    return true;
+  } else if (qi::phrase_parse(iter, end, p2, ascii::space, r2)) {
+    r.yr = r2.yr;
+    r.mo = r2.mo;
+    r.da = r2.da;
+    r.hr = r2.hr;
+    r.mi = r2.min;
+    r.sec = 0;
+    r.value = r2.val;
+    return true;
+  }
+  return false;
+}
+
+//...Appends the record lines (skipping the three header lines and the
+//   station lines) of an IMEDS file
+int readRecordLines(const QString &filename, std::vector<std::string> &lines) {
+  QFile f(filename);
+  if (!f.open(QIODevice::ReadOnly)) {
+    std::fprintf(stderr, "Could not open %s\n", qPrintable(filename));
+    return 1;
+  }
+  int n = 0;
+  while (!f.atEnd()) {
+    QByteArray line = f.readLine().trimmed();
+    if (n++ < 3 || line.isEmpty()) continue;
+    if (line.simplified().split(' ').size() < 6) continue;
+    lines.push_back(line.toStdString());
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  size_t copies = 20;
+  if (argc > 1) copies = std::strtoul(argv[1], nullptr, 10);
+  if (copies == 0) copies = 1;
+
+  std::vector<std::string> sample;
+  const QString dir = QStringLiteral(MOV_FUNCTION_TESTS) + "/ReadIMEDS/";
+  if (readRecordLines(dir + "mllw.imeds", sample) != 0) return 1;
+  if (readRecordLines(dir + "msl.imeds", sample) != 0) return 1;
+
+  std::vector<std::string> lines;
+  lines.reserve(sample.size() * copies);
+  std::string buffer;
+  for (size_t c = 0; c < copies; ++c) {
+    for (auto &s : sample) {
+      lines.push_back(s);
+      buffer += s;
+      buffer += '\n';
+    }
+  }
+
+  std::printf("records: %zu (%zu sample records x %zu)\n", lines.size(),
+              sample.size(), copies);
+
+  //...Boost.Spirit, one std::string per line
+  QElapsedTimer timer;
+  std::vector<Record> spirit(lines.size());
+  timer.start();
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (!spiritRecord(lines[i], spirit[i])) {
+      std::fprintf(stderr, "spirit failed on line %zu\n", i);
+      return 1;
+    }
+  }
+  const qint64 tSpirit = timer.nsecsElapsed();
+
+  //...Tokenizer, in place over one buffer
+  std::vector<Record> tokens(lines.size());
+  timer.restart();
+  const char *p = buffer.data();
+  const char *end = p + buffer.size();
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const char *e = HmdfAsciiParser::lineEnd(p, end);
+    Record &r = tokens[i];
+    if (!HmdfAsciiParser::parseRecord(p, e, r.yr, r.mo, r.da, r.hr, r.mi,
+                                      r.sec, r.value)) {
+      std::fprintf(stderr, "tokenizer failed on line %zu\n", i);
+      return 1;
+    }
+    p = e + 1;
+  }
+  const qint64 tTokens = timer.nsecsElapsed();
+
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const Record &s = spirit[i];
+    const Record &t = tokens[i];
+    if (s.yr != t.yr || s.mo != t.mo || s.da != t.da || s.hr != t.hr ||
+        s.mi != t.mi || s.sec != t.sec || s.value != t.value) {
+      std::fprintf(stderr, "mismatch on line %zu: %s\n", i, lines[i].c_str());
+      return 1;
+    }
+  }
+
+  std::printf("spirit:    %10.3f ms  %8.1f ns/record\n", tSpirit / 1e6,
+              static_cast<double>(tSpirit) / lines.size());
+  std::printf("tokenizer: %10.3f ms  %8.1f ns/record\n", tTokens / 1e6,
+              static_cast<double>(tTokens) / lines.size());
+  std::printf("speedup:   %10.2fx\n",
+              static_cast<double>(tSpirit) / std::max<qint64>(tTokens, 1));
+
+  //...End to end through Hmdf::readImeds on a file of the same size
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) return 1;
+  const QString imeds = tmp.path() + "/bench.imeds";
+  {
+    QFile f(imeds);
+    if (!f.open(QIODevice::WriteOnly)) return 1;
+    f.write("% IMEDS generic format - Water Level\n"
+            "% year month day hour min sec watlev(m)\n"
+            "NOAA    UTC    MLLW\n"
+            "BENCH   44.3917   -68.205\n");
+    f.write(buffer.data(), static_cast<qint64>(buffer.size()));
+  }
+
+  Hmdf h;
+  h.setCacheEnabled(false);
+  timer.restart();
+  int ierr = h.readImeds(imeds);
+  const qint64 tRead = timer.nsecsElapsed();
+  if (ierr != 0 || h.nstations() != 1 ||
+      h.station(0)->numSnaps() != lines.size()) {
+    std::fprintf(stderr, "Hmdf::readImeds failed\n");
+    return 1;
+  }
+  std::printf("readImeds: %10.3f ms  %8.1f ns/record\n", tRead / 1e6,
+              static_cast<double>(tRead) / lines.size());
+
+  return 0;
+}
@@ -0,0 +1,266 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "hmdf.h"
+#include "netcdftimeseries.h"
+
+//...Checks and benchmark for the selective netCDF station reads. There
+//   are no netCDF samples in function_tests, so the files are written with
+//   Hmdf::writeNetcdf in both layouts (per-station variables and the CF
+//   ragged array):
+//
+//   1. Small files, one sorted and one with every station shuffled, are
+//      read back through NetcdfTimeseries with a range of station subsets
+//      and time windows (inclusive edges, empty windows, windows outside
+//      the data, open ended windows), eagerly and deferred. Each result
+//      has to match the in-memory source filtered the same way. The
+//      shuffled file exercises the unsorted fallback.
+//
+//   2. A large sorted file is timed for write, metadata open, full read
+//      and a station subset plus time window read.
+//
+//   usage: bench_netcdfselect [stations] [snaps]
+//
+//   Returns nonzero if any read does not match its source
+
+namespace {
+
+//...2015-01-01 00:00:00 UTC, records every six minutes
+const qint64 c_start = 1420070400000LL;
+const qint64 c_step = 360000LL;
+const qint64 c_min = std::numeric_limits<qint64>::min();
+const qint64 c_max = std::numeric_limits<qint64>::max();
+
+double value(size_t station, size_t snap) {
+  return std::sin(0.01 * static_cast<double>(snap) +
+                  static_cast<double>(station));
+}
+
+void buildHmdf(Hmdf &hmdf, size_t nStations, size_t nSnaps, bool shuffled) {
+  hmdf.setUnits("m");
+  hmdf.setDatum("MSL");
+  hmdf.reserve(nStations * nSnaps);
+  std::mt19937 rng(1234);
+  std::vector<size_t> order(nSnaps);
+  for (size_t i = 0; i < nStations; ++i) {
+    HmdfStation *s = new HmdfStation(&hmdf);
+    s->setName(QString("station_%1").arg(i));
+    s->setId(QString("station_%1").arg(i));
+    s->setLatitude(29.0 + 0.01 * i);
+    s->setLongitude(-90.0 + 0.01 * i);
+    s->setStationIndex(static_cast<int>(i));
+    s->setIsNull(false);
+    std::iota(order.begin(), order.end(), 0);
+    if (shuffled) std::shuffle(order.begin(), order.end(), rng);
+    for (auto j : order) s->setNext(c_start + j * c_step, value(i, j));
+    hmdf.addStation(s);
+  }
+}
+
+int writeFile(Hmdf &hmdf, const QString &filename, bool ragged) {
+  hmdf.setNetcdfLayout(ragged ? Hmdf::NetcdfRaggedArray
+                              : Hmdf::NetcdfStationVariables);
+  return hmdf.writeNetcdf(filename);
+}
+
+int readSelection(const QString &filename,
+                  const std::vector<size_t> &stations, qint64 startDate,
+                  qint64 endDate, bool deferred, Hmdf &out) {
+  NetcdfTimeseries ncts;
+  ncts.setFilename(filename);
+  if (!stations.empty()) ncts.setStations(stations);
+  ncts.setTimeWindow(startDate, endDate);
+  int ierr = deferred ? ncts.readMetadata() : ncts.read();
+  if (ierr != 0) return ierr;
+  return deferred ? ncts.toHmdfDeferred(&out) : ncts.toHmdf(&out);
+}
+
+//...Each selected station has to hold exactly the source records inside
+//   the window, in file order
+int compare(Hmdf &source, Hmdf &result, const std::vector<size_t> &stations,
+            qint64 startDate, qint64 endDate) {
+  std::vector<size_t> expected = stations;
+  if (expected.empty()) {
+    expected.resize(source.nstations());
+    std::iota(expected.begin(), expected.end(), 0);
+  }
+  if (result.nstations() != expected.size()) return 1;
+
+  for (size_t k = 0; k < expected.size(); ++k) {
+    HmdfStation *s = source.station(static_cast<int>(expected[k]));
+    HmdfStation *r = result.station(static_cast<int>(k));
+    if (r->name() != s->name()) return 1;
+    size_t n = 0;
+    for (size_t j = 0; j < s->numSnaps(); ++j) {
+      const qint64 d = s->date(static_cast<int>(j));
+      if (d < startDate || d > endDate) continue;
+      if (n >= r->numSnaps() || r->date(static_cast<int>(n)) != d ||
+          r->data(static_cast<int>(n)) != s->data(static_cast<int>(j)))
+        return 1;
+      ++n;
+    }
+    if (n != r->numSnaps()) return 1;
+  }
+  return 0;
+}
+
+struct Case {
+  const char *name;
+  std::vector<size_t> stations;
+  qint64 startDate;
+  qint64 endDate;
+};
+
+int checkFile(Hmdf &source, const QString &filename, const char *label) {
+  const qint64 t100 = c_start + 100 * c_step;
+  const qint64 t900 = c_start + 900 * c_step;
+  const qint64 tEnd = c_start + (source.station(0)->numSnaps() - 1) * c_step;
+
+  const std::vector<Case> cases = {
+      {"everything", {}, c_min, c_max},
+      {"subset", {1, 5, 6}, c_min, c_max},
+      {"window on record times", {}, t100, t900},
+      {"subset and window", {0, 3, 7}, t100, t900},
+      {"window inside one step", {2}, t100 + 1000, t100 + c_step - 1000},
+      {"single record", {2}, t100, t100},
+      {"window before data", {}, c_start - 10 * c_step, c_start - c_step},
+      {"window after data", {}, tEnd + c_step, tEnd + 10 * c_step},
+      {"open start", {4}, c_min, t100},
+      {"open end", {4}, t900, c_max},
+      {"sub-second edges", {1}, t100 - 1, t900 + 1},
+  };
+
+  int failed = 0;
+  for (auto &c : cases) {
+    for (int deferred = 0; deferred < 2; ++deferred) {
+      Hmdf result;
+      int ierr = readSelection(filename, c.stations, c.startDate, c.endDate,
+                               deferred != 0, result);
+      if (ierr == 0)
+        ierr = compare(source, result, c.stations, c.startDate, c.endDate);
+      if (ierr != 0) {
+        std::fprintf(stderr, "FAIL %s: %s (%s)\n", label, c.name,
+                     deferred ? "deferred" : "eager");
+        ++failed;
+      }
+    }
+  }
+  return failed;
+}
+
+double msecs(const QElapsedTimer &timer) {
+  return static_cast<double>(timer.nsecsElapsed()) / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  size_t nStations = 50;
+  size_t nSnaps = 87600;
+  if (argc > 1) nStations = std::max<size_t>(8, std::strtoul(argv[1], 0, 10));
+  if (argc > 2) nSnaps = std::max<size_t>(2000, std::strtoul(argv[2], 0, 10));
+
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) return 1;
+
+  //...Correctness
+  int failed = 0;
+  for (int shuffled = 0; shuffled < 2; ++shuffled) {
+    Hmdf source;
+    buildHmdf(source, 8, 2000, shuffled != 0);
+    for (int ragged = 0; ragged < 2; ++ragged) {
+      const char *label = ragged ? (shuffled ? "ragged/shuffled" : "ragged")
+                                 : (shuffled ? "station/shuffled" : "station");
+      const QString file = tmp.path() + "/check_" +
+                           QString(label).replace('/', '_') + ".nc";
+      if (writeFile(source, file, ragged != 0) != 0) {
+        std::fprintf(stderr, "FAIL %s: write\n", label);
+        ++failed;
+        continue;
+      }
+      failed += checkFile(source, file, label);
+    }
+  }
+  if (failed != 0) {
+    std::fprintf(stderr, "%d checks failed\n", failed);
+    return 1;
+  }
+  std::printf("selection checks passed\n");
+
+  //...Timing
+  Hmdf source;
+  buildHmdf(source, nStations, nSnaps, false);
+  std::printf("%zu stations x %zu records\n", nStations, nSnaps);
+  std::printf("%-8s %10s %10s %10s %10s %10s %8s\n", "layout", "write ms",
+              "size MB", "open ms", "full ms", "subset ms", "speedup");
+
+  std::vector<size_t> subset;
+  for (size_t i = 0; i < nStations; i += nStations / 5) subset.push_back(i);
+  const qint64 weekStart = c_start + (nSnaps / 2) * c_step;
+  const qint64 weekEnd = weekStart + 7LL * 86400000LL;
+
+  for (int ragged = 0; ragged < 2; ++ragged) {
+    const QString file =
+        tmp.path() + (ragged ? "/bench_ragged.nc" : "/bench_station.nc");
+    QElapsedTimer timer;
+
+    timer.start();
+    if (writeFile(source, file, ragged != 0) != 0) return 1;
+    const double tWrite = msecs(timer);
+
+    timer.restart();
+    NetcdfTimeseries meta;
+    meta.setFilename(file);
+    if (meta.readMetadata() != 0) return 1;
+    const double tOpen = msecs(timer);
+
+    Hmdf full;
+    timer.restart();
+    if (readSelection(file, {}, c_min, c_max, false, full) != 0) return 1;
+    const double tFull = msecs(timer);
+
+    Hmdf part;
+    timer.restart();
+    if (readSelection(file, subset, weekStart, weekEnd, false, part) != 0)
+      return 1;
+    const double tPart = msecs(timer);
+    if (compare(source, part, subset, weekStart, weekEnd) != 0) return 1;
+
+    std::printf("%-8s %10.1f %10.1f %10.1f %10.1f %10.1f %7.1fx\n",
+                ragged ? "ragged" : "station", tWrite,
+                QFileInfo(file).size() / 1048576.0, tOpen, tFull, tPart,
+                tFull / std::max(tPart, 1e-3));
+  }
+
+  return 0;
+}
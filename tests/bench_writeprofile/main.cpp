@@ -0,0 +1,166 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "hmdf.h"
+#include "netcdftimeseries.h"
+#include "netcdfwriteprofile.h"
+
+//...Benchmark of the netCDF write profiles. A synthetic water level set
+//   (a few tidal constituents plus noise, rounded to the millimeter the
+//   way gauge data is) is written once per profile and layout. The table
+//   reports the write time, the file size, the time to read the whole file
+//   back and the time to read a single station. Every file is read back
+//   and compared to the source.
+//
+//   usage: bench_writeprofile [stations] [snaps]
+//
+//   Returns nonzero if a write fails or a file does not read back exactly
+
+namespace {
+
+//...2015-01-01 00:00:00 UTC, records every six minutes
+const qint64 c_start = 1420070400000LL;
+const qint64 c_step = 360000LL;
+
+void buildHmdf(Hmdf &hmdf, size_t nStations, size_t nSnaps) {
+  hmdf.setUnits("m");
+  hmdf.setDatum("MSL");
+  hmdf.reserve(nStations * nSnaps);
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> noise(0.0, 0.02);
+  const double pi = 3.14159265358979323846;
+  for (size_t i = 0; i < nStations; ++i) {
+    HmdfStation *s = new HmdfStation(&hmdf);
+    s->setName(QString("station_%1").arg(i));
+    s->setId(QString("station_%1").arg(i));
+    s->setLatitude(29.0 + 0.01 * i);
+    s->setLongitude(-90.0 + 0.01 * i);
+    s->setStationIndex(static_cast<int>(i));
+    s->setIsNull(false);
+    const double phase = 0.1 * i;
+    for (size_t j = 0; j < nSnaps; ++j) {
+      const double hours = static_cast<double>(j) * 0.1;
+      double v = 0.5 * std::cos(2.0 * pi * hours / 12.42 + phase) +
+                 0.2 * std::cos(2.0 * pi * hours / 23.93 + phase) +
+                 0.1 * std::cos(2.0 * pi * hours / 12.00 + phase) +
+                 noise(rng);
+      v = std::round(v * 1000.0) / 1000.0;
+      s->setNext(c_start + static_cast<qint64>(j) * c_step, v);
+    }
+    hmdf.addStation(s);
+  }
+}
+
+bool sameData(Hmdf &a, Hmdf &b) {
+  if (a.nstations() != b.nstations()) return false;
+  for (size_t i = 0; i < a.nstations(); ++i) {
+    HmdfStation *sa = a.station(static_cast<int>(i));
+    HmdfStation *sb = b.station(static_cast<int>(i));
+    if (sa->numSnaps() != sb->numSnaps()) return false;
+    HmdfSpan<const qint64> da = sa->dateSpan(), db = sb->dateSpan();
+    HmdfSpan<const double> va = sa->dataSpan(), vb = sb->dataSpan();
+    if (!std::equal(da.begin(), da.end(), db.begin())) return false;
+    if (!std::equal(va.begin(), va.end(), vb.begin())) return false;
+  }
+  return true;
+}
+
+double msecs(const QElapsedTimer &timer) {
+  return static_cast<double>(timer.nsecsElapsed()) / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  size_t nStations = 50;
+  size_t nSnaps = 87600;
+  if (argc > 1) nStations = std::max<size_t>(1, std::strtoul(argv[1], 0, 10));
+  if (argc > 2) nSnaps = std::max<size_t>(1, std::strtoul(argv[2], 0, 10));
+
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) return 1;
+
+  Hmdf source;
+  buildHmdf(source, nStations, nSnaps);
+  const double rawMB = nStations * nSnaps * 16.0 / 1048576.0;
+
+  std::printf("%zu stations x %zu records (%.1f MB of dates and values)\n",
+              nStations, nSnaps, rawMB);
+  std::printf("%-10s %-8s %10s %10s %8s %10s %10s\n", "profile", "layout",
+              "write ms", "size MB", "ratio", "read ms", "station ms");
+
+  for (auto &name : NetcdfWriteProfile::names()) {
+    NetcdfWriteProfile profile;
+    if (!NetcdfWriteProfile::fromName(name, profile)) return 1;
+
+    for (int ragged = 0; ragged < 2; ++ragged) {
+      const QString file = tmp.path() + "/" + name +
+                           (ragged ? "_ragged.nc" : "_station.nc");
+      source.setNetcdfProfile(profile);
+      source.setNetcdfLayout(ragged ? Hmdf::NetcdfRaggedArray
+                                    : Hmdf::NetcdfStationVariables);
+
+      QElapsedTimer timer;
+      timer.start();
+      if (source.writeNetcdf(file) != 0) {
+        std::fprintf(stderr, "%s: write failed\n", qPrintable(name));
+        return 1;
+      }
+      const double tWrite = msecs(timer);
+      const double sizeMB = QFileInfo(file).size() / 1048576.0;
+
+      Hmdf full;
+      timer.restart();
+      if (full.readNetcdf(file) != 0) return 1;
+      const double tRead = msecs(timer);
+      if (!sameData(source, full)) {
+        std::fprintf(stderr, "%s: data did not read back\n",
+                     qPrintable(name));
+        return 1;
+      }
+
+      NetcdfTimeseries one;
+      one.setFilename(file);
+      one.setStations(std::vector<size_t>(1, nStations / 2));
+      Hmdf station;
+      timer.restart();
+      if (one.read() != 0 || one.toHmdf(&station) != 0) return 1;
+      const double tStation = msecs(timer);
+
+      std::printf("%-10s %-8s %10.1f %10.2f %8.2f %10.1f %10.2f\n",
+                  qPrintable(name), ragged ? "ragged" : "station", tWrite,
+                  sizeMB, rawMB / std::max(sizeMB, 1e-6), tRead, tStation);
+    }
+  }
+
+  return 0;
+}
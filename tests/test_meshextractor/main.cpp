@@ -0,0 +1,293 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QTemporaryDir>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "adcircmeshextractor.h"
+#include "hmdf.h"
+#include "netcdf.h"
+
+//...Checks AdcircMeshExtractor against small generated full domain files.
+//   The mesh is a regular grid of nodes with every cell split into two
+//   triangles. The values are linear in space and time, so barycentric
+//   interpolation reproduces them exactly anywhere inside the mesh. One
+//   node is dry (fill value) at every output step.
+//
+//     fort.63.nc : zeta
+//     fort.64.nc : u-vel/v-vel, returned as the speed
+//
+//   Each file is read with the default block and gap settings and again
+//   with one output step per block and no node gap, which has to give the
+//   same values.
+//
+//   usage: test_meshextractor
+//
+//   Returns nonzero if any point is wrong
+
+#define NCCHECK(x)           \
+  {                          \
+    int ierr_ = (x);         \
+    if (ierr_ != NC_NOERR) { \
+      nc_close(ncid);        \
+      return ierr_;          \
+    }                        \
+  }
+
+namespace {
+
+const int c_nx = 6;
+const int c_ny = 5;
+const double c_x0 = -90.0;
+const double c_y0 = 29.0;
+const size_t c_nSnaps = 24;
+const double c_dt = 3600.0;
+const double c_fill = -99999.0;
+
+//...Grid position of the dry node
+const int c_dryI = 4;
+const int c_dryJ = 3;
+
+//...Field values at grid position (gx, gy) and output step t
+double zeta(double gx, double gy, size_t t) {
+  return 0.5 + 0.1 * gx + 0.2 * gy + 0.01 * t;
+}
+
+double uvel(double gx, double gy, size_t) {
+  return 0.3 + 0.05 * gx - 0.02 * gy;
+}
+
+double vvel(double gx, double gy, size_t t) {
+  return -0.2 + 0.1 * gy + 0.01 * t;
+}
+
+int writeMesh(const QString &filename, bool velocity) {
+  int ncid;
+  int ierr = nc_create(filename.toUtf8(), NC_CLOBBER | NC_NETCDF4, &ncid);
+  if (ierr != NC_NOERR) return ierr;
+
+  const size_t nNodes = c_nx * c_ny;
+  const size_t nEle = 2 * (c_nx - 1) * (c_ny - 1);
+
+  int dimid_time, dimid_node, dimid_nele, dimid_nvertex;
+  NCCHECK(nc_def_dim(ncid, "time", NC_UNLIMITED, &dimid_time));
+  NCCHECK(nc_def_dim(ncid, "node", nNodes, &dimid_node));
+  NCCHECK(nc_def_dim(ncid, "nele", nEle, &dimid_nele));
+  NCCHECK(nc_def_dim(ncid, "nvertex", 3, &dimid_nvertex));
+
+  int varid_time, varid_x, varid_y, varid_element, varid1, varid2;
+  int dimsEle[2] = {dimid_nele, dimid_nvertex};
+  int dimsData[2] = {dimid_time, dimid_node};
+  NCCHECK(nc_def_var(ncid, "time", NC_DOUBLE, 1, &dimid_time, &varid_time));
+  NCCHECK(nc_def_var(ncid, "x", NC_DOUBLE, 1, &dimid_node, &varid_x));
+  NCCHECK(nc_def_var(ncid, "y", NC_DOUBLE, 1, &dimid_node, &varid_y));
+  NCCHECK(nc_def_var(ncid, "element", NC_INT, 2, dimsEle, &varid_element));
+  NCCHECK(nc_def_var(ncid, velocity ? "u-vel" : "zeta", NC_DOUBLE, 2,
+                     dimsData, &varid1));
+  NCCHECK(nc_def_var_fill(ncid, varid1, 0, &c_fill));
+  if (velocity) {
+    NCCHECK(nc_def_var(ncid, "v-vel", NC_DOUBLE, 2, dimsData, &varid2));
+    NCCHECK(nc_def_var_fill(ncid, varid2, 0, &c_fill));
+  }
+  NCCHECK(nc_enddef(ncid));
+
+  std::vector<double> x(nNodes), y(nNodes);
+  for (int j = 0; j < c_ny; ++j) {
+    for (int i = 0; i < c_nx; ++i) {
+      x[j * c_nx + i] = c_x0 + i;
+      y[j * c_nx + i] = c_y0 + j;
+    }
+  }
+
+  //...One based node numbers, two triangles per cell
+  std::vector<int> element;
+  for (int j = 0; j < c_ny - 1; ++j) {
+    for (int i = 0; i < c_nx - 1; ++i) {
+      const int n00 = j * c_nx + i + 1;
+      const int n10 = n00 + 1;
+      const int n01 = n00 + c_nx;
+      const int n11 = n01 + 1;
+      const int cell[6] = {n00, n10, n11, n00, n11, n01};
+      element.insert(element.end(), cell, cell + 6);
+    }
+  }
+
+  std::vector<double> time(c_nSnaps);
+  for (size_t t = 0; t < c_nSnaps; ++t) time[t] = (t + 1) * c_dt;
+
+  NCCHECK(nc_put_var_double(ncid, varid_x, x.data()));
+  NCCHECK(nc_put_var_double(ncid, varid_y, y.data()));
+  NCCHECK(nc_put_var_int(ncid, varid_element, element.data()));
+  size_t start = 0, count = c_nSnaps;
+  NCCHECK(nc_put_vara_double(ncid, varid_time, &start, &count, time.data()));
+
+  std::vector<double> v1(c_nSnaps * nNodes), v2(c_nSnaps * nNodes);
+  for (size_t t = 0; t < c_nSnaps; ++t) {
+    for (int j = 0; j < c_ny; ++j) {
+      for (int i = 0; i < c_nx; ++i) {
+        const size_t k = t * nNodes + j * c_nx + i;
+        const bool dry = i == c_dryI && j == c_dryJ;
+        if (velocity) {
+          v1[k] = dry ? c_fill : uvel(i, j, t);
+          v2[k] = dry ? c_fill : vvel(i, j, t);
+        } else {
+          v1[k] = dry ? c_fill : zeta(i, j, t);
+        }
+      }
+    }
+  }
+  size_t starts[2] = {0, 0};
+  size_t counts[2] = {c_nSnaps, nNodes};
+  NCCHECK(nc_put_vara_double(ncid, varid1, starts, counts, v1.data()));
+  if (velocity)
+    NCCHECK(nc_put_vara_double(ncid, varid2, starts, counts, v2.data()));
+
+  return nc_close(ncid);
+}
+
+struct Point {
+  const char *name;
+  double gx, gy;   //...grid position
+  bool inside;     //...inside the mesh
+  int wet;         //...-1: every node wet, 0: all weight on the dry node,
+                   //   1: centroid of an element with one dry node
+  double wx1, wy1; //...the two wet nodes of that element
+  double wx2, wy2;
+};
+
+double expected(const Point &p, bool velocity, size_t t) {
+  if (!p.inside || p.wet == 0) return HmdfStation::nullDataValue();
+  if (p.wet < 0) {
+    if (!velocity) return zeta(p.gx, p.gy, t);
+    const double u = uvel(p.gx, p.gy, t);
+    const double v = vvel(p.gx, p.gy, t);
+    return std::sqrt(u * u + v * v);
+  }
+  //...The weight of the dry node is dropped and the other two (equal at
+  //   the centroid) are rescaled, which averages the two wet nodes
+  if (!velocity) {
+    return 0.5 * (zeta(p.wx1, p.wy1, t) + zeta(p.wx2, p.wy2, t));
+  }
+  const double u = 0.5 * (uvel(p.wx1, p.wy1, t) + uvel(p.wx2, p.wy2, t));
+  const double v = 0.5 * (vvel(p.wx1, p.wy1, t) + vvel(p.wx2, p.wy2, t));
+  return std::sqrt(u * u + v * v);
+}
+
+int check(const QString &filename, bool velocity, const QDateTime &coldStart,
+          const std::vector<Point> &points, size_t blockSize,
+          size_t maxNodeGap, std::vector<double> &values) {
+  AdcircMeshExtractor extractor;
+  for (const Point &p : points)
+    extractor.addPoint(c_x0 + p.gx, c_y0 + p.gy, QString::fromLatin1(p.name));
+  extractor.setBlockSize(blockSize);
+  extractor.setMaxNodeGap(maxNodeGap);
+
+  if (extractor.read(filename, coldStart) != 0) {
+    std::fprintf(stderr, "  read failed\n");
+    return 1;
+  }
+  Hmdf h;
+  if (extractor.toHmdf(&h) != 0 ||
+      h.nstations() != points.size()) {
+    std::fprintf(stderr, "  toHmdf failed\n");
+    return 1;
+  }
+
+  int failures = 0;
+  values.clear();
+  for (size_t i = 0; i < points.size(); ++i) {
+    const Point &p = points[i];
+    HmdfStation *s = h.station(static_cast<int>(i));
+    if (extractor.found(i) != p.inside || s->isNull() == p.inside ||
+        s->numSnaps() != c_nSnaps) {
+      std::fprintf(stderr, "  %s: wrong location result\n", p.name);
+      failures++;
+      continue;
+    }
+    for (size_t t = 0; t < c_nSnaps; ++t) {
+      const qint64 date = coldStart.toMSecsSinceEpoch() +
+                          static_cast<qint64>((t + 1) * c_dt * 1000.0);
+      const double e = expected(p, velocity, t);
+      const double v = s->data(static_cast<int>(t));
+      values.push_back(v);
+      if (s->date(static_cast<int>(t)) != date ||
+          std::abs(v - e) > 1e-9 * std::max(1.0, std::abs(e))) {
+        std::fprintf(stderr, "  %s: step %zu is %g, expected %g\n", p.name,
+                     t, v, e);
+        failures++;
+        break;
+      }
+    }
+  }
+  return failures;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) return 1;
+
+  const QDateTime coldStart(QDate(2019, 8, 1), QTime(0, 0), Qt::UTC);
+
+  //...The centroid of the element (3,2) (4,3) (3,3) holds the dry node
+  const std::vector<Point> points = {
+      {"inside", 2.7, 1.6, true, -1, 0, 0, 0, 0},
+      {"edge", 1.5, 2.0, true, -1, 0, 0, 0, 0},
+      {"vertex", 1.0, 1.0, true, -1, 0, 0, 0, 0},
+      {"corner", 0.0, 0.0, true, -1, 0, 0, 0, 0},
+      {"outside", 10.0, -4.0, false, -1, 0, 0, 0, 0},
+      {"drynode", c_dryI, c_dryJ, true, 0, 0, 0, 0, 0},
+      {"drycell", 10.0 / 3.0, 8.0 / 3.0, true, 1, 3, 2, 3, 3},
+  };
+
+  int failures = 0;
+  for (int f = 0; f < 2; ++f) {
+    const bool velocity = f == 1;
+    const QString filename =
+        tmp.path() + (velocity ? "/fort.64.nc" : "/fort.63.nc");
+    if (writeMesh(filename, velocity) != NC_NOERR) {
+      std::fprintf(stderr, "Could not write %s\n", qPrintable(filename));
+      return 1;
+    }
+
+    std::vector<double> batched, single;
+    int n = check(filename, velocity, coldStart, points,
+                  AdcircMeshExtractor().blockSize(),
+                  AdcircMeshExtractor().maxNodeGap(), batched);
+    n += check(filename, velocity, coldStart, points, 1, 0, single);
+    if (n == 0 && batched != single) {
+      std::fprintf(stderr, "  block and gap settings change the values\n");
+      n++;
+    }
+
+    std::printf("%-11s %zu points x %zu steps: %s\n",
+                velocity ? "fort.64.nc" : "fort.63.nc", points.size(),
+                c_nSnaps, n == 0 ? "ok" : "FAILED");
+    failures += n;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+/*-------------------------------GPL-------------------------------------//
+//
+// MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+// Copyright (C) 2019  Zach Cobell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------*/
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "hmdf.h"
+#include "noaacoops.h"
+#include "station.h"
+
+//...Runs NoaaCoOps::get against a local stand-in for the CO-OPS data
+//   server. The stand-in answers each date window with canned JSON or CSV
+//   holding one record per hour from begin_date to end_date, so adjacent
+//   windows share their boundary record the same way the real service
+//   does. It holds the requests until several are in flight and then
+//   answers them newest first, so the windows complete out of date order.
+//
+//     json     : four windows, all in flight, answered in reverse
+//     csv      : the same with format=csv
+//     limit    : at most two requests in flight at once
+//     redirect : every request is first answered with a 302
+//     failure  : one window returns HTTP 500
+//
+//   The series read back has to hold every hour exactly once, in order.
+//
+//   usage: test_noaacoops
+//
+//   Returns nonzero if any case fails
+
+namespace {
+
+const qint64 c_hour = 3600000;
+
+QString recordValue(qint64 t) {
+  return QString::number(((t / c_hour) % 1000) / 100.0, 'f', 3);
+}
+
+QDateTime requestDate(const QUrlQuery &query, const QString &key) {
+  QDateTime d = QDateTime::fromString(
+      query.queryItemValue(key, QUrl::FullyDecoded), "yyyyMMdd hh:mm");
+  d.setTimeSpec(Qt::UTC);
+  return d;
+}
+
+class CannedServer {
+ public:
+  CannedServer()
+      : m_holdFor(1), m_outstanding(0), m_maxOutstanding(0), m_redirects(0) {
+    this->m_flushTimer.setSingleShot(true);
+    this->m_flushTimer.setInterval(250);
+    QObject::connect(&this->m_flushTimer, &QTimer::timeout, &this->m_server,
+                     [this]() { this->flush(); });
+    QObject::connect(&this->m_server, &QTcpServer::newConnection,
+                     &this->m_server, [this]() { this->accept(); });
+  }
+
+  bool listen() { return this->m_server.listen(QHostAddress::LocalHost); }
+
+  QString url(const QString &path) const {
+    return QStringLiteral("http://127.0.0.1:%1%2")
+        .arg(this->m_server.serverPort())
+        .arg(path);
+  }
+
+  //...Requests are held until holdFor of them are waiting, or until none
+  //   has arrived for a while, and are then answered newest first
+  void reset(int holdFor, const QDateTime &failBegin = QDateTime()) {
+    this->m_holdFor = holdFor;
+    this->m_failBegin = failBegin;
+    this->m_outstanding = 0;
+    this->m_maxOutstanding = 0;
+    this->m_redirects = 0;
+    this->m_replyOrder.clear();
+  }
+
+  int maxOutstanding() const { return this->m_maxOutstanding; }
+  int redirects() const { return this->m_redirects; }
+  QVector<QDateTime> replyOrder() const { return this->m_replyOrder; }
+
+ private:
+  struct Pending {
+    QPointer<QTcpSocket> socket;
+    QDateTime begin;
+    QDateTime end;
+    bool json;
+  };
+
+  void accept() {
+    while (this->m_server.hasPendingConnections()) {
+      QTcpSocket *socket = this->m_server.nextPendingConnection();
+      QObject::connect(socket, &QTcpSocket::disconnected, socket,
+                       &QObject::deleteLater);
+      QObject::connect(socket, &QTcpSocket::readyRead, &this->m_server,
+                       [this, socket]() { this->read(socket); });
+    }
+  }
+
+  void read(QTcpSocket *socket) {
+    QByteArray &buffer = this->m_buffers[socket];
+    buffer.append(socket->readAll());
+    if (!buffer.contains("\r\n\r\n")) return;
+
+    //...GET <target> HTTP/1.1
+    QList<QByteArray> requestLine =
+        buffer.left(buffer.indexOf("\r\n")).split(' ');
+    this->m_buffers.remove(socket);
+    if (requestLine.size() < 2) {
+      socket->disconnectFromHost();
+      return;
+    }
+    QUrl target(QString::fromLatin1(requestLine[1]));
+    QUrlQuery query(target);
+
+    if (target.path() == QStringLiteral("/redirect")) {
+      this->m_redirects++;
+      this->write(socket, "302 Found",
+                  "Location: /datagetter?" +
+                      target.query(QUrl::FullyEncoded).toLatin1() + "\r\n",
+                  QByteArray());
+      return;
+    }
+
+    Pending p;
+    p.socket = socket;
+    p.begin = requestDate(query, QStringLiteral("begin_date"));
+    p.end = requestDate(query, QStringLiteral("end_date"));
+    p.json = query.queryItemValue(QStringLiteral("format")) ==
+             QStringLiteral("json");
+    this->m_pending.push_back(p);
+
+    this->m_outstanding++;
+    this->m_maxOutstanding =
+        std::max(this->m_maxOutstanding, this->m_outstanding);
+
+    if (this->m_pending.size() >= this->m_holdFor) {
+      this->m_flushTimer.stop();
+      this->flush();
+    } else {
+      this->m_flushTimer.start();
+    }
+  }
+
+  void flush() {
+    std::sort(this->m_pending.begin(), this->m_pending.end(),
+              [](const Pending &a, const Pending &b) {
+                return a.begin > b.begin;
+              });
+    for (int i = 0; i < this->m_pending.size(); ++i) {
+      Pending p = this->m_pending[i];
+      QTimer::singleShot(20 * i, &this->m_server,
+                         [this, p]() { this->answer(p); });
+    }
+    this->m_pending.clear();
+  }
+
+  void answer(const Pending &p) {
+    this->m_outstanding--;
+    this->m_replyOrder.push_back(p.begin);
+    if (p.socket.isNull()) return;
+
+    if (this->m_failBegin.isValid() && p.begin == this->m_failBegin) {
+      this->write(p.socket, "500 Internal Server Error", QByteArray(),
+                  "server error");
+      return;
+    }
+
+    QByteArray body;
+    if (p.json) {
+      body = "{\"metadata\":{\"id\":\"8761724\",\"name\":\"Grand Isle\","
+             "\"lat\":\"29.2633\",\"lon\":\"-89.9567\"},\"data\":[";
+      for (qint64 t = p.begin.toMSecsSinceEpoch();
+           t <= p.end.toMSecsSinceEpoch(); t += c_hour) {
+        if (body.endsWith('}')) body += ",";
+        body += "{\"t\":\"" +
+                QDateTime::fromMSecsSinceEpoch(t, Qt::UTC)
+                    .toString("yyyy-MM-dd hh:mm")
+                    .toLatin1() +
+                "\",\"v\":\"" + recordValue(t).toLatin1() +
+                "\",\"s\":\"0.003\",\"f\":\"0,0,0,0\",\"q\":\"v\"}";
+      }
+      body += "]}";
+    } else {
+      body =
+          "Date Time, Water Level, Sigma, O or I (for verified), F, R, L, "
+          "Quality \n";
+      for (qint64 t = p.begin.toMSecsSinceEpoch();
+           t <= p.end.toMSecsSinceEpoch(); t += c_hour) {
+        body += QDateTime::fromMSecsSinceEpoch(t, Qt::UTC)
+                    .toString("yyyy-MM-dd hh:mm")
+                    .toLatin1() +
+                "," + recordValue(t).toLatin1() + ",0.003,0,0,0,0,v\n";
+      }
+    }
+    this->write(p.socket, "200 OK", QByteArray(), body);
+  }
+
+  void write(QTcpSocket *socket, const QByteArray &status,
+             const QByteArray &headers, const QByteArray &body) {
+    socket->write("HTTP/1.1 " + status + "\r\n" + headers +
+                  "Content-Length: " + QByteArray::number(body.size()) +
+                  "\r\nConnection: close\r\n\r\n" + body);
+    socket->disconnectFromHost();
+  }
+
+  QTcpServer m_server;
+  QTimer m_flushTimer;
+  QHash<QTcpSocket *, QByteArray> m_buffers;
+  QVector<Pending> m_pending;
+  QVector<QDateTime> m_replyOrder;
+  QDateTime m_failBegin;
+  int m_holdFor;
+  int m_outstanding;
+  int m_maxOutstanding;
+  int m_redirects;
+};
+
+//...Every hour from start to end exactly once, in order
+int checkSeries(Hmdf &h, const QDateTime &start, const QDateTime &end) {
+  if (h.nstations() != 1) {
+    std::fprintf(stderr, "  expected one station, got %d\n", h.nstations());
+    return 1;
+  }
+  HmdfStation *s = h.station(0);
+  const qint64 t0 = start.toMSecsSinceEpoch();
+  const size_t n =
+      static_cast<size_t>((end.toMSecsSinceEpoch() - t0) / c_hour) + 1;
+  if (s->numSnaps() != n) {
+    std::fprintf(stderr, "  expected %zu records, got %zu\n", n,
+                 s->numSnaps());
+    return 1;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const qint64 t = t0 + static_cast<qint64>(i) * c_hour;
+    if (s->date(static_cast<int>(i)) != t) {
+      std::fprintf(stderr, "  record %zu is out of order\n", i);
+      return 1;
+    }
+    if (std::abs(s->data(static_cast<int>(i)) - recordValue(t).toDouble()) >
+        1e-9) {
+      std::fprintf(stderr, "  record %zu has the wrong value\n", i);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+bool isAscending(const QVector<QDateTime> &order) {
+  return std::is_sorted(order.begin(), order.end());
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  CannedServer server;
+  if (!server.listen()) {
+    std::fprintf(stderr, "Could not start the stand-in server\n");
+    return 1;
+  }
+
+  //...100 days gives four windows: three of 30 days and one of 10
+  const QDateTime start(QDate(2019, 1, 1), QTime(0, 0), Qt::UTC);
+  const QDateTime end(QDate(2019, 4, 11), QTime(0, 0), Qt::UTC);
+  const int nWindows = 4;
+
+  Station station(QGeoCoordinate(29.2633, -89.9567), QStringLiteral("8761724"),
+                  QStringLiteral("Grand Isle"));
+
+  struct Case {
+    const char *name;
+    bool json;
+    int limit;
+    const char *path;
+    bool fail;
+  };
+  const Case cases[] = {
+      {"json", true, 4, "/datagetter", false},
+      {"csv", false, 4, "/datagetter", false},
+      {"limit", true, 2, "/datagetter", false},
+      {"redirect", true, 4, "/redirect", false},
+      {"failure", true, 4, "/datagetter", true},
+  };
+
+  int failures = 0;
+  std::printf("%-10s %8s %10s %10s %9s  %s\n", "case", "records",
+              "in flight", "redirects", "reversed", "result");
+
+  for (const Case &c : cases) {
+    const QDateTime failBegin = c.fail ? start.addDays(60) : QDateTime();
+    server.reset(c.limit, failBegin);
+
+    NoaaCoOps noaa(station, start, end, QStringLiteral("water_level"),
+                   QStringLiteral("MSL"), false, QStringLiteral("metric"));
+    noaa.setServerUrl(server.url(QString::fromLatin1(c.path)));
+    noaa.setMaxConcurrentRequests(c.limit);
+    noaa.setUseJson(c.json);
+
+    Hmdf h;
+    int ierr = noaa.get(&h);
+
+    bool ok;
+    if (c.fail) {
+      //...The failed window has to surface as an error even though the
+      //   other windows were downloaded
+      ok = ierr != 0 && !noaa.errorString().isEmpty();
+    } else {
+      ok = ierr == 0 && checkSeries(h, start, end) == 0 &&
+           server.maxOutstanding() <= c.limit &&
+           server.replyOrder().size() == nWindows &&
+           !isAscending(server.replyOrder());
+      if (c.limit >= nWindows) ok = ok && server.maxOutstanding() == nWindows;
+      if (QString::fromLatin1(c.path) == QStringLiteral("/redirect")) {
+        ok = ok && server.redirects() == nWindows;
+      }
+    }
+
+    std::printf("%-10s %8zu %10d %10d %9s  %s\n", c.name,
+                h.nstations() > 0 ? h.station(0)->numSnaps() : size_t(0),
+                server.maxOutstanding(), server.redirects(),
+                isAscending(server.replyOrder()) ? "no" : "yes",
+                ok ? "ok" : "FAILED");
+    if (!ok) {
+      if (ierr != 0) {
+        std::fprintf(stderr, "  get() returned %d: %s\n", ierr,
+                     qPrintable(noaa.errorString()));
+      }
+      failures++;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#-------------------------------GPL-------------------------------------#
+#
+# MetOcean Viewer - A simple interface for viewing hydrodynamic model data
+# Copyright (C) 2019  Zach Cobell
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-----------------------------------------------------------------------#
+
+#...Common settings for the console test and benchmark programs under
+#   tests/. Each program lives one directory down and links the static
+#   libraries the same way MetOceanData does
+
+QT += network positioning concurrent
+QT -= gui
+
+include($$PWD/../global.pri)
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/../thirdparty/boost_1_67_0
+
+#...Sample files shipped with the repository
+DEFINES += MOV_FUNCTION_TESTS=\\\"$$PWD/../MetOceanViewer/function_tests\\\"
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../libraries/libmetocean/release/ -lmetocean
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../libraries/libmetocean/debug/ -lmetocean
+else:unix: LIBS += -L$$OUT_PWD/../../libraries/libmetocean/ -lmetocean
+
+INCLUDEPATH += $$PWD/../libraries/libmetocean
+DEPENDPATH += $$PWD/../libraries/libmetocean
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libraries/libmetocean/release/libmetocean.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libraries/libmetocean/debug/libmetocean.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libraries/libmetocean/release/metocean.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libraries/libmetocean/debug/metocean.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../../libraries/libmetocean/libmetocean.a
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../thirdparty/ezproj/src/release/ -lezproj
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../thirdparty/ezproj/src/debug/ -lezproj
+else:unix: LIBS += -L$$OUT_PWD/../../thirdparty/ezproj/src/ -lezproj
+
+INCLUDEPATH += $$PWD/../thirdparty/ezproj/src
+DEPENDPATH += $$PWD/../thirdparty/ezproj/src
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../libraries/libtide/release/ -ltide
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../libraries/libtide/debug/ -ltide
+else:unix: LIBS += -L$$OUT_PWD/../../libraries/libtide/ -ltide
+
+INCLUDEPATH += $$PWD/../libraries/libtide
+DEPENDPATH += $$PWD/../libraries/libtide
+
+LIBS += -lnetcdf